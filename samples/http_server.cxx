@@ -18,7 +18,7 @@ namespace {
         auto uri = str(req.uri);
         std::string_view u(reinterpret_cast<char const *>(uri.data()),
                            uri.size());
-        ivy::log_info(std::format("Received request, uri = [{}].", u));
+        ivy::log_info("Received request, uri = [{}].", u);
 
         return ivy::http::make_http_response(200, u8"Hello, world.\r\n");
     }
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_CHARENC_UTF_HXX_INCLUDED
+#define IVY_CHARENC_UTF_HXX_INCLUDED
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace ivy {
+
+    /*
+     * Conversion between UTF-8, UTF-16 and code points without ICU, for
+     * code which converts many short strings, such as a database driver
+     * converting every string it fetches.
+     *
+     * Malformed input is never an error: an invalid UTF-8 sequence, an
+     * unpaired surrogate, or a value which isn't a Unicode scalar value
+     * becomes U+FFFD.
+     */
+
+    inline constexpr char32_t replacement_character = 0xFFFD;
+
+    namespace detail {
+
+        // The type of value to write through an output iterator.  A
+        // back_insert_iterator doesn't have one, so use its container's.
+        template <typename Out>
+        struct utf_output_value {
+            using type = std::iter_value_t<Out>;
+        };
+
+        template <typename Container>
+        struct utf_output_value<std::back_insert_iterator<Container>> {
+            using type = typename Container::value_type;
+        };
+
+        template <typename Out>
+        using utf_output_value_t = typename utf_output_value<Out>::type;
+
+        constexpr auto is_surrogate(char32_t c) noexcept -> bool
+        {
+            return c >= 0xD800 && c <= 0xDFFF;
+        }
+
+        constexpr auto is_high_surrogate(char32_t c) noexcept -> bool
+        {
+            return c >= 0xD800 && c <= 0xDBFF;
+        }
+
+        constexpr auto is_low_surrogate(char32_t c) noexcept -> bool
+        {
+            return c >= 0xDC00 && c <= 0xDFFF;
+        }
+
+    } // namespace detail
+
+    // Write the UTF-8 encoding of 'c' to 'out', whose value type can be
+    // any byte-sized type, including std::byte.
+    template <typename Out>
+    constexpr auto encode_utf8(char32_t c, Out out) -> Out
+    {
+        using value_type = detail::utf_output_value_t<Out>;
+
+        auto put = [&](char32_t v) {
+            *out++ = static_cast<value_type>(v);
+        };
+
+        if (c > 0x10FFFF || detail::is_surrogate(c))
+            c = replacement_character;
+
+        if (c < 0x80)
+            put(c);
+        else if (c < 0x800) {
+            put(0xC0 | (c >> 6));
+            put(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            put(0xE0 | (c >> 12));
+            put(0x80 | ((c >> 6) & 0x3F));
+            put(0x80 | (c & 0x3F));
+        } else {
+            put(0xF0 | (c >> 18));
+            put(0x80 | ((c >> 12) & 0x3F));
+            put(0x80 | ((c >> 6) & 0x3F));
+            put(0x80 | (c & 0x3F));
+        }
+
+        return out;
+    }
+
+    // Write the UTF-16 encoding of 'c' to 'out'.
+    template <typename Out>
+    constexpr auto encode_utf16(char32_t c, Out out) -> Out
+    {
+        using value_type = detail::utf_output_value_t<Out>;
+
+        if (c > 0x10FFFF || detail::is_surrogate(c))
+            c = replacement_character;
+
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            *out++ = static_cast<value_type>(0xD800 + (c >> 10));
+            *out++ = static_cast<value_type>(0xDC00 + (c & 0x3FF));
+        } else
+            *out++ = static_cast<value_type>(c);
+
+        return out;
+    }
+
+    // Call emit(c) for each code point in 's'.
+    template <typename F>
+    constexpr auto decode_utf8(std::string_view s, F &&emit) -> void
+    {
+        // The smallest code point which needs a sequence of each length;
+        // anything less is an overlong encoding.
+        constexpr char32_t min_value[] = {0, 0, 0x80, 0x800, 0x10000};
+
+        for (std::size_t i = 0; i < s.size();) {
+            auto b = static_cast<unsigned char>(s[i]);
+            std::size_t len = b < 0x80   ? 1
+                              : b < 0xC0 ? 0
+                              : b < 0xE0 ? 2
+                              : b < 0xF0 ? 3
+                              : b < 0xF8 ? 4
+                                         : 0;
+
+            if (len == 0 || i + len > s.size()) {
+                emit(replacement_character);
+                ++i;
+                continue;
+            }
+
+            char32_t c = len == 1 ? b : b & (0x7F >> len);
+            bool ok = true;
+            for (std::size_t j = 1; j < len; ++j) {
+                auto cb = static_cast<unsigned char>(s[i + j]);
+                ok = ok && (cb & 0xC0) == 0x80;
+                c = (c << 6) | (cb & 0x3F);
+            }
+
+            if (!ok) {
+                emit(replacement_character);
+                ++i;
+                continue;
+            }
+
+            if (c < min_value[len] || c > 0x10FFFF || detail::is_surrogate(c))
+                c = replacement_character;
+
+            emit(c);
+            i += len;
+        }
+    }
+
+    // Decodes UTF-16 which arrives in pieces, such as a long value read a
+    // chunk at a time: a high surrogate at the end of one piece is paired
+    // with the start of the next.
+    class utf16_decoder {
+        char16_t _high_surrogate = 0;
+
+    public:
+        // Call emit(c) for the code point 'c' completes, if any.
+        template <typename F>
+        constexpr auto put(char16_t c, F &&emit) -> void
+        {
+            if (_high_surrogate) {
+                char32_t high = _high_surrogate - 0xD800;
+                _high_surrogate = 0;
+
+                if (detail::is_low_surrogate(c)) {
+                    emit(0x10000 + (high << 10) + (c - 0xDC00));
+                    return;
+                }
+
+                emit(replacement_character);
+            }
+
+            if (detail::is_high_surrogate(c))
+                _high_surrogate = c;
+            else if (detail::is_low_surrogate(c))
+                emit(replacement_character);
+            else
+                emit(char32_t(c));
+        }
+
+        // End of the input: a high surrogate still waiting for its pair
+        // becomes U+FFFD.
+        template <typename F>
+        constexpr auto finish(F &&emit) -> void
+        {
+            if (_high_surrogate)
+                emit(replacement_character);
+            _high_surrogate = 0;
+        }
+    };
+
+    // Call emit(c) for each code point in 's'.
+    template <typename F>
+    constexpr auto decode_utf16(std::u16string_view s, F &&emit) -> void
+    {
+        utf16_decoder decoder;
+
+        for (auto c : s)
+            decoder.put(c, emit);
+
+        decoder.finish(emit);
+    }
+
+} // namespace ivy
+
+#endif // IVY_CHARENC_UTF_HXX_INCLUDED
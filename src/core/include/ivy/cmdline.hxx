@@ -11,6 +11,7 @@
 #include <ivy/error.hxx>
 #include <ivy/exception.hxx>
 #include <ivy/expected.hxx>
+#include <ivy/hash.hxx>
 #include <ivy/string.hxx>
 #include <ivy/string/format.hxx>
 
@@ -73,7 +74,10 @@ namespace ivy {
     class cmdline {
         using base_type = detail::option_base<options_type>;
 
-        std::unordered_map<u8string, std::unique_ptr<base_type>> _options;
+        std::unordered_map<u8string,
+                           std::unique_ptr<base_type>,
+                           hash<u8string, fast_hash_policy>>
+            _options;
         std::vector<std::pair<u8string, std::unique_ptr<base_type>>> _arguments;
 
     public:
@@ -6,13 +6,14 @@
 #ifndef IVY_CONFIG_BIND_HXX_INCLUDED
 #define IVY_CONFIG_BIND_HXX_INCLUDED
 
-#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <ivy/config/parse.hxx>
 #include <ivy/error.hxx>
 #include <ivy/exception.hxx>
 #include <ivy/expected.hxx>
+#include <ivy/hash.hxx>
 #include <ivy/string.hxx>
 #include <ivy/string/format.hxx>
 
@@ -221,7 +222,8 @@ namespace ivy::config {
         using option_ptr = std::shared_ptr<item_setter<C>>;
 
     private:
-        std::map<string, option_ptr> _options;
+        std::unordered_map<string, option_ptr, hash<string, fast_hash_policy>>
+            _options;
         std::shared_ptr<item_setter<C>> _name_setter;
 
     public:
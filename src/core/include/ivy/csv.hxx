@@ -14,6 +14,7 @@
 #include <ivy/error.hxx>
 #include <ivy/io/channel.hxx>
 #include <ivy/string.hxx>
+#include <ivy/trace.hxx>
 
 namespace ivy {
 
@@ -85,6 +86,8 @@ namespace ivy {
     auto csv_reader<channel_type, allocator>::read()
         -> expected<row_type, error>
     {
+        IVY_SPAN("csv.read");
+
         std::vector<char_type, allocator> word;
         row_type row;
 
@@ -7,8 +7,15 @@
 #define IVY_DATUM_HXX_INCLUDED
 
 #include <any>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include <ivy/decimal.hxx>
 #include <ivy/string.hxx>
 
 namespace ivy {
@@ -22,28 +29,220 @@ namespace ivy {
             -> bool = 0;
     };
 
+    class datum;
+
+    template <typename To>
+    auto datum_cast(datum const &) -> To = delete;
+
+    template <typename To>
+    auto datum_cast(datum const *) -> To const * = delete;
+
+    namespace detail {
+
+        // A value shared between copies of a datum.  Datums are immutable,
+        // so copies can share it without copying.
+        template <typename T>
+        struct datum_box {
+            std::atomic<std::uint32_t> refs{1};
+            T value;
+        };
+
+        // The value of a datum whose type isn't built in.
+        struct datum_other {
+            datum_type const *type;
+            std::any value;
+        };
+
+    } // namespace detail
+
+    /*
+     * datum: a dynamically-typed value, such as one cell of a database row.
+     *
+     * Built-in types are stored inline behind a one-byte tag: null, boolean,
+     * integer, double, date and timestamp values directly, and strings,
+     * decimals and byte strings as a pointer to a shared, reference-counted
+     * box.  A datum is 16 bytes, and copying, comparing or casting a
+     * built-in value never makes a virtual call.
+     *
+     * Values of any other datum_type are kept in a std::any, as before, and
+     * are handled through the datum_type.
+     */
     class datum final {
-        datum_type const *_type;
-        std::any _value;
+    public:
+        // Kinds from 'string' onwards are boxed.
+        enum struct kind : std::uint8_t {
+            null,
+            boolean,
+            integer,
+            real, // double
+            date,
+            timestamp,
+            string,
+            decimal,
+            bytes,
+            other,
+        };
+
+    private:
+        union payload {
+            bool b;
+            std::int64_t i;
+            double d;
+            std::chrono::sys_days date;
+            std::chrono::sys_time<std::chrono::microseconds> timestamp;
+            detail::datum_box<string> *s;
+            detail::datum_box<decimal> *dec;
+            detail::datum_box<std::vector<std::byte>> *bytes;
+            detail::datum_box<detail::datum_other> *o;
+        };
+
+        payload _value{.i = 0};
+        kind _kind = kind::null;
+
+        datum(kind k, payload v) noexcept
+            : _value(v)
+            , _kind(k)
+        {
+        }
+
+        [[nodiscard]] auto is_boxed() const noexcept -> bool
+        {
+            return _kind >= kind::string;
+        }
+
+        // The reference count of a boxed value.
+        [[nodiscard]] auto box_refs() const noexcept
+            -> std::atomic<std::uint32_t> &
+        {
+            switch (_kind) {
+            case kind::string:
+                return _value.s->refs;
+            case kind::decimal:
+                return _value.dec->refs;
+            case kind::bytes:
+                return _value.bytes->refs;
+            default:
+                return _value.o->refs;
+            }
+        }
+
+        auto add_ref() const noexcept -> void
+        {
+            if (is_boxed())
+                box_refs().fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto release() noexcept -> void
+        {
+            if (is_boxed())
+                release_box();
+        }
+
+        auto release_box() noexcept -> void;
+        auto boxed_equal_to(datum const &other) const -> bool;
+
+        friend auto make_null_datum() -> datum;
+        friend auto make_boolean_datum(bool b) -> datum;
+        friend auto make_integer_datum(std::int64_t i) -> datum;
+        friend auto make_string_datum(string const &s) -> datum;
+        friend auto make_double_datum(double d) -> datum;
+        friend auto make_decimal_datum(decimal const &d) -> datum;
+        friend auto make_date_datum(std::chrono::sys_days d) -> datum;
+        friend auto make_timestamp_datum(
+            std::chrono::sys_time<std::chrono::microseconds> t) -> datum;
+        friend auto make_bytes_datum(std::vector<std::byte> &&b) -> datum;
+
+        template <typename To>
+        friend auto datum_cast(datum const &) -> To;
+
+        template <typename To>
+        friend auto datum_cast(datum const *) -> To const *;
 
     public:
+        // A null datum.
+        datum() noexcept = default;
+
         datum(datum_type const *type, std::any const &value);
         datum(datum_type const *type, std::any &&value);
 
-        datum(datum const &other);
-        datum(datum &&other) noexcept;
+        datum(datum const &other) noexcept
+            : _value(other._value)
+            , _kind(other._kind)
+        {
+            add_ref();
+        }
+
+        datum(datum &&other) noexcept
+            : _value(other._value)
+            , _kind(std::exchange(other._kind, kind::null))
+        {
+        }
 
-        auto operator=(datum const &other) -> datum &;
-        auto operator=(datum &&other) noexcept -> datum &;
+        auto operator=(datum const &other) noexcept -> datum &
+        {
+            other.add_ref();
+            release();
+            _value = other._value;
+            _kind = other._kind;
+            return *this;
+        }
+
+        auto operator=(datum &&other) noexcept -> datum &
+        {
+            if (this != &other) {
+                release();
+                _value = other._value;
+                _kind = std::exchange(other._kind, kind::null);
+            }
+            return *this;
+        }
+
+        ~datum()
+        {
+            release();
+        }
+
+        [[nodiscard]] auto get_kind() const noexcept -> kind
+        {
+            return _kind;
+        }
 
         auto type() const noexcept -> datum_type const *;
         auto str() const -> string;
-        auto equal_to(datum const &other) const -> bool;
+
+        auto equal_to(datum const &other) const -> bool
+        {
+            if (_kind != other._kind)
+                return false;
+
+            switch (_kind) {
+            case kind::null:
+                return true;
+            case kind::boolean:
+                return _value.b == other._value.b;
+            case kind::integer:
+                return _value.i == other._value.i;
+            case kind::real:
+                return _value.d == other._value.d;
+            case kind::date:
+                return _value.date == other._value.date;
+            case kind::timestamp:
+                return _value.timestamp == other._value.timestamp;
+            default:
+                return boxed_equal_to(other);
+            }
+        }
+
+        // The std::any holding a value which isn't of a built-in type.
         auto storage() const noexcept -> std::any const &;
     };
 
     auto str(datum const &) -> string;
-    auto operator==(datum const &a, datum const &b) -> bool;
+
+    inline auto operator==(datum const &a, datum const &b) -> bool
+    {
+        return a.equal_to(b);
+    }
 
     template<typename Type>
     auto is(datum const &d) -> bool
@@ -56,12 +255,6 @@ namespace ivy {
         bad_datum_cast();
     };
 
-    template<typename To>
-    auto datum_cast(datum const &) -> To = delete;
-
-    template<typename To>
-    auto datum_cast(datum const *) -> To const * = delete;
-
 } // namespace ivy
 
 #endif // IVY_DATUM_HXX_INCLUDED
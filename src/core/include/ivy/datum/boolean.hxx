@@ -25,10 +25,18 @@ namespace ivy {
     auto make_boolean_datum(bool b) -> datum;
 
     template <>
-    auto datum_cast<bool>(datum const &) -> bool;
+    inline auto datum_cast<bool>(datum const &d) -> bool
+    {
+        if (d._kind != datum::kind::boolean)
+            throw bad_datum_cast();
+        return d._value.b;
+    }
 
     template <>
-    auto datum_cast<bool>(datum const *) -> bool const *;
+    inline auto datum_cast<bool>(datum const *d) -> bool const *
+    {
+        return d->_kind == datum::kind::boolean ? &d->_value.b : nullptr;
+    }
 
 } // namespace ivy
 
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_BYTES_HXX_INCLUDED
+#define IVY_DATUM_BYTES_HXX_INCLUDED
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <ivy/datum.hxx>
+
+namespace ivy {
+
+    // A string of bytes, such as a BINARY column.  str() gives the bytes in
+    // lower-case hex.
+    class bytes_type final : public datum_type {
+    public:
+        using native_type = std::vector<std::byte>;
+
+        auto get() const noexcept -> datum_type const * final;
+        auto name() const noexcept -> char const * final;
+        auto str(std::any const &v) const -> string final;
+        auto equal(std::any const &a, std::any const &b) const -> bool final;
+    };
+
+    auto get_bytes_type() -> bytes_type const *;
+
+    auto make_bytes_datum(std::vector<std::byte> &&b) -> datum;
+    auto make_bytes_datum(std::span<std::byte const> b) -> datum;
+
+    template <>
+    inline auto datum_cast<std::vector<std::byte>>(datum const &d)
+        -> std::vector<std::byte>
+    {
+        if (d._kind != datum::kind::bytes)
+            throw bad_datum_cast();
+        return d._value.bytes->value;
+    }
+
+    template <>
+    inline auto datum_cast<std::vector<std::byte>>(datum const *d)
+        -> std::vector<std::byte> const *
+    {
+        return d->_kind == datum::kind::bytes ? &d->_value.bytes->value
+                                              : nullptr;
+    }
+
+} // namespace ivy
+
+#endif // IVY_DATUM_BYTES_HXX_INCLUDED
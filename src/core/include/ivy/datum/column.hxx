@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_COLUMN_HXX_INCLUDED
+#define IVY_DATUM_COLUMN_HXX_INCLUDED
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <ivy/datum.hxx>
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+
+namespace ivy {
+
+    /*************************************************************************
+     *
+     * column_bitmap: one bit per row of a column, used both for a column's
+     * validity (1 = not null) and for the result of comparisons.
+     */
+
+    class column_bitmap {
+        std::vector<std::uint64_t> _words;
+        std::size_t _size = 0;
+
+    public:
+        column_bitmap() = default;
+
+        // 'size' bits, all set to 'value'.
+        explicit column_bitmap(std::size_t size, bool value = false);
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return _size;
+        }
+
+        [[nodiscard]] auto test(std::size_t i) const noexcept -> bool
+        {
+            return (_words[i / 64] >> (i % 64)) & 1;
+        }
+
+        auto set(std::size_t i, bool value = true) noexcept -> void
+        {
+            auto bit = std::uint64_t(1) << (i % 64);
+            if (value)
+                _words[i / 64] |= bit;
+            else
+                _words[i / 64] &= ~bit;
+        }
+
+        auto push_back(bool value) -> void;
+        auto resize(std::size_t size, bool value = false) -> void;
+
+        // The number of bits which are set.
+        [[nodiscard]] auto count() const noexcept -> std::size_t;
+
+        // The bits, 64 rows per word.  Bits past size() are always clear.
+        [[nodiscard]] auto words() const noexcept
+            -> std::span<std::uint64_t const>
+        {
+            return _words;
+        }
+
+        [[nodiscard]] auto words() noexcept -> std::span<std::uint64_t>
+        {
+            return _words;
+        }
+
+        auto operator&=(column_bitmap const &other) noexcept
+            -> column_bitmap &;
+        auto operator|=(column_bitmap const &other) noexcept
+            -> column_bitmap &;
+
+        // Invert every bit.
+        auto flip() noexcept -> column_bitmap &;
+
+        friend auto operator==(column_bitmap const &,
+                               column_bitmap const &) -> bool = default;
+    };
+
+    auto operator&(column_bitmap a, column_bitmap const &b) -> column_bitmap;
+    auto operator|(column_bitmap a, column_bitmap const &b) -> column_bitmap;
+
+    /*************************************************************************
+     *
+     * datum_column: a column of values of one built-in datum type, stored
+     * contiguously, with a validity bitmap for nulls.
+     *
+     * Integers are stored as an array of int64_t and booleans as an array of
+     * bytes.  Strings are stored as one array of characters and an array
+     * of offsets, so string i is chars[offsets[i], offsets[i+1]).  The slot
+     * of a null row holds zero or the empty string.
+     *
+     * A column whose type is datum::kind::null has only null values, which
+     * is what a sequence of datums which are all null becomes.
+     *
+     * Operations on whole columns (compare(), filter(), hash()) run over
+     * the arrays without looking at the type of each value, and are written
+     * so the compiler can vectorize them.
+     */
+
+    class datum_column {
+        datum::kind _type;
+        std::size_t _size = 0;
+        column_bitmap _validity;
+
+        std::vector<std::int64_t> _integers;
+        std::vector<std::uint8_t> _booleans;
+        std::vector<string::value_type> _chars;
+        std::vector<std::size_t> _offsets{0};
+
+    public:
+        // An empty column.  'type' must be null, boolean, integer or
+        // string.
+        explicit datum_column(datum::kind type);
+
+        [[nodiscard]] auto type() const noexcept -> datum::kind
+        {
+            return _type;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return _size;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool
+        {
+            return _size == 0;
+        }
+
+        [[nodiscard]] auto validity() const noexcept -> column_bitmap const &
+        {
+            return _validity;
+        }
+
+        [[nodiscard]] auto is_null(std::size_t i) const noexcept -> bool
+        {
+            return !_validity.test(i);
+        }
+
+        [[nodiscard]] auto null_count() const noexcept -> std::size_t
+        {
+            return _size - _validity.count();
+        }
+
+        auto reserve(std::size_t n) -> void;
+
+        // Append a value.  Throws bad_datum_cast if it's neither null nor
+        // of the column's type.
+        auto append(datum const &value) -> void;
+        auto append_null() -> void;
+        auto append_integer(std::int64_t value) -> void;
+        auto append_boolean(bool value) -> void;
+        auto append_string(std::span<string::value_type const> value) -> void;
+
+        // The values of an integer or boolean column.
+        [[nodiscard]] auto integers() const noexcept
+            -> std::span<std::int64_t const>
+        {
+            return _integers;
+        }
+
+        [[nodiscard]] auto booleans() const noexcept
+            -> std::span<std::uint8_t const>
+        {
+            return _booleans;
+        }
+
+        // The characters of a string value, without copying them.
+        [[nodiscard]] auto string_at(std::size_t i) const noexcept
+            -> std::span<string::value_type const>
+        {
+            return std::span(_chars).subspan(_offsets[i],
+                                             _offsets[i + 1] - _offsets[i]);
+        }
+
+        // The string column's character and offset arrays.
+        [[nodiscard]] auto chars() const noexcept
+            -> std::span<string::value_type const>
+        {
+            return _chars;
+        }
+
+        [[nodiscard]] auto offsets() const noexcept
+            -> std::span<std::size_t const>
+        {
+            return _offsets;
+        }
+
+        // Row 'i' as a datum.
+        [[nodiscard]] auto value(std::size_t i) const -> datum;
+        [[nodiscard]] auto to_datums() const -> std::vector<datum>;
+
+        // A new column with the rows whose bit is set in 'selection'.
+        [[nodiscard]] auto filter(column_bitmap const &selection) const
+            -> datum_column;
+
+        // Set out[i] to the hash of row i, the same as ivy::hash of the
+        // value; null rows hash to 0.  'out' must be at least size() long.
+        auto hash(std::span<std::size_t> out) const -> void;
+    };
+
+    // Build a column from a sequence of datums.  The column's type is the
+    // type of the first value which isn't null; it is an error for any
+    // other value to have a different type, or for the type to be one a
+    // column can't hold.
+    auto make_datum_column(std::span<datum const> values)
+        -> expected<datum_column, error>;
+
+    /*************************************************************************
+     *
+     * Comparisons.  A null compares false to anything, as in SQL, so the
+     * result of a comparison with a null row is always 0.  Comparing columns
+     * of different types, or a column with a value of a different type, is
+     * an error.  Strings compare by code point.
+     */
+
+    enum struct compare_op {
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal,
+    };
+
+    auto compare(datum_column const &column,
+                 compare_op op,
+                 datum const &value) -> expected<column_bitmap, error>;
+
+    auto compare(datum_column const &a,
+                 compare_op op,
+                 datum_column const &b) -> expected<column_bitmap, error>;
+
+} // namespace ivy
+
+#endif // IVY_DATUM_COLUMN_HXX_INCLUDED
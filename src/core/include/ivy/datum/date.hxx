@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_DATE_HXX_INCLUDED
+#define IVY_DATUM_DATE_HXX_INCLUDED
+
+#include <chrono>
+
+#include <ivy/datum.hxx>
+
+namespace ivy {
+
+    // A calendar date, without a time zone.  str() gives YYYY-MM-DD.
+    class date_type final : public datum_type {
+    public:
+        using native_type = std::chrono::sys_days;
+
+        auto get() const noexcept -> datum_type const * final;
+        auto name() const noexcept -> char const * final;
+        auto str(std::any const &v) const -> string final;
+        auto equal(std::any const &a, std::any const &b) const -> bool final;
+    };
+
+    auto get_date_type() -> date_type const *;
+
+    auto make_date_datum(std::chrono::sys_days d) -> datum;
+
+    template <>
+    inline auto datum_cast<std::chrono::sys_days>(datum const &d)
+        -> std::chrono::sys_days
+    {
+        if (d._kind != datum::kind::date)
+            throw bad_datum_cast();
+        return d._value.date;
+    }
+
+    template <>
+    inline auto datum_cast<std::chrono::sys_days>(datum const *d)
+        -> std::chrono::sys_days const *
+    {
+        return d->_kind == datum::kind::date ? &d->_value.date : nullptr;
+    }
+
+} // namespace ivy
+
+#endif // IVY_DATUM_DATE_HXX_INCLUDED
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_DECIMAL_HXX_INCLUDED
+#define IVY_DATUM_DECIMAL_HXX_INCLUDED
+
+#include <ivy/datum.hxx>
+#include <ivy/decimal.hxx>
+
+namespace ivy {
+
+    class decimal_type final : public datum_type {
+    public:
+        using native_type = decimal;
+
+        auto get() const noexcept -> datum_type const * final;
+        auto name() const noexcept -> char const * final;
+        auto str(std::any const &v) const -> string final;
+        auto equal(std::any const &a, std::any const &b) const -> bool final;
+    };
+
+    auto get_decimal_type() -> decimal_type const *;
+
+    auto make_decimal_datum(decimal const &d) -> datum;
+
+    template <>
+    inline auto datum_cast<decimal>(datum const &d) -> decimal
+    {
+        if (d._kind != datum::kind::decimal)
+            throw bad_datum_cast();
+        return d._value.dec->value;
+    }
+
+    template <>
+    inline auto datum_cast<decimal>(datum const *d) -> decimal const *
+    {
+        return d->_kind == datum::kind::decimal ? &d->_value.dec->value
+                                                : nullptr;
+    }
+
+} // namespace ivy
+
+#endif // IVY_DATUM_DECIMAL_HXX_INCLUDED
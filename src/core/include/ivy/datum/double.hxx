@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_DOUBLE_HXX_INCLUDED
+#define IVY_DATUM_DOUBLE_HXX_INCLUDED
+
+#include <ivy/datum.hxx>
+
+namespace ivy {
+
+    class double_type final : public datum_type {
+    public:
+        using native_type = double;
+
+        auto get() const noexcept -> datum_type const * final;
+        auto name() const noexcept -> char const * final;
+        auto str(std::any const &v) const -> string final;
+        auto equal(std::any const &a, std::any const &b) const -> bool final;
+    };
+
+    auto get_double_type() -> double_type const *;
+
+    auto make_double_datum(double d) -> datum;
+
+    template <>
+    inline auto datum_cast<double>(datum const &d) -> double
+    {
+        if (d._kind != datum::kind::real)
+            throw bad_datum_cast();
+        return d._value.d;
+    }
+
+    template <>
+    inline auto datum_cast<double>(datum const *d) -> double const *
+    {
+        return d->_kind == datum::kind::real ? &d->_value.d : nullptr;
+    }
+
+} // namespace ivy
+
+#endif // IVY_DATUM_DOUBLE_HXX_INCLUDED
@@ -24,11 +24,20 @@ namespace ivy {
 
     auto make_integer_datum(std::int64_t i) -> datum;
 
-    template<>
-    auto datum_cast<std::int64_t>(datum const &) -> std::int64_t;
+    template <>
+    inline auto datum_cast<std::int64_t>(datum const &d) -> std::int64_t
+    {
+        if (d._kind != datum::kind::integer)
+            throw bad_datum_cast();
+        return d._value.i;
+    }
 
     template <>
-    auto datum_cast<std::int64_t>(datum const *) -> std::int64_t const *;
+    inline auto datum_cast<std::int64_t>(datum const *d)
+        -> std::int64_t const *
+    {
+        return d->_kind == datum::kind::integer ? &d->_value.i : nullptr;
+    }
 
 } // namespace ivy
 
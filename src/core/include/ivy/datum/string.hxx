@@ -28,10 +28,19 @@ namespace ivy {
     auto make_string_datum(string::value_type const *s) -> datum;
 
     template <>
-    auto datum_cast<string>(datum const &) -> string;
+    inline auto datum_cast<string>(datum const &d) -> string
+    {
+        if (d._kind != datum::kind::string)
+            throw bad_datum_cast();
+        return d._value.s->value;
+    }
 
     template <>
-    auto datum_cast<string>(datum const *) -> string const *;
+    inline auto datum_cast<string>(datum const *d) -> string const *
+    {
+        return d->_kind == datum::kind::string ? &d->_value.s->value
+                                               : nullptr;
+    }
 
 } // namespace ivy
 
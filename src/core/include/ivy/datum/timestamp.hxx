@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DATUM_TIMESTAMP_HXX_INCLUDED
+#define IVY_DATUM_TIMESTAMP_HXX_INCLUDED
+
+#include <chrono>
+
+#include <ivy/datum.hxx>
+
+namespace ivy {
+
+    // A date and time with microsecond precision, without a time zone.
+    // str() gives YYYY-MM-DD HH:MM:SS, followed by the fraction of a second
+    // if it's not zero.
+    class timestamp_type final : public datum_type {
+    public:
+        using native_type = std::chrono::sys_time<std::chrono::microseconds>;
+
+        auto get() const noexcept -> datum_type const * final;
+        auto name() const noexcept -> char const * final;
+        auto str(std::any const &v) const -> string final;
+        auto equal(std::any const &a, std::any const &b) const -> bool final;
+    };
+
+    auto get_timestamp_type() -> timestamp_type const *;
+
+    auto make_timestamp_datum(std::chrono::sys_time<std::chrono::microseconds> t)
+        -> datum;
+
+    template <>
+    inline auto
+    datum_cast<std::chrono::sys_time<std::chrono::microseconds>>(datum const &d)
+        -> std::chrono::sys_time<std::chrono::microseconds>
+    {
+        if (d._kind != datum::kind::timestamp)
+            throw bad_datum_cast();
+        return d._value.timestamp;
+    }
+
+    template <>
+    inline auto
+    datum_cast<std::chrono::sys_time<std::chrono::microseconds>>(datum const *d)
+        -> std::chrono::sys_time<std::chrono::microseconds> const *
+    {
+        return d->_kind == datum::kind::timestamp ? &d->_value.timestamp
+                                                  : nullptr;
+    }
+
+} // namespace ivy
+
+#endif // IVY_DATUM_TIMESTAMP_HXX_INCLUDED
@@ -6,10 +6,14 @@
 #ifndef IVY_DB_HXX_INCLUDED
 #define IVY_DB_HXX_INCLUDED
 
+#include <ivy/db/async.hxx>
 #include <ivy/db/connection.hxx>
+#include <ivy/db/connection_pool.hxx>
 #include <ivy/db/error.hxx>
+#include <ivy/db/memory.hxx>
 #include <ivy/db/query.hxx>
 #include <ivy/db/query_result.hxx>
+#include <ivy/db/record_batch.hxx>
 #include <ivy/db/result_set.hxx>
 #include <ivy/db/row.hxx>
 #include <ivy/db/value.hxx>
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DB_ASYNC_HXX_INCLUDED
+#define IVY_DB_ASYNC_HXX_INCLUDED
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <ivy/db/query.hxx>
+#include <ivy/db/record_batch.hxx>
+#include <ivy/db/result_set.hxx>
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/noncopyable.hxx>
+
+namespace ivy::db {
+
+    /*************************************************************************
+     *
+     * worker_pool: threads which run blocking database calls, so the
+     * calling thread can carry on and collect the result from a future.
+     *
+     * The objects a task uses (the query, result set and so on) must stay
+     * alive until its future is ready, and each one must only be used by
+     * one task, or by the caller, at a time.
+     */
+
+    class worker_pool : nonmovable {
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::deque<std::function<void()>> _tasks;
+        bool _stopping = false;
+        std::vector<std::thread> _threads;
+
+        auto run() -> void;
+        auto push(std::function<void()> task) -> void;
+
+    public:
+        explicit worker_pool(std::size_t nthreads = 4);
+
+        // Runs the tasks which are already queued, then stops the threads.
+        ~worker_pool();
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return _threads.size();
+        }
+
+        // Run f() on one of the pool's threads.
+        template <typename F>
+        auto submit(F &&f) -> std::future<std::invoke_result_t<F &>>
+        {
+            using result_type = std::invoke_result_t<F &>;
+
+            // std::function needs a copyable target, and packaged_task
+            // isn't one.
+            auto task = std::make_shared<std::packaged_task<result_type()>>(
+                std::forward<F>(f));
+            auto future = task->get_future();
+            push([task] { (*task)(); });
+            return future;
+        }
+    };
+
+    // Run query.execute() on the pool.
+    [[nodiscard]] auto execute_async(worker_pool &pool, query &query)
+        -> std::future<expected<query_result_handle, error>>;
+
+    // Run rs.next_batch(batch, max_rows) on the pool.
+    [[nodiscard]] auto next_batch_async(worker_pool &pool,
+                                        result_set &rs,
+                                        record_batch &batch,
+                                        std::size_t max_rows)
+        -> std::future<expected<std::size_t, error>>;
+
+    /*************************************************************************
+     *
+     * batch_reader: reads a result set as record batches, fetching the
+     * next batch on a worker_pool while the caller works on the current
+     * one, so the time spent waiting for the driver and the network
+     * overlaps with the caller's processing.
+     *
+     * It alternates between two batches: the one returned by next() stays
+     * valid until next() is called again, and the other is being filled
+     * in the meantime.  The result set must not be used by anything else
+     * while the reader exists.
+     */
+
+    class batch_reader : nonmovable {
+        worker_pool *_pool;
+        result_set *_result_set;
+        std::size_t _batch_rows;
+
+        std::array<record_batch, 2> _batches;
+        // The batch being filled by _pending.
+        std::size_t _filling = 0;
+        std::future<expected<std::size_t, error>> _pending;
+        // A failed fetch, which every later next() returns, so the caller
+        // can't mistake it for the end of the result set.
+        std::optional<error> _error;
+
+        auto start() -> void;
+
+    public:
+        batch_reader(worker_pool &pool,
+                     result_set &rs,
+                     std::size_t batch_rows = 1000);
+
+        // Waits for a fetch which is still running.
+        ~batch_reader();
+
+        // Wait for the batch being fetched, start fetching the one after
+        // it, and return it.  At the end of the result set, returns
+        // nullptr.  Once a fetch has failed, every call returns its error.
+        [[nodiscard]] auto next() noexcept
+            -> expected<record_batch const *, error>;
+    };
+
+} // namespace ivy::db
+
+#endif // IVY_DB_ASYNC_HXX_INCLUDED
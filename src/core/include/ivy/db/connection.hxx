@@ -25,6 +25,11 @@ namespace ivy::db {
             -> expected<query_handle, error> = 0;
 
         virtual auto disconnect() -> void = 0;
+
+        // Whether the connection still looks usable.  This should be cheap,
+        // and so need not go to the server; it's used to check a connection
+        // before it's taken from a pool.
+        [[nodiscard]] virtual auto is_alive() noexcept -> bool = 0;
     };
 
     using connection_handle = std::unique_ptr<connection>;
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DB_CONNECTION_POOL_HXX_INCLUDED
+#define IVY_DB_CONNECTION_POOL_HXX_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <ivy/db/connection.hxx>
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/metrics.hxx>
+#include <ivy/noncopyable.hxx>
+
+namespace ivy::db {
+
+    class connection_pool;
+
+    struct connection_pool_config {
+        // The pool opens min_size connections when it's filled, and idle
+        // eviction never takes it below this.
+        std::size_t min_size = 0;
+
+        // The most connections the pool will have open at once, leased or
+        // idle.
+        std::size_t max_size = 8;
+
+        // How long lease() waits for a connection when max_size are
+        // already leased.
+        std::chrono::milliseconds lease_timeout = std::chrono::seconds(30);
+
+        // Connections left idle for longer than this are closed, as long
+        // as at least min_size remain open.
+        std::chrono::milliseconds idle_timeout = std::chrono::minutes(5);
+
+        // Check that an idle connection is still alive before leasing it.
+        bool check_on_lease = true;
+
+        // The pool's metrics are registered with these names:
+        //
+        //   <prefix>_wait_nanoseconds      histogram: time spent in lease()
+        //   <prefix>_leases_in_use         gauge
+        //   <prefix>_connections           gauge: open connections
+        //   <prefix>_lease_timeouts_total  counter
+        //
+        // Pools which should be reported separately need different
+        // prefixes.
+        std::string metrics_prefix = "ivy_db_pool";
+        metrics::registry *registry = metrics::get_global_registry();
+    };
+
+    /*************************************************************************
+     *
+     * connection_lease: a connection borrowed from a pool, which returns it
+     * to the pool when the lease is destroyed.
+     */
+
+    class connection_lease : noncopyable {
+        friend class connection_pool;
+
+        connection_pool *_pool = nullptr;
+        connection_handle _connection;
+        bool _broken = false;
+
+        connection_lease(connection_pool *pool, connection_handle conn);
+
+    public:
+        connection_lease() = default;
+        connection_lease(connection_lease &&) noexcept;
+        auto operator=(connection_lease &&) noexcept -> connection_lease &;
+        ~connection_lease();
+
+        [[nodiscard]] auto get() const noexcept -> connection *
+        {
+            return _connection.get();
+        }
+
+        auto operator*() const noexcept -> connection &
+        {
+            return *_connection;
+        }
+
+        auto operator->() const noexcept -> connection *
+        {
+            return _connection.get();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return _connection != nullptr;
+        }
+
+        // Close the connection instead of returning it to the pool, e.g.
+        // after it reported that the server went away.
+        auto discard() noexcept -> void;
+
+        // Return the connection to the pool now.
+        auto release() noexcept -> void;
+    };
+
+    /*************************************************************************
+     *
+     * connection_pool: a thread-safe set of open connections, created with
+     * a factory function, which are leased to one thread at a time.
+     *
+     * Idle connections are reused most-recently-returned first, so that
+     * under light load the rest stay idle long enough to be evicted.
+     * Eviction happens when connections are leased and returned; a pool
+     * which isn't used at all can call evict_idle() from a timer.
+     *
+     * Every lease must be destroyed before the pool is.
+     */
+
+    class connection_pool : nonmovable {
+    public:
+        using factory_type =
+            std::function<expected<connection_handle, error>()>;
+
+    private:
+        friend class connection_lease;
+
+        using clock = std::chrono::steady_clock;
+
+        struct idle_connection {
+            connection_handle connection;
+            clock::time_point since;
+        };
+
+        factory_type _factory;
+        connection_pool_config _config;
+
+        std::mutex _mutex;
+        std::condition_variable _available;
+        // Oldest first.  Its capacity is max_size, so adding to it never
+        // allocates.
+        std::vector<idle_connection> _idle;
+        // Open connections, including leased ones and those being opened.
+        std::size_t _open = 0;
+        std::size_t _leased = 0;
+
+        metrics::histogram *_wait_time;
+        metrics::gauge *_leases_in_use;
+        metrics::gauge *_connections;
+        metrics::counter *_lease_timeouts;
+
+        auto connect() noexcept -> expected<connection_handle, error>;
+        auto give_back(connection_handle conn, bool broken) noexcept -> void;
+        auto take_expired(clock::time_point now,
+                          std::vector<connection_handle> &expired) noexcept
+            -> void;
+        auto close(std::span<connection_handle> conns) noexcept -> void;
+        auto update_gauges() noexcept -> void;
+
+    public:
+        explicit connection_pool(factory_type factory,
+                                 connection_pool_config config = {});
+        ~connection_pool();
+
+        // Open connections until there are at least min_size.
+        [[nodiscard]] auto fill() noexcept -> expected<void, error>;
+
+        // Lease a connection: an idle one if there is one, otherwise a new
+        // one if the pool has fewer than max_size, otherwise wait up to
+        // lease_timeout for one to be returned.  Fails with
+        // std::errc::timed_out if none was, or with the factory's error
+        // if connecting failed.
+        [[nodiscard]] auto lease() noexcept
+            -> expected<connection_lease, error>;
+
+        // Close connections which have been idle for longer than
+        // idle_timeout.  Returns the number closed.
+        auto evict_idle() noexcept -> std::size_t;
+
+        [[nodiscard]] auto size() noexcept -> std::size_t;
+        [[nodiscard]] auto idle() noexcept -> std::size_t;
+        [[nodiscard]] auto in_use() noexcept -> std::size_t;
+    };
+
+} // namespace ivy::db
+
+#endif // IVY_DB_CONNECTION_POOL_HXX_INCLUDED
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DB_MEMORY_HXX_INCLUDED
+#define IVY_DB_MEMORY_HXX_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+
+#include <ivy/db/connection.hxx>
+#include <ivy/db/record_batch.hxx>
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/string.hxx>
+
+namespace ivy::db::memory {
+
+    /*************************************************************************
+     *
+     * An in-process database driver over tables held in memory, for
+     * testing code which uses ivy::db without a real database, and for
+     * measuring the cost of the ivy::db interfaces themselves.
+     *
+     * A table is a record_batch.  There's no SQL: the text of a query is
+     * the name of a table, and running it returns every row of the table,
+     * in one result set.  Parameters aren't supported, and only utf8 and
+     * binary values can be read with open_stream().
+     */
+
+    using table_handle = std::shared_ptr<record_batch const>;
+
+    // A set of named tables, which any number of connections can read.
+    // Tables must be added before the database is shared between threads.
+    class database {
+        std::map<std::u16string, table_handle> _tables;
+
+    public:
+        auto add_table(u16string const &name, record_batch table) -> void;
+
+        // The table, or nullptr if there isn't one with this name.
+        [[nodiscard]] auto find_table(u16string const &name) const
+            -> table_handle;
+    };
+
+    class connection final : public db::connection {
+        std::shared_ptr<database const> _database;
+
+    public:
+        explicit connection(std::shared_ptr<database const> database);
+
+        [[nodiscard]] auto prepare_query(u16string const &) noexcept
+            -> expected<query_handle, error> override;
+
+        // After this, prepare_query() fails and is_alive() is false.
+        auto disconnect() -> void override;
+
+        [[nodiscard]] auto is_alive() noexcept -> bool override;
+    };
+
+    [[nodiscard]] auto
+    connect(std::shared_ptr<database const> database) noexcept
+        -> expected<db::connection_handle, error>;
+
+    /*************************************************************************
+     *
+     * Generated tables.
+     */
+
+    struct column_spec {
+        std::string name;
+        column_type type = column_type::int64;
+
+        // The fraction of rows which are null, from 0 to 1.
+        double null_ratio = 0.0;
+    };
+
+    // A table of 'nrows' rows.  The value in row i depends only on i and
+    // the column's type: i itself for integers, i / 2 for doubles,
+    // "row <i>" for strings and so on.  Which rows are null is chosen
+    // pseudo-randomly from 'seed', so the same arguments always make the
+    // same table.
+    [[nodiscard]] auto generate_table(std::span<column_spec const> columns,
+                                      std::size_t nrows,
+                                      std::uint64_t seed = 1) -> record_batch;
+
+} // namespace ivy::db::memory
+
+#endif // IVY_DB_MEMORY_HXX_INCLUDED
@@ -6,8 +6,11 @@
 #ifndef IVY_DB_QUERY_HXX_INCLUDED
 #define IVY_DB_QUERY_HXX_INCLUDED
 
+#include <cstddef>
 #include <memory>
+#include <span>
 
+#include <ivy/datum.hxx>
 #include <ivy/db/query_result.hxx>
 #include <ivy/error.hxx>
 #include <ivy/expected.hxx>
@@ -22,6 +25,23 @@ namespace ivy::db {
     public:
         virtual ~query() = default;
         virtual auto execute() noexcept -> expected<query_result_handle, error> = 0;
+
+        // Bind a value to the parameter marker 'param', counting from 0.
+        // The value is copied, and stays bound for each execute() until
+        // it is replaced or clear_bindings() is called.
+        [[nodiscard]] virtual auto bind(std::size_t param,
+                                        datum const &value) noexcept
+            -> expected<void, error> = 0;
+
+        // Bind an array of values to a parameter.  execute() then runs the
+        // statement once for each element, sending them all together, so
+        // every parameter bound this way must have the same number of
+        // values.  The values which aren't null must all be of one type.
+        [[nodiscard]] virtual auto
+        bind_array(std::size_t param, std::span<datum const> values) noexcept
+            -> expected<void, error> = 0;
+
+        virtual auto clear_bindings() noexcept -> void = 0;
     };
 
     using query_handle = std::unique_ptr<query>;
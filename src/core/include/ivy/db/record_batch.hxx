@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DB_RECORD_BATCH_HXX_INCLUDED
+#define IVY_DB_RECORD_BATCH_HXX_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ivy/datum.hxx>
+#include <ivy/datum/column.hxx>
+
+namespace ivy::db {
+
+    /*************************************************************************
+     *
+     * Record batches: query results in a columnar layout which matches
+     * Apache Arrow's, so the buffers can be handed to Arrow (e.g. through
+     * the C data interface) or read by analytics code without any per-row
+     * objects.
+     *
+     * Each column has a validity bitmap, one bit per row with 1 meaning not
+     * null, least significant bit first; on a little-endian machine the
+     * bitmap's words are the Arrow validity buffer.  Fixed-width values are
+     * stored in an array with a zero in the slot of a null row.  Booleans
+     * are bit-packed in the same way as the validity bitmap.  Strings and
+     * binary values are stored as int32 offsets and one data buffer, so
+     * value i is data[offsets[i], offsets[i+1]).
+     */
+
+    // The type of a batch column.  Each has the layout of the Arrow type
+    // in the comment.
+    enum struct column_type {
+        null,         // null
+        boolean,      // bool
+        int64,        // int64
+        float64,      // double
+        date32,       // date32: days since 1970-01-01
+        timestamp_us, // timestamp[us]: microseconds since 1970-01-01
+        utf8,         // utf8
+        binary,       // binary
+    };
+
+    // The name of the type, as Arrow spells it.
+    auto column_type_name(column_type type) noexcept -> char const *;
+
+    class batch_column {
+        column_type _type;
+        std::size_t _size = 0;
+        column_bitmap _validity;
+
+        column_bitmap _booleans;
+        std::vector<std::int64_t> _int64s;
+        std::vector<double> _doubles;
+        std::vector<std::int32_t> _int32s;
+        std::vector<std::int32_t> _offsets{0};
+        std::vector<char> _data;
+
+        auto append_valid() -> void;
+        auto end_string() -> void;
+
+    public:
+        explicit batch_column(column_type type);
+
+        [[nodiscard]] auto type() const noexcept -> column_type
+        {
+            return _type;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return _size;
+        }
+
+        [[nodiscard]] auto validity() const noexcept -> column_bitmap const &
+        {
+            return _validity;
+        }
+
+        [[nodiscard]] auto is_null(std::size_t i) const noexcept -> bool
+        {
+            return !_validity.test(i);
+        }
+
+        [[nodiscard]] auto null_count() const noexcept -> std::size_t
+        {
+            return _size - _validity.count();
+        }
+
+        // Remove every value, but keep the memory, so a batch can be
+        // refilled without allocating.
+        auto clear() noexcept -> void;
+
+        auto reserve(std::size_t n) -> void;
+
+        // Append a value.  Each of these must match the column's type,
+        // except append_null(), and append_utf16() and append_utf32(),
+        // which convert to UTF-8 for a utf8 column.  String values longer
+        // than the int32 offsets allow throw std::length_error.
+        auto append_null() -> void;
+        auto append_boolean(bool value) -> void;
+        auto append_int64(std::int64_t value) -> void;
+        auto append_double(double value) -> void;
+        auto append_date(std::chrono::sys_days value) -> void;
+        auto append_timestamp(
+            std::chrono::sys_time<std::chrono::microseconds> value) -> void;
+        auto append_utf8(std::string_view value) -> void;
+        auto append_utf16(std::u16string_view value) -> void;
+        auto append_utf32(std::u32string_view value) -> void;
+        auto append_binary(std::span<std::byte const> value) -> void;
+
+        // Append a datum, which must be null or of the column's type.
+        // Throws bad_datum_cast if it isn't.
+        auto append(datum const &value) -> void;
+
+        // The buffers.  booleans() is for boolean columns; int64s() for
+        // int64 and timestamp_us; doubles() for float64; int32s() for
+        // date32; offsets() and data() for utf8 and binary.
+        [[nodiscard]] auto booleans() const noexcept -> column_bitmap const &
+        {
+            return _booleans;
+        }
+
+        [[nodiscard]] auto int64s() const noexcept
+            -> std::span<std::int64_t const>
+        {
+            return _int64s;
+        }
+
+        [[nodiscard]] auto doubles() const noexcept -> std::span<double const>
+        {
+            return _doubles;
+        }
+
+        [[nodiscard]] auto int32s() const noexcept
+            -> std::span<std::int32_t const>
+        {
+            return _int32s;
+        }
+
+        [[nodiscard]] auto offsets() const noexcept
+            -> std::span<std::int32_t const>
+        {
+            return _offsets;
+        }
+
+        [[nodiscard]] auto data() const noexcept -> std::span<char const>
+        {
+            return _data;
+        }
+
+        // Value i of a utf8 or binary column, without copying it.
+        [[nodiscard]] auto string_at(std::size_t i) const noexcept
+            -> std::string_view
+        {
+            return std::string_view(_data.data() + _offsets[i],
+                                    static_cast<std::size_t>(
+                                        _offsets[i + 1] - _offsets[i]));
+        }
+
+        // Row 'i' as a datum.
+        [[nodiscard]] auto value(std::size_t i) const -> datum;
+    };
+
+    /*************************************************************************
+     *
+     * record_batch: a set of named columns of the same length.
+     */
+
+    class record_batch {
+        std::vector<std::string> _names;
+        std::vector<batch_column> _columns;
+
+    public:
+        record_batch() = default;
+
+        [[nodiscard]] auto num_columns() const noexcept -> std::size_t
+        {
+            return _columns.size();
+        }
+
+        [[nodiscard]] auto num_rows() const noexcept -> std::size_t
+        {
+            return _columns.empty() ? 0 : _columns.front().size();
+        }
+
+        [[nodiscard]] auto column(std::size_t i) noexcept -> batch_column &
+        {
+            return _columns[i];
+        }
+
+        [[nodiscard]] auto column(std::size_t i) const noexcept
+            -> batch_column const &
+        {
+            return _columns[i];
+        }
+
+        // The column's name, in UTF-8.
+        [[nodiscard]] auto name(std::size_t i) const noexcept
+            -> std::string const &
+        {
+            return _names[i];
+        }
+
+        auto add_column(std::string name, column_type type) -> batch_column &;
+
+        // Remove every column.
+        auto reset() noexcept -> void;
+
+        // Remove every row, keeping the columns and their memory.
+        auto clear() noexcept -> void;
+    };
+
+} // namespace ivy::db
+
+#endif // IVY_DB_RECORD_BATCH_HXX_INCLUDED
@@ -9,6 +9,7 @@
 #include <memory>
 
 #include <ivy/noncopyable.hxx>
+#include <ivy/db/record_batch.hxx>
 #include <ivy/db/row.hxx>
 
 namespace ivy::db {
@@ -51,7 +52,7 @@ namespace ivy::db {
 
     class row_range {
         result_set *_rs;
-        row_handle _cur;
+        row *_cur{};
         friend class result_set;
         friend class row_iterator;
 
@@ -82,6 +83,22 @@ namespace ivy::db {
         [[nodiscard]] virtual auto get_next_row() noexcept
             -> expected<row_handle, error> = 0;
 
+        // Move to the next row.  Unlike get_next_row(), the row object
+        // belongs to the result set and is the same for every row, so this
+        // doesn't allocate.  This is what rows() uses.
+        [[nodiscard]] virtual auto next_row() noexcept
+            -> expected<row *, error> = 0;
+
+        // Fetch up to max_rows rows into 'batch' in columnar form, and
+        // return the number fetched, which is less than max_rows only at
+        // the end of the result set.  The batch's columns are set up from
+        // the result set's, and if they already match, are cleared and
+        // refilled without allocating new storage.  This and rows() share
+        // a cursor.
+        [[nodiscard]] virtual auto next_batch(record_batch &batch,
+                                              std::size_t max_rows) noexcept
+            -> expected<std::size_t, error> = 0;
+
         [[nodiscard]] auto rows() -> row_range;
     };
 
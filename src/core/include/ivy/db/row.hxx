@@ -7,7 +7,9 @@
 #define IVY_DB_ROW_HXX_INCLUDED
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string_view>
 
 #include <ivy/db/value.hxx>
 #include <ivy/expected.hxx>
@@ -55,7 +57,7 @@ namespace ivy::db {
 
     class value_range {
         row *_row{};
-        value_handle _cur{};
+        value *_cur{};
         std::size_t _ncols{};
         friend class row;
         friend class value_iterator;
@@ -86,6 +88,34 @@ namespace ivy::db {
         [[nodiscard]] virtual auto get_value(std::size_t column) noexcept
             -> expected<value_handle, error> = 0;
 
+        // Like get_value(), but the value object belongs to the row and is
+        // reused for each call, so it's only valid until the next call.
+        // This is what values() uses.
+        [[nodiscard]] virtual auto value_at(std::size_t column) noexcept
+            -> expected<value *, error> = 0;
+
+        // Typed access to the current row's values, which reads them
+        // directly from the driver's buffers and doesn't allocate.  Reading
+        // a null value is an error, so check is_null() first if the column
+        // can be null.
+        [[nodiscard]] virtual auto is_null(std::size_t column) noexcept
+            -> expected<bool, error> = 0;
+
+        [[nodiscard]] virtual auto get_int64(std::size_t column) noexcept
+            -> expected<std::int64_t, error> = 0;
+
+        [[nodiscard]] virtual auto get_double(std::size_t column) noexcept
+            -> expected<double, error> = 0;
+
+        // The value as UTF-16 text.  The characters belong to the row and
+        // are only valid until the next call to get_string_view(), or until
+        // the result set moves to another row.
+        [[nodiscard]] virtual auto get_string_view(std::size_t column) noexcept
+            -> expected<std::u16string_view, error> = 0;
+
+        [[nodiscard]] virtual auto get_datum(std::size_t column) noexcept
+            -> expected<datum, error> = 0;
+
         [[nodiscard]] auto values() -> value_range;
     };
 
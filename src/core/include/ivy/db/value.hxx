@@ -6,9 +6,11 @@
 #ifndef IVY_DB_VALUE_HXX_INCLUDED
 #define IVY_DB_VALUE_HXX_INCLUDED
 
+#include <cstddef>
 #include <memory>
 #include <cstdint>
 
+#include <ivy/io/pmrchannel.hxx>
 #include <ivy/noncopyable.hxx>
 #include <ivy/string.hxx>
 #include <ivy/expected.hxx>
@@ -24,6 +26,15 @@ namespace ivy::db {
         virtual ~value() = default;
 
         virtual auto as_datum() const noexcept -> expected<datum, error> = 0;
+
+        // The value as a stream of bytes, which the driver fetches a piece
+        // at a time, so a large value never has to be held in memory
+        // whole.  Binary values are streamed as they are and anything else
+        // as UTF-8 text; a null value is an empty stream.  The stream reads
+        // the current row, so it must be finished before the result set
+        // moves to another row, and a value can only be streamed once.
+        [[nodiscard]] virtual auto open_stream() noexcept
+            -> expected<std::unique_ptr<pmrichannel<std::byte>>, error> = 0;
     };
 
     using value_handle = std::unique_ptr<value>;
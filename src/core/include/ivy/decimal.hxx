@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DECIMAL_HXX_INCLUDED
+#define IVY_DECIMAL_HXX_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+
+namespace ivy {
+
+    /*
+     * decimal: an exact decimal number, as stored in a DECIMAL or NUMERIC
+     * column.  The value is a 128-bit unsigned magnitude and a sign, scaled
+     * down by 10^scale, which holds the 38 digits SQL allows.
+     *
+     * Two decimals are equal if they have the same value, so 1.5 == 1.50;
+     * the scale only affects how the value is printed.
+     */
+    class decimal {
+        std::uint64_t _high = 0;
+        std::uint64_t _low = 0;
+        std::uint8_t _scale = 0;
+        bool _negative = false;
+
+    public:
+        static constexpr unsigned max_digits = 38;
+
+        decimal() noexcept = default;
+
+        // unscaled / 10^scale.
+        decimal(std::int64_t unscaled, unsigned scale);
+
+        // The magnitude as two 64-bit halves, as in SQL_NUMERIC_STRUCT.
+        decimal(bool negative,
+                std::uint64_t high,
+                std::uint64_t low,
+                unsigned scale);
+
+        // Parse a decimal number, e.g. "-123.450".  Exponents aren't
+        // accepted.
+        static auto parse(std::string_view s) -> expected<decimal, error>;
+
+        [[nodiscard]] auto negative() const noexcept -> bool
+        {
+            return _negative;
+        }
+
+        [[nodiscard]] auto scale() const noexcept -> unsigned
+        {
+            return _scale;
+        }
+
+        [[nodiscard]] auto high() const noexcept -> std::uint64_t
+        {
+            return _high;
+        }
+
+        [[nodiscard]] auto low() const noexcept -> std::uint64_t
+        {
+            return _low;
+        }
+
+        [[nodiscard]] auto is_zero() const noexcept -> bool
+        {
+            return _high == 0 && _low == 0;
+        }
+
+        // The value in decimal, with exactly scale() digits after the point.
+        [[nodiscard]] auto str() const -> std::string;
+
+        // The nearest double to the value.
+        [[nodiscard]] auto to_double() const -> double;
+
+        friend auto operator==(decimal const &a, decimal const &b) noexcept
+            -> bool;
+    };
+
+} // namespace ivy
+
+#endif // IVY_DECIMAL_HXX_INCLUDED
@@ -0,0 +1,1109 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_FLAT_HASH_MAP_HXX_INCLUDED
+#define IVY_FLAT_HASH_MAP_HXX_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define IVY_FLAT_HASH_SSE2
+#    include <emmintrin.h>
+#endif
+
+#include <ivy/hash.hxx>
+
+/*
+ * flat_hash_map and flat_hash_set: open-addressing hash tables after
+ * Google's SwissTable.
+ *
+ * Elements are stored in a single array of slots, with a parallel array of
+ * one-byte control words.  A control word is either empty, deleted, or the
+ * low 7 bits of the hash of the element in that slot.  Lookup compares the
+ * 7 bits against a group of 16 control words at a time (with SSE2 when
+ * available), so nearly every slot whose key is compared is a match, and
+ * the table can be filled to 7/8 of its capacity.
+ *
+ * Unlike std::unordered_map, there is no allocation per element, and
+ * inserting or erasing elements invalidates iterators and references.
+ *
+ * When both the hash and the key comparison are transparent, lookup works
+ * with any type they accept; for ivy::basic_string keys and the default
+ * ivy::hash, a map can be searched with a char8_t const * or a span
+ * without constructing a string.
+ */
+
+namespace ivy {
+
+    namespace detail {
+
+        using hash_ctrl = std::int8_t;
+
+        // Control words with the top bit set are not full; full slots hold
+        // the low 7 bits of the element's hash.
+        inline constexpr hash_ctrl hash_ctrl_empty = -128;
+        inline constexpr hash_ctrl hash_ctrl_deleted = -2;
+
+        inline constexpr std::size_t hash_group_width = 16;
+
+        // A set of positions in a group, one bit per control word.
+        class hash_group_mask {
+            std::uint32_t _bits;
+
+        public:
+            explicit hash_group_mask(std::uint32_t bits) noexcept
+                : _bits(bits)
+            {
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return _bits != 0;
+            }
+
+            [[nodiscard]] auto lowest() const noexcept -> std::size_t
+            {
+                return static_cast<std::size_t>(std::countr_zero(_bits));
+            }
+
+            [[nodiscard]] auto highest_clear() const noexcept -> std::size_t
+            {
+                return static_cast<std::size_t>(
+                    std::countl_zero(_bits << (32 - hash_group_width)));
+            }
+
+            auto clear_lowest() noexcept -> void
+            {
+                _bits &= _bits - 1;
+            }
+        };
+
+        // hash_group_width control words, loaded from any position.
+        class hash_group {
+#if defined(IVY_FLAT_HASH_SSE2)
+            __m128i _ctrl;
+
+        public:
+            explicit hash_group(hash_ctrl const *p) noexcept
+                : _ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)))
+            {
+            }
+
+            [[nodiscard]] auto match(hash_ctrl h2) const noexcept
+                -> hash_group_mask
+            {
+                return hash_group_mask(static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl))));
+            }
+
+            [[nodiscard]] auto match_empty_or_deleted() const noexcept
+                -> hash_group_mask
+            {
+                return hash_group_mask(
+                    static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl)));
+            }
+
+            [[nodiscard]] auto match_full() const noexcept -> hash_group_mask
+            {
+                return hash_group_mask(
+                    ~static_cast<std::uint32_t>(_mm_movemask_epi8(_ctrl)) &
+                    0xFFFFu);
+            }
+#else
+            std::array<hash_ctrl, hash_group_width> _ctrl;
+
+            template <typename Pred>
+            auto match_if(Pred pred) const noexcept -> hash_group_mask
+            {
+                std::uint32_t bits = 0;
+                for (std::size_t i = 0; i < hash_group_width; ++i)
+                    if (pred(_ctrl[i]))
+                        bits |= std::uint32_t(1) << i;
+                return hash_group_mask(bits);
+            }
+
+        public:
+            explicit hash_group(hash_ctrl const *p) noexcept
+            {
+                std::memcpy(_ctrl.data(), p, hash_group_width);
+            }
+
+            [[nodiscard]] auto match(hash_ctrl h2) const noexcept
+                -> hash_group_mask
+            {
+                return match_if([=](hash_ctrl c) { return c == h2; });
+            }
+
+            [[nodiscard]] auto match_empty_or_deleted() const noexcept
+                -> hash_group_mask
+            {
+                return match_if([](hash_ctrl c) { return c < 0; });
+            }
+
+            [[nodiscard]] auto match_full() const noexcept -> hash_group_mask
+            {
+                return match_if([](hash_ctrl c) { return c >= 0; });
+            }
+#endif
+
+            [[nodiscard]] auto match_empty() const noexcept -> hash_group_mask
+            {
+                return match(hash_ctrl_empty);
+            }
+        };
+
+        // The largest number of elements a table of the given capacity
+        // holds before it grows: a maximum load factor of 7/8.
+        constexpr auto hash_capacity_to_growth(std::size_t capacity) noexcept
+            -> std::size_t
+        {
+            return capacity - capacity / 8;
+        }
+
+        // Heterogeneous lookup: when the table is transparent, lookup
+        // functions take any key type, otherwise they take key_type.
+        template <bool transparent>
+        struct hash_key_arg {
+            template <typename K, typename key_type>
+            using type = K;
+        };
+
+        template <>
+        struct hash_key_arg<false> {
+            template <typename K, typename key_type>
+            using type = key_type;
+        };
+
+        template <typename T>
+        concept transparent_function = requires {
+            typename T::is_transparent;
+        };
+
+        /*
+         * flat_hash_table: the implementation of flat_hash_map and
+         * flat_hash_set.  'Policy' describes how elements are stored in
+         * slots and how to find the key of an element.
+         *
+         * The control array has hash_group_width extra words at the end,
+         * which mirror the first hash_group_width words, so a group can be
+         * loaded at any position without wrapping.
+         */
+        template <typename Policy,
+                  typename Hash,
+                  typename KeyEqual,
+                  typename Allocator>
+        class flat_hash_table {
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using hasher = Hash;
+            using key_equal = KeyEqual;
+            using allocator_type = Allocator;
+            using reference = value_type &;
+            using const_reference = value_type const &;
+
+        protected:
+            using slot_type = typename Policy::slot_type;
+            using slot_allocator = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<slot_type>;
+            using ctrl_allocator = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<hash_ctrl>;
+
+            static constexpr bool is_transparent =
+                transparent_function<Hash> && transparent_function<KeyEqual>;
+
+            template <typename K>
+            using key_arg = typename hash_key_arg<
+                is_transparent>::template type<K, key_type>;
+
+            static constexpr size_type npos = static_cast<size_type>(-1);
+
+        private:
+            hash_ctrl *_ctrl = nullptr;
+            slot_type *_slots = nullptr;
+            size_type _capacity = 0;
+            size_type _size = 0;
+            size_type _growth_left = 0;
+
+            [[no_unique_address]] Hash _hash;
+            [[no_unique_address]] KeyEqual _eq;
+            [[no_unique_address]] Allocator _alloc;
+
+            static auto h1(std::size_t hash) noexcept -> std::size_t
+            {
+                return hash >> 7;
+            }
+
+            static auto h2(std::size_t hash) noexcept -> hash_ctrl
+            {
+                return static_cast<hash_ctrl>(hash & 0x7F);
+            }
+
+            auto set_ctrl(size_type i, hash_ctrl c) noexcept -> void
+            {
+                _ctrl[i] = c;
+                if (i < hash_group_width)
+                    _ctrl[_capacity + i] = c;
+            }
+
+            // Find the first empty or deleted slot in the probe sequence
+            // for 'hash'.  There must be one.
+            auto find_insert_slot(std::size_t hash) const noexcept
+                -> size_type
+            {
+                auto mask = _capacity - 1;
+                auto pos = h1(hash) & mask;
+
+                for (size_type step = hash_group_width;;
+                     step += hash_group_width) {
+                    hash_group g(_ctrl + pos);
+                    if (auto m = g.match_empty_or_deleted(); m)
+                        return (pos + m.lowest()) & mask;
+                    pos = (pos + step) & mask;
+                }
+            }
+
+            template <typename K>
+            auto find_index(K const &key, std::size_t hash) const
+                -> size_type
+            {
+                if (_capacity == 0)
+                    return npos;
+
+                auto mask = _capacity - 1;
+                auto pos = h1(hash) & mask;
+                auto h = h2(hash);
+
+                for (size_type step = hash_group_width;;
+                     step += hash_group_width) {
+                    hash_group g(_ctrl + pos);
+
+                    for (auto m = g.match(h); m; m.clear_lowest()) {
+                        auto i = (pos + m.lowest()) & mask;
+                        if (_eq(Policy::key(_slots[i]), key))
+                            return i;
+                    }
+
+                    if (g.match_empty())
+                        return npos;
+
+                    pos = (pos + step) & mask;
+                }
+            }
+
+            auto allocate(size_type capacity) -> void
+            {
+                ctrl_allocator ca(_alloc);
+                slot_allocator sa(_alloc);
+
+                auto *ctrl = std::allocator_traits<ctrl_allocator>::allocate(
+                    ca, capacity + hash_group_width);
+
+                try {
+                    _slots = std::allocator_traits<slot_allocator>::allocate(
+                        sa, capacity);
+                } catch (...) {
+                    std::allocator_traits<ctrl_allocator>::deallocate(
+                        ca, ctrl, capacity + hash_group_width);
+                    throw;
+                }
+
+                _ctrl = ctrl;
+                std::memset(_ctrl, static_cast<unsigned char>(hash_ctrl_empty),
+                            capacity + hash_group_width);
+                _capacity = capacity;
+                _growth_left = hash_capacity_to_growth(capacity);
+            }
+
+            static auto deallocate(Allocator const &alloc,
+                                   hash_ctrl *ctrl,
+                                   slot_type *slots,
+                                   size_type capacity) noexcept -> void
+            {
+                if (capacity == 0)
+                    return;
+
+                ctrl_allocator ca(alloc);
+                slot_allocator sa(alloc);
+                std::allocator_traits<ctrl_allocator>::deallocate(
+                    ca, ctrl, capacity + hash_group_width);
+                std::allocator_traits<slot_allocator>::deallocate(
+                    sa, slots, capacity);
+            }
+
+            auto destroy_elements() noexcept -> void
+            {
+                if constexpr (std::is_trivially_destructible_v<value_type>)
+                    return;
+
+                for (size_type i = 0; i < _capacity; ++i)
+                    if (_ctrl[i] >= 0)
+                        Policy::destroy(&_slots[i]);
+            }
+
+            // Move every element into a new array of 'capacity' slots.
+            // Element moves are expected not to throw.
+            auto resize(size_type capacity) -> void
+            {
+                auto *old_ctrl = _ctrl;
+                auto *old_slots = _slots;
+                auto old_capacity = _capacity;
+
+                allocate(capacity);
+
+                for (size_type i = 0; i < old_capacity; ++i) {
+                    if (old_ctrl[i] < 0)
+                        continue;
+
+                    auto hash = _hash(Policy::key(old_slots[i]));
+                    auto j = find_insert_slot(hash);
+                    set_ctrl(j, h2(hash));
+                    Policy::transfer(&_slots[j], &old_slots[i]);
+                }
+
+                _growth_left -= _size;
+                deallocate(_alloc, old_ctrl, old_slots, old_capacity);
+            }
+
+            // Make room for at least one more element.
+            auto grow() -> void
+            {
+                if (_capacity == 0)
+                    resize(hash_group_width);
+                else if (_size <= hash_capacity_to_growth(_capacity) / 2)
+                    // Mostly deleted slots; rehashing in place is enough.
+                    resize(_capacity);
+                else
+                    resize(_capacity * 2);
+            }
+
+        protected:
+            // Find the slot for a new element with the given hash.  Nothing
+            // is changed until commit_insert() is called, so the caller can
+            // construct the element first.
+            auto prepare_insert(std::size_t hash) -> size_type
+            {
+                if (_capacity == 0)
+                    grow();
+
+                auto i = find_insert_slot(hash);
+
+                if (_growth_left == 0 && _ctrl[i] != hash_ctrl_deleted) {
+                    grow();
+                    i = find_insert_slot(hash);
+                }
+
+                return i;
+            }
+
+            auto commit_insert(size_type i, std::size_t hash) noexcept -> void
+            {
+                if (_ctrl[i] == hash_ctrl_empty)
+                    --_growth_left;
+
+                set_ctrl(i, h2(hash));
+                ++_size;
+            }
+
+            auto slot(size_type i) noexcept -> slot_type *
+            {
+                return &_slots[i];
+            }
+
+            // Find the element with the given key, or insert one made by
+            // 'make(slot)'.  Returns the index and whether it was inserted.
+            template <typename K, typename Make>
+            auto find_or_insert(K const &key, Make &&make)
+                -> std::pair<size_type, bool>
+            {
+                auto hash = _hash(key);
+
+                if (auto i = find_index(key, hash); i != npos)
+                    return {i, false};
+
+                auto i = prepare_insert(hash);
+                std::forward<Make>(make)(&_slots[i]);
+                commit_insert(i, hash);
+                return {i, true};
+            }
+
+            auto erase_index(size_type i) noexcept -> void
+            {
+                Policy::destroy(&_slots[i]);
+                --_size;
+
+                // If there was never a full group around this slot, no probe
+                // sequence can have passed over it, so it can be empty again.
+                // Otherwise mark it deleted so later probes keep going.
+                auto mask = _capacity - 1;
+                auto before = (i - hash_group_width) & mask;
+                auto empty_after = hash_group(_ctrl + i).match_empty();
+                auto empty_before = hash_group(_ctrl + before).match_empty();
+
+                if (empty_before && empty_after &&
+                    empty_after.lowest() + empty_before.highest_clear() <
+                        hash_group_width) {
+                    set_ctrl(i, hash_ctrl_empty);
+                    ++_growth_left;
+                } else
+                    set_ctrl(i, hash_ctrl_deleted);
+            }
+
+        public:
+            template <bool is_const>
+            class basic_iterator {
+                friend class flat_hash_table;
+
+                hash_ctrl const *_ctrl = nullptr;
+                hash_ctrl const *_end = nullptr;
+                slot_type *_slot = nullptr;
+
+                basic_iterator(hash_ctrl const *ctrl,
+                               hash_ctrl const *end,
+                               slot_type *slot) noexcept
+                    : _ctrl(ctrl)
+                    , _end(end)
+                    , _slot(slot)
+                {
+                }
+
+                // Advance to the next full slot, a group at a time.
+                auto skip_empty() noexcept -> void
+                {
+                    while (_ctrl != _end) {
+                        auto remaining = static_cast<std::size_t>(_end - _ctrl);
+                        auto full = hash_group(_ctrl).match_full();
+                        auto n = full ? full.lowest() : hash_group_width;
+                        n = std::min(n, remaining);
+
+                        _ctrl += n;
+                        _slot += n;
+
+                        if (full && n < remaining)
+                            return;
+                    }
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference =
+                    std::conditional_t<is_const || Policy::constant_iterators,
+                                       value_type const &,
+                                       value_type &>;
+                using pointer = std::add_pointer_t<reference>;
+
+                basic_iterator() = default;
+
+                // Allow iterator -> const_iterator.
+                template <bool other_const>
+                basic_iterator(basic_iterator<other_const> const &other) noexcept
+                    requires(is_const && !other_const)
+                    : _ctrl(other._ctrl)
+                    , _end(other._end)
+                    , _slot(other._slot)
+                {
+                }
+
+                auto operator*() const noexcept -> reference
+                {
+                    return Policy::element(_slot);
+                }
+
+                auto operator->() const noexcept -> pointer
+                {
+                    return &Policy::element(_slot);
+                }
+
+                auto operator++() noexcept -> basic_iterator &
+                {
+                    ++_ctrl;
+                    ++_slot;
+                    skip_empty();
+                    return *this;
+                }
+
+                auto operator++(int) noexcept -> basic_iterator
+                {
+                    auto ret = *this;
+                    ++*this;
+                    return ret;
+                }
+
+                auto operator==(basic_iterator const &other) const noexcept
+                    -> bool
+                {
+                    return _ctrl == other._ctrl;
+                }
+
+                friend class basic_iterator<!is_const>;
+            };
+
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+        protected:
+            auto make_iterator(size_type i) const noexcept -> iterator
+            {
+                return iterator(_ctrl + i, _ctrl + _capacity, _slots + i);
+            }
+
+        public:
+            flat_hash_table() = default;
+
+            explicit flat_hash_table(size_type bucket_count,
+                                     Hash const &hash = Hash(),
+                                     KeyEqual const &eq = KeyEqual(),
+                                     Allocator const &alloc = Allocator())
+                : _hash(hash)
+                , _eq(eq)
+                , _alloc(alloc)
+            {
+                reserve(bucket_count);
+            }
+
+            flat_hash_table(flat_hash_table const &other)
+                : _hash(other._hash)
+                , _eq(other._eq)
+                , _alloc(std::allocator_traits<Allocator>::
+                             select_on_container_copy_construction(
+                                 other._alloc))
+            {
+                reserve(other._size);
+
+                for (size_type i = 0; i < other._capacity; ++i) {
+                    if (other._ctrl[i] < 0)
+                        continue;
+
+                    auto hash = _hash(Policy::key(other._slots[i]));
+                    auto j = prepare_insert(hash);
+                    Policy::construct(&_slots[j],
+                                      Policy::element(&other._slots[i]));
+                    commit_insert(j, hash);
+                }
+            }
+
+            flat_hash_table(flat_hash_table &&other) noexcept
+                : _ctrl(std::exchange(other._ctrl, nullptr))
+                , _slots(std::exchange(other._slots, nullptr))
+                , _capacity(std::exchange(other._capacity, 0))
+                , _size(std::exchange(other._size, 0))
+                , _growth_left(std::exchange(other._growth_left, 0))
+                , _hash(std::move(other._hash))
+                , _eq(std::move(other._eq))
+                , _alloc(std::move(other._alloc))
+            {
+            }
+
+            auto operator=(flat_hash_table const &other) -> flat_hash_table &
+            {
+                if (this != &other) {
+                    auto tmp(other);
+                    swap(tmp);
+                }
+                return *this;
+            }
+
+            auto operator=(flat_hash_table &&other) noexcept
+                -> flat_hash_table &
+            {
+                if (this != &other) {
+                    auto tmp(std::move(other));
+                    swap(tmp);
+                }
+                return *this;
+            }
+
+            ~flat_hash_table()
+            {
+                destroy_elements();
+                deallocate(_alloc, _ctrl, _slots, _capacity);
+            }
+
+            auto swap(flat_hash_table &other) noexcept -> void
+            {
+                using std::swap;
+                swap(_ctrl, other._ctrl);
+                swap(_slots, other._slots);
+                swap(_capacity, other._capacity);
+                swap(_size, other._size);
+                swap(_growth_left, other._growth_left);
+                swap(_hash, other._hash);
+                swap(_eq, other._eq);
+                swap(_alloc, other._alloc);
+            }
+
+            friend auto swap(flat_hash_table &a, flat_hash_table &b) noexcept
+                -> void
+            {
+                a.swap(b);
+            }
+
+            [[nodiscard]] auto begin() noexcept -> iterator
+            {
+                auto it = make_iterator(0);
+                it.skip_empty();
+                return it;
+            }
+
+            [[nodiscard]] auto end() noexcept -> iterator
+            {
+                return make_iterator(_capacity);
+            }
+
+            [[nodiscard]] auto begin() const noexcept -> const_iterator
+            {
+                return const_cast<flat_hash_table *>(this)->begin();
+            }
+
+            [[nodiscard]] auto end() const noexcept -> const_iterator
+            {
+                return const_cast<flat_hash_table *>(this)->end();
+            }
+
+            [[nodiscard]] auto cbegin() const noexcept -> const_iterator
+            {
+                return begin();
+            }
+
+            [[nodiscard]] auto cend() const noexcept -> const_iterator
+            {
+                return end();
+            }
+
+            [[nodiscard]] auto empty() const noexcept -> bool
+            {
+                return _size == 0;
+            }
+
+            [[nodiscard]] auto size() const noexcept -> size_type
+            {
+                return _size;
+            }
+
+            [[nodiscard]] auto capacity() const noexcept -> size_type
+            {
+                return _capacity;
+            }
+
+            [[nodiscard]] auto load_factor() const noexcept -> float
+            {
+                return _capacity ? static_cast<float>(_size) /
+                                       static_cast<float>(_capacity)
+                                 : 0.0f;
+            }
+
+            [[nodiscard]] auto hash_function() const -> hasher
+            {
+                return _hash;
+            }
+
+            [[nodiscard]] auto key_eq() const -> key_equal
+            {
+                return _eq;
+            }
+
+            [[nodiscard]] auto get_allocator() const -> allocator_type
+            {
+                return _alloc;
+            }
+
+            // Remove every element, but keep the capacity.
+            auto clear() noexcept -> void
+            {
+                destroy_elements();
+
+                if (_capacity) {
+                    std::memset(_ctrl,
+                                static_cast<unsigned char>(hash_ctrl_empty),
+                                _capacity + hash_group_width);
+                    _growth_left = hash_capacity_to_growth(_capacity);
+                }
+
+                _size = 0;
+            }
+
+            // Make room for at least 'n' elements without growing.
+            auto reserve(size_type n) -> void
+            {
+                if (n <= _size + _growth_left && _capacity != 0)
+                    return;
+
+                if (n == 0)
+                    return;
+
+                auto capacity = hash_group_width;
+                while (hash_capacity_to_growth(capacity) < n)
+                    capacity *= 2;
+
+                if (capacity > _capacity)
+                    resize(capacity);
+            }
+
+            // Rehash to hold at least 'n' slots, removing deleted slots.
+            auto rehash(size_type n) -> void
+            {
+                auto capacity = std::max(
+                    std::bit_ceil(std::max(n, hash_group_width)), _capacity);
+
+                while (hash_capacity_to_growth(capacity) < _size)
+                    capacity *= 2;
+
+                if (capacity != 0)
+                    resize(capacity);
+            }
+
+            template <typename K = key_type>
+            [[nodiscard]] auto find(key_arg<K> const &key) -> iterator
+            {
+                auto i = find_index(key, _hash(key));
+                return i == npos ? end() : make_iterator(i);
+            }
+
+            template <typename K = key_type>
+            [[nodiscard]] auto find(key_arg<K> const &key) const
+                -> const_iterator
+            {
+                return const_cast<flat_hash_table *>(this)->find<K>(key);
+            }
+
+            template <typename K = key_type>
+            [[nodiscard]] auto contains(key_arg<K> const &key) const -> bool
+            {
+                return find_index(key, _hash(key)) != npos;
+            }
+
+            template <typename K = key_type>
+            [[nodiscard]] auto count(key_arg<K> const &key) const -> size_type
+            {
+                return contains<K>(key) ? 1 : 0;
+            }
+
+            auto insert(value_type const &v) -> std::pair<iterator, bool>
+            {
+                auto [i, inserted] =
+                    find_or_insert(Policy::key(v), [&](slot_type *s) {
+                        Policy::construct(s, v);
+                    });
+                return {make_iterator(i), inserted};
+            }
+
+            auto insert(value_type &&v) -> std::pair<iterator, bool>
+            {
+                auto [i, inserted] =
+                    find_or_insert(Policy::key(v), [&](slot_type *s) {
+                        Policy::construct(s, std::move(v));
+                    });
+                return {make_iterator(i), inserted};
+            }
+
+            template <std::input_iterator InputIt>
+            auto insert(InputIt first, InputIt last) -> void
+            {
+                if constexpr (std::forward_iterator<InputIt>)
+                    reserve(_size +
+                            static_cast<size_type>(std::distance(first, last)));
+
+                for (; first != last; ++first)
+                    insert(*first);
+            }
+
+            auto insert(std::initializer_list<value_type> items) -> void
+            {
+                insert(items.begin(), items.end());
+            }
+
+            template <typename... Args>
+            auto emplace(Args &&...args) -> std::pair<iterator, bool>
+            {
+                return insert(value_type(std::forward<Args>(args)...));
+            }
+
+            auto erase(const_iterator pos) noexcept -> iterator
+            {
+                auto i = static_cast<size_type>(pos._ctrl - _ctrl);
+                erase_index(i);
+
+                auto it = make_iterator(i);
+                ++it;
+                return it;
+            }
+
+            auto erase(iterator pos) noexcept -> iterator
+            {
+                return erase(const_iterator(pos));
+            }
+
+            template <typename K = key_type>
+            auto erase(key_arg<K> const &key) -> size_type
+            {
+                auto i = find_index(key, _hash(key));
+                if (i == npos)
+                    return 0;
+
+                erase_index(i);
+                return 1;
+            }
+        };
+
+        template <typename Key, typename T>
+        union flat_map_slot {
+            // Elements are constructed as value (with a const key) but moved
+            // through mutable_value when the table is resized, so that keys
+            // are moved rather than copied; the two pairs have the same
+            // layout.  libc++ and abseil do the same.
+            std::pair<Key const, T> value;
+            std::pair<Key, T> mutable_value;
+
+            flat_map_slot() noexcept {}
+            ~flat_map_slot() {}
+        };
+
+        template <typename Key, typename T>
+        struct flat_map_policy {
+            using key_type = Key;
+            using value_type = std::pair<Key const, T>;
+            using slot_type = flat_map_slot<Key, T>;
+
+            static constexpr bool constant_iterators = false;
+
+            static auto key(slot_type const &s) noexcept -> Key const &
+            {
+                return s.value.first;
+            }
+
+            static auto key(value_type const &v) noexcept -> Key const &
+            {
+                return v.first;
+            }
+
+            static auto element(slot_type *s) noexcept -> value_type &
+            {
+                return s->value;
+            }
+
+            template <typename... Args>
+            static auto construct(slot_type *s, Args &&...args) -> void
+            {
+                std::construct_at(&s->value, std::forward<Args>(args)...);
+            }
+
+            static auto destroy(slot_type *s) noexcept -> void
+            {
+                std::destroy_at(&s->value);
+            }
+
+            static auto transfer(slot_type *to, slot_type *from) noexcept
+                -> void
+            {
+                std::construct_at(&to->mutable_value,
+                                  std::move(from->mutable_value));
+                std::destroy_at(&from->mutable_value);
+            }
+        };
+
+        template <typename Key>
+        struct flat_set_policy {
+            using key_type = Key;
+            using value_type = Key;
+            using slot_type = Key;
+
+            static constexpr bool constant_iterators = true;
+
+            static auto key(Key const &k) noexcept -> Key const &
+            {
+                return k;
+            }
+
+            static auto element(slot_type *s) noexcept -> value_type &
+            {
+                return *s;
+            }
+
+            template <typename... Args>
+            static auto construct(slot_type *s, Args &&...args) -> void
+            {
+                std::construct_at(s, std::forward<Args>(args)...);
+            }
+
+            static auto destroy(slot_type *s) noexcept -> void
+            {
+                std::destroy_at(s);
+            }
+
+            static auto transfer(slot_type *to, slot_type *from) noexcept
+                -> void
+            {
+                std::construct_at(to, std::move(*from));
+                std::destroy_at(from);
+            }
+        };
+
+    } // namespace detail
+
+    /*************************************************************************
+     *
+     * flat_hash_map: an unordered map from Key to T.
+     */
+
+    template <typename Key,
+              typename T,
+              typename Hash = hash<Key>,
+              typename KeyEqual = std::equal_to<>,
+              typename Allocator = std::allocator<std::pair<Key const, T>>>
+    class flat_hash_map
+        : public detail::flat_hash_table<detail::flat_map_policy<Key, T>,
+                                         Hash,
+                                         KeyEqual,
+                                         Allocator> {
+        using base = detail::flat_hash_table<detail::flat_map_policy<Key, T>,
+                                             Hash,
+                                             KeyEqual,
+                                             Allocator>;
+
+        template <typename K>
+        using key_arg = typename base::template key_arg<K>;
+
+    public:
+        using mapped_type = T;
+        using typename base::iterator;
+        using typename base::key_type;
+        using typename base::size_type;
+        using typename base::value_type;
+
+        using base::base;
+        using base::insert;
+
+        flat_hash_map() = default;
+
+        flat_hash_map(std::initializer_list<value_type> items)
+        {
+            this->insert(items);
+        }
+
+        // Insert an element with the given key constructed from 'args',
+        // unless there is already an element with the key.  Nothing is
+        // constructed if the key exists.
+        template <typename K = key_type, typename... Args>
+        auto try_emplace(key_arg<K> const &key, Args &&...args)
+            -> std::pair<iterator, bool>
+        {
+            auto [i, inserted] = this->find_or_insert(
+                key, [&](typename base::slot_type *s) {
+                    detail::flat_map_policy<Key, T>::construct(
+                        s,
+                        std::piecewise_construct,
+                        std::forward_as_tuple(key_type(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+                });
+            return {this->make_iterator(i), inserted};
+        }
+
+        template <typename... Args>
+        auto try_emplace(key_type &&key, Args &&...args)
+            -> std::pair<iterator, bool>
+        {
+            auto [i, inserted] = this->find_or_insert(
+                key, [&](typename base::slot_type *s) {
+                    detail::flat_map_policy<Key, T>::construct(
+                        s,
+                        std::piecewise_construct,
+                        std::forward_as_tuple(std::move(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+                });
+            return {this->make_iterator(i), inserted};
+        }
+
+        template <typename M>
+        auto insert_or_assign(key_type const &key, M &&obj)
+            -> std::pair<iterator, bool>
+        {
+            auto ret = try_emplace(key, std::forward<M>(obj));
+            if (!ret.second)
+                ret.first->second = std::forward<M>(obj);
+            return ret;
+        }
+
+        template <typename K = key_type>
+        auto operator[](key_arg<K> const &key) -> T &
+        {
+            return try_emplace<K>(key).first->second;
+        }
+
+        auto operator[](key_type &&key) -> T &
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        template <typename K = key_type>
+        [[nodiscard]] auto at(key_arg<K> const &key) -> T &
+        {
+            auto it = this->template find<K>(key);
+            if (it == this->end())
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return it->second;
+        }
+
+        template <typename K = key_type>
+        [[nodiscard]] auto at(key_arg<K> const &key) const -> T const &
+        {
+            auto it = this->template find<K>(key);
+            if (it == this->end())
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return it->second;
+        }
+    };
+
+    /*************************************************************************
+     *
+     * flat_hash_set: an unordered set of Key.
+     */
+
+    template <typename Key,
+              typename Hash = hash<Key>,
+              typename KeyEqual = std::equal_to<>,
+              typename Allocator = std::allocator<Key>>
+    class flat_hash_set
+        : public detail::flat_hash_table<detail::flat_set_policy<Key>,
+                                         Hash,
+                                         KeyEqual,
+                                         Allocator> {
+        using base = detail::flat_hash_table<detail::flat_set_policy<Key>,
+                                             Hash,
+                                             KeyEqual,
+                                             Allocator>;
+
+    public:
+        using typename base::value_type;
+
+        using base::base;
+
+        flat_hash_set() = default;
+
+        flat_hash_set(std::initializer_list<value_type> items)
+        {
+            this->insert(items);
+        }
+    };
+
+} // namespace ivy
+
+#endif // IVY_FLAT_HASH_MAP_HXX_INCLUDED
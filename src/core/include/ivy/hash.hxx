@@ -6,8 +6,15 @@
 #ifndef IVY_HASH_HXX_INCLUDED
 #define IVY_HASH_HXX_INCLUDED
 
-#include <span>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
 
 #include <ivy/siphash.hxx>
 #include <ivy/static_vector.hxx>
@@ -20,11 +27,17 @@ namespace ivy {
 
         auto get_sip_hash_key() -> static_vector<std::byte, 16> const &;
 
+        // The process-wide key in its precomputed form.
+        inline auto get_siphash_key() -> siphash_key const &
+        {
+            static siphash_key const key(get_sip_hash_key());
+            return key;
+        }
+
         inline auto hash_bytes(std::span<std::byte const> bytes) -> std::size_t
         {
-            std::byte hash[8];
-            siphash<>(bytes, get_sip_hash_key(), hash);
-            return static_cast<std::size_t>(detail::sip_u8u64le(hash));
+            return static_cast<std::size_t>(
+                siphash64<>(bytes, get_siphash_key()));
         }
 
         template <typename T>
@@ -32,95 +45,170 @@ namespace ivy {
         {
             return hash_bytes(as_bytes(std::span(&v, 1)));
         }
-    }
-
-    template <typename T>
-    struct hash;
 
-    template <>
-    struct hash<char> {
-        auto operator()(char v) const noexcept -> std::size_t {
-            return detail::hash_object(v);
-        }
-    };
+        /*
+         * The primitives of fast_hash_policy, after wyhash: the 128-bit
+         * product of two words, folded to 64 bits.
+         */
 
-    template <>
-    struct hash<unsigned char> {
-        auto operator()(unsigned char v) const noexcept -> std::size_t
+        inline auto fast_hash_mix(std::uint64_t a, std::uint64_t b) noexcept
+            -> std::uint64_t
         {
-            return detail::hash_object(v);
+#if defined(__SIZEOF_INT128__)
+            auto r = static_cast<unsigned __int128>(a) * b;
+            return static_cast<std::uint64_t>(r) ^
+                   static_cast<std::uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            std::uint64_t hi;
+            auto lo = _umul128(a, b, &hi);
+            return lo ^ hi;
+#else
+            auto ha = a >> 32, hb = b >> 32;
+            auto la = a & 0xFFFFFFFFu, lb = b & 0xFFFFFFFFu;
+            auto rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            auto t = rl + (rm0 << 32);
+            auto c = static_cast<std::uint64_t>(t < rl);
+            auto lo = t + (rm1 << 32);
+            c += static_cast<std::uint64_t>(lo < t);
+            auto hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+            return lo ^ hi;
+#endif
         }
-    };
 
-    template <>
-    struct hash<signed char> {
-        auto operator()(signed char v) const noexcept -> std::size_t
-        {
-            return detail::hash_object(v);
-        }
-    };
+        inline constexpr std::uint64_t fast_hash_secret[4] = {
+            0xa0761d6478bd642full,
+            0xe7037ed1a0b428dbull,
+            0x8ebc6af09c88c6e3ull,
+            0x589965cc75374cc3ull,
+        };
 
-    template <>
-    struct hash<signed short> {
-        auto operator()(signed short v) const noexcept -> std::size_t
+        inline auto fast_hash_read8(std::byte const *p) noexcept
+            -> std::uint64_t
         {
-            return detail::hash_object(v);
+            return sip_u8u64le(p);
         }
-    };
 
-    template <>
-    struct hash<unsigned short> {
-        auto operator()(unsigned short v) const noexcept -> std::size_t
+        inline auto fast_hash_read4(std::byte const *p) noexcept
+            -> std::uint64_t
         {
-            return detail::hash_object(v);
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
         }
-    };
 
-    template <>
-    struct hash<signed int> {
-        auto operator()(signed int v) const noexcept -> std::size_t
+        inline auto fast_hash_bytes(std::span<std::byte const> bytes) noexcept
+            -> std::uint64_t
         {
-            return detail::hash_object(v);
+            auto const *p = bytes.data();
+            auto len = bytes.size();
+            auto const *s = fast_hash_secret;
+
+            std::uint64_t seed = s[0];
+            std::uint64_t a, b;
+
+            if (len <= 16) {
+                if (len >= 4) {
+                    auto last = len - 4;
+                    auto mid = (len >> 3) << 2;
+                    a = (fast_hash_read4(p) << 32) | fast_hash_read4(p + mid);
+                    b = (fast_hash_read4(p + last) << 32) |
+                        fast_hash_read4(p + last - mid);
+                } else if (len > 0) {
+                    a = (static_cast<std::uint64_t>(p[0]) << 16) |
+                        (static_cast<std::uint64_t>(p[len >> 1]) << 8) |
+                        static_cast<std::uint64_t>(p[len - 1]);
+                    b = 0;
+                } else
+                    a = b = 0;
+            } else {
+                auto i = len;
+
+                if (i > 48) {
+                    auto see1 = seed, see2 = seed;
+
+                    do {
+                        seed = fast_hash_mix(fast_hash_read8(p) ^ s[1],
+                                             fast_hash_read8(p + 8) ^ seed);
+                        see1 = fast_hash_mix(fast_hash_read8(p + 16) ^ s[2],
+                                             fast_hash_read8(p + 24) ^ see1);
+                        see2 = fast_hash_mix(fast_hash_read8(p + 32) ^ s[3],
+                                             fast_hash_read8(p + 40) ^ see2);
+                        p += 48;
+                        i -= 48;
+                    } while (i > 48);
+
+                    seed ^= see1 ^ see2;
+                }
+
+                while (i > 16) {
+                    seed = fast_hash_mix(fast_hash_read8(p) ^ s[1],
+                                         fast_hash_read8(p + 8) ^ seed);
+                    i -= 16;
+                    p += 16;
+                }
+
+                a = fast_hash_read8(p + i - 16);
+                b = fast_hash_read8(p + i - 8);
+            }
+
+            return fast_hash_mix(s[1] ^ len,
+                                 fast_hash_mix(a ^ s[1], b ^ seed));
         }
-    };
 
-    template <>
-    struct hash<unsigned int> {
-        auto operator()(unsigned int v) const noexcept -> std::size_t
+    } // namespace detail
+
+    /*
+     * Hash policies: how ivy::hash turns a value into a hash.  A policy
+     * provides hash_bytes() and hash_integer().
+     *
+     * sip_hash_policy, the default, uses SipHash-2-4 with a random
+     * per-process key.  Use it whenever the keys might come from outside,
+     * e.g. HTTP headers, so that nobody can pick keys which collide.
+     *
+     * fast_hash_policy uses a wyhash-style multiply-mix hash for bytes and a
+     * single multiply-mix for integers.  It is several times faster than
+     * SipHash for short keys, but it is not keyed, so only use it for keys
+     * the program controls, such as option names.
+     */
+
+    struct sip_hash_policy {
+        static auto hash_bytes(std::span<std::byte const> bytes)
+            -> std::size_t
         {
-            return detail::hash_object(v);
+            return detail::hash_bytes(bytes);
         }
-    };
 
-    template <>
-    struct hash<signed long> {
-        auto operator()(signed long v) const noexcept -> std::size_t
+        static auto hash_integer(std::uint64_t v) -> std::size_t
         {
             return detail::hash_object(v);
         }
     };
 
-    template <>
-    struct hash<unsigned long> {
-        auto operator()(unsigned long v) const noexcept -> std::size_t
+    struct fast_hash_policy {
+        static auto hash_bytes(std::span<std::byte const> bytes) noexcept
+            -> std::size_t
         {
-            return detail::hash_object(v);
+            return static_cast<std::size_t>(detail::fast_hash_bytes(bytes));
         }
-    };
 
-    template <>
-    struct hash<signed long long> {
-        auto operator()(signed long long v) const noexcept -> std::size_t
+        static auto hash_integer(std::uint64_t v) noexcept -> std::size_t
         {
-            return detail::hash_object(v);
+            return static_cast<std::size_t>(
+                detail::fast_hash_mix(v ^ detail::fast_hash_secret[0],
+                                      detail::fast_hash_secret[1]));
         }
     };
 
-    template <>
-    struct hash<unsigned long long> {
-        auto operator()(unsigned long long v) const noexcept -> std::size_t
+    template <typename T, typename policy = sip_hash_policy>
+    struct hash;
+
+    template <std::integral T, typename policy>
+    struct hash<T, policy> {
+        auto operator()(T v) const noexcept -> std::size_t
         {
-            return detail::hash_object(v);
+            // Hash every integer as 64 bits, so equal values of different
+            // types hash the same.
+            return policy::hash_integer(static_cast<std::uint64_t>(v));
         }
     };
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_IO_HASHCHANNEL_HXX_INCLUDED
+#define IVY_IO_HASHCHANNEL_HXX_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/io/channel.hxx>
+#include <ivy/siphash.hxx>
+
+namespace ivy {
+
+    /*************************************************************************
+     *
+     * hashchannel: a channel layer which computes the SipHash of the data
+     * passing through it.  Data read from and written to the channel are
+     * hashed in the order they pass through; a hashchannel is normally used
+     * in one direction only.
+     */
+
+    template <channel base_channel, layer_ownership ownership>
+    class hashchannel final : layer_base<base_channel, ownership> {
+        siphash_state<> _state;
+
+    public:
+        using value_type = channel_value_t<base_channel>;
+
+        hashchannel(hashchannel &&) noexcept = default;
+        auto operator=(hashchannel &&) noexcept -> hashchannel & = default;
+
+        hashchannel(hashchannel const &) = delete;
+        auto operator=(hashchannel const &) -> hashchannel & = delete;
+
+        hashchannel(base_channel &c, siphash_key const &key = {}) requires(
+            ownership == layer_ownership::borrow_layer)
+            : layer_base<base_channel, ownership>(c)
+            , _state(key)
+        {
+        }
+
+        hashchannel(base_channel &&c, siphash_key const &key = {}) requires(
+            ownership == layer_ownership::own_layer)
+            : layer_base<base_channel, ownership>(std::move(c))
+            , _state(key)
+        {
+        }
+
+        auto read(std::span<value_type> buf) noexcept
+            -> expected<io_size_t, error>
+            requires sequential_input_channel<base_channel>
+        {
+            auto nread = this->get_base_layer().read(buf);
+            if (nread)
+                _state.update(std::as_bytes(buf.first(*nread)));
+            return nread;
+        }
+
+        auto write(std::span<value_type const> buf) noexcept
+            -> expected<io_size_t, error>
+            requires sequential_output_channel<base_channel>
+        {
+            auto nwritten = this->get_base_layer().write(buf);
+            if (nwritten)
+                _state.update(std::as_bytes(buf.first(*nwritten)));
+            return nwritten;
+        }
+
+        // The hash of the data which has passed through the channel so far.
+        [[nodiscard]] auto hash() const noexcept -> std::uint64_t
+        {
+            return _state.finish();
+        }
+
+        // The number of bytes which have passed through the channel.
+        [[nodiscard]] auto bytes_hashed() const noexcept -> std::uint64_t
+        {
+            return _state.size();
+        }
+    };
+
+    template <channel base_channel>
+    auto make_hashchannel(base_channel &b, siphash_key const &key = {})
+    {
+        return hashchannel<base_channel, layer_ownership::borrow_layer>(b,
+                                                                        key);
+    }
+
+    template <channel base_channel>
+    auto make_hashchannel(base_channel &&b, siphash_key const &key = {})
+    {
+        return hashchannel<base_channel, layer_ownership::own_layer>(
+            std::move(b), key);
+    }
+
+    /*************************************************************************
+     *
+     * siphash_channel(): read a channel until end of file and return the
+     * hash of its contents.
+     */
+
+    template <sequential_input_channel channel_type>
+    [[nodiscard]] auto siphash_channel(channel_type &chan,
+                                       siphash_key const &key = {})
+        -> expected<std::uint64_t, error>
+    {
+        siphash_state<> state(key);
+        std::array<channel_value_t<channel_type>, 4096> buf;
+
+        for (;;) {
+            auto nread = chan.read(buf);
+
+            if (!nread) {
+                if (nread.error() == errc::end_of_file)
+                    return state.finish();
+                return make_unexpected(nread.error());
+            }
+
+            if (*nread == 0)
+                return state.finish();
+
+            state.update(std::as_bytes(std::span(buf).first(*nread)));
+        }
+    }
+
+} // namespace ivy
+
+#endif // IVY_IO_HASHCHANNEL_HXX_INCLUDED
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_IO_MAPPED_FILE_HXX_INCLUDED
+#define IVY_IO_MAPPED_FILE_HXX_INCLUDED
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/noncopyable.hxx>
+
+namespace ivy {
+
+    /*
+     * mapped_file: a file mapped into memory.  A mapped_file is either
+     * writable, when it was created by create_mapped_file(), or read-only,
+     * when it was opened by open_mapped_file().
+     */
+    class mapped_file : noncopyable {
+#ifdef _WIN32
+        void *_file = nullptr;
+        void *_mapping = nullptr;
+#else
+        int _fd = -1;
+#endif
+        std::byte *_data = nullptr;
+        std::size_t _size = 0;
+
+        friend auto create_mapped_file(std::filesystem::path const &,
+                                       std::size_t)
+            -> expected<mapped_file, error>;
+
+        friend auto open_mapped_file(std::filesystem::path const &)
+            -> expected<mapped_file, error>;
+
+        auto unmap() noexcept -> void;
+
+    public:
+        mapped_file() noexcept = default;
+        mapped_file(mapped_file &&) noexcept;
+        auto operator=(mapped_file &&) noexcept -> mapped_file &;
+        ~mapped_file();
+
+        [[nodiscard]] auto is_open() const noexcept -> bool
+        {
+            return _data != nullptr;
+        }
+
+        [[nodiscard]] auto data() noexcept -> std::span<std::byte>
+        {
+            return {_data, _size};
+        }
+
+        [[nodiscard]] auto data() const noexcept -> std::span<std::byte const>
+        {
+            return {_data, _size};
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            return _size;
+        }
+
+        // Unmap and close the file, truncating it to 'size' bytes.  The
+        // file is closed even if truncation fails.
+        auto close(std::size_t size) -> expected<void, error>;
+
+        // Unmap and close the file without changing its size.
+        auto close() noexcept -> void;
+    };
+
+    // Create a new file of the given size and map it for writing.  Fails if
+    // the file already exists.
+    auto create_mapped_file(std::filesystem::path const &path,
+                            std::size_t size) -> expected<mapped_file, error>;
+
+    // Map an existing file for reading.
+    auto open_mapped_file(std::filesystem::path const &path)
+        -> expected<mapped_file, error>;
+
+} // namespace ivy
+
+#endif // IVY_IO_MAPPED_FILE_HXX_INCLUDED
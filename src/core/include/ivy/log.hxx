@@ -6,12 +6,30 @@
 #ifndef IVY_LOG_HXX_INCLUDED
 #define IVY_LOG_HXX_INCLUDED
 
+#include <atomic>
+#include <array>
 #include <chrono>
 #include <cstdint>
+#include <format>
+#include <memory>
 #include <shared_mutex>
+#include <span>
 #include <string_view>
+#include <tuple>
 #include <vector>
 
+#include <ivy/log/capture.hxx>
+#include <ivy/log/field.hxx>
+
+/*
+ * Calls to log_trace(), log_info() etc. with a severity below
+ * IVY_LOG_MIN_SEVERITY are removed at compile time.  The value is the numeric
+ * value of the severity_code, e.g. 3 to keep notice and above.
+ */
+#ifndef IVY_LOG_MIN_SEVERITY
+#    define IVY_LOG_MIN_SEVERITY 0
+#endif
+
 namespace ivy {
 
     namespace log {
@@ -29,79 +47,259 @@ namespace ivy {
 
         auto str(severity_code sev) -> std::string_view;
 
+        inline constexpr severity_code compiled_min_severity =
+            static_cast<severity_code>(IVY_LOG_MIN_SEVERITY);
+
+        class logger;
+
+        // A single log message as seen by a sink.  The message and fields
+        // are only valid for the duration of the call to the sink.
+        struct record {
+            std::chrono::system_clock::time_point timestamp;
+            severity_code severity;
+            std::string_view message;
+            std::span<field const> fields = {};
+        };
+
         class sink {
+            friend class logger;
+
+            std::atomic<severity_code> _min_severity{severity_code::none};
+            logger *_logger = nullptr;
+
         public:
             virtual ~sink();
 
+            // Records below this severity are not passed to the sink.  This
+            // may be called from log_message() or log_records(), in which
+            // case the logger's threshold is updated after the current
+            // batch of records.
+            auto set_min_severity(severity_code severity) -> void;
+
+            [[nodiscard]] auto min_severity() const noexcept -> severity_code
+            {
+                return _min_severity.load(std::memory_order_relaxed);
+            }
+
             virtual auto
             log_message(std::chrono::system_clock::time_point timestamp,
                         severity_code severity,
                         std::string_view message) -> void = 0;
+
+            // Log a batch of records.  The default implementation calls
+            // log_message() for each record, which loses the fields; sinks
+            // which support fields, or can write a batch more efficiently
+            // than one message at a time, should override this.
+            virtual auto log_records(std::span<record const> records)
+                -> void;
         };
 
+        // What an asynchronous logger does when its queue is full.
+        enum struct overflow_policy {
+            // Wait until the logging thread has made space.
+            block,
+
+            // Discard the new record.
+            drop,
+
+            // Discard the oldest record in the queue to make space.
+            drop_oldest,
+        };
+
+        struct async_options {
+            // Maximum number of records waiting to be written.
+            std::size_t queue_size = 8192;
+
+            overflow_policy overflow = overflow_policy::block;
+
+            // Maximum number of records passed to the sinks at once.
+            std::size_t max_batch = 512;
+
+            // How long the logging thread sleeps when there is nothing to do.
+            std::chrono::milliseconds flush_interval{100};
+        };
+
+        namespace detail {
+
+            class async_dispatcher;
+
+        } // namespace detail
+
         class logger final {
             std::shared_mutex _mutex;
             std::vector<std::unique_ptr<sink>> _loggers;
+            std::unique_ptr<detail::async_dispatcher> _async;
+            std::atomic<severity_code> _min_severity{severity_code::none};
+
+            // The lowest severity which the logger and at least one sink
+            // will accept.  Messages below this are discarded before they
+            // are formatted.
+            std::atomic<severity_code> _threshold{severity_code::none};
+
+            // Set when a sink's minimum severity changes while records are
+            // being dispatched, which holds _mutex; the threshold is then
+            // updated once dispatch() has released it.
+            std::atomic<bool> _threshold_stale{false};
+
+            friend class sink;
+            friend class detail::async_dispatcher;
+
+            auto dispatch(std::span<record const> records) -> void;
+            auto dispatch_locked(std::span<record const> records) -> void;
+            auto update_threshold() -> void;
+            auto update_threshold_locked() -> void;
 
         public:
             logger();
+            ~logger();
 
-            auto log_message(severity_code severity, std::string_view message)
-                -> void;
+            logger(logger const &) = delete;
+            auto operator=(logger const &) -> logger & = delete;
+
+            auto log_message(severity_code severity,
+                             std::string_view message,
+                             std::span<field const> fields = {}) -> void;
+
+            // Log a message whose arguments have already been captured.  In
+            // asynchronous mode the encoded arguments are copied into the
+            // queue and the message is formatted by the logging thread.
+            auto log_captured(severity_code severity,
+                              detail::captured_message const &message) -> void;
+
+            // Log a formatted message.  Arguments created with kv() are
+            // attached to the record as fields instead of being formatted.
+            template <typename... Args>
+            auto log(severity_code severity,
+                     detail::log_format_string<Args...> format,
+                     Args &&...args) -> void;
 
             auto add_sink(std::unique_ptr<sink> &&) -> void;
+
+            // Messages below this severity are discarded.
+            auto set_min_severity(severity_code severity) -> void;
+
+            [[nodiscard]] auto min_severity() const noexcept -> severity_code
+            {
+                return _min_severity.load(std::memory_order_relaxed);
+            }
+
+            // Returns true if a message of this severity would be passed to
+            // at least one sink.
+            [[nodiscard]] auto is_enabled(severity_code severity) const noexcept
+                -> bool
+            {
+                return severity >= _threshold.load(std::memory_order_relaxed);
+            }
+
+            // Switch to asynchronous mode: log_message() queues the record
+            // and returns immediately, and a background thread passes the
+            // queued records to the sinks in batches.
+            //
+            // The mode is not synchronised with logging, so this and
+            // stop_async() must only be called while no other thread is
+            // using the logger: before any thread starts logging, or after
+            // they have all stopped.
+            auto start_async(async_options const &options = {}) -> void;
+
+            // Write any queued records and return to synchronous mode.
+            auto stop_async() -> void;
+
+            // Wait until all records logged before this call have been
+            // passed to the sinks.  Does nothing in synchronous mode.
+            auto flush() -> void;
+
+            // Number of records discarded because the queue was full.
+            [[nodiscard]] auto dropped_records() const noexcept
+                -> std::uint64_t;
         };
 
+        template <typename... Args>
+        auto logger::log(severity_code severity,
+                         detail::log_format_string<Args...> format,
+                         Args &&...args) -> void
+        {
+            if (!is_enabled(severity))
+                return;
+
+            auto prepared =
+                std::tuple_cat(detail::prepare_positional(args)...);
+
+            std::array<field, detail::field_count<Args...>> fields;
+            [[maybe_unused]] auto *next_field = fields.data();
+            (detail::add_field(next_field, args), ...);
+
+            log_captured(
+                severity,
+                detail::capture_message(format.get(), prepared, fields));
+        }
+
         auto get_global_logger() -> logger *;
 
     } // namespace log
 
     namespace detail {
 
-        template <typename... Args>
-        auto log_any(log::severity_code sev, Args&&...args)
+        template <log::severity_code Severity, typename... Args>
+        auto
+        log_any([[maybe_unused]] log::detail::log_format_string<Args...> format,
+                [[maybe_unused]] Args &&...args)
         {
-            auto logger = ::ivy::log::get_global_logger();
-            auto msg = std::format(std::forward<Args>(args)...);
-            logger->log_message(sev, msg);
+            if constexpr (Severity >= log::compiled_min_severity) {
+                auto logger = ::ivy::log::get_global_logger();
+                logger->log(Severity, format, std::forward<Args>(args)...);
+            }
         }
 
     } // namespace detail
 
-    template<typename... Args>
-    auto log_trace(Args &&...args)
+    using log::kv;
+
+    template <typename... Args>
+    auto log_trace(log::detail::log_format_string<Args...> format,
+                   Args &&...args)
     {
-        detail::log_any(log::severity_code::trace, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::trace>(
+            format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    auto log_info(Args &&...args)
+    auto log_info(log::detail::log_format_string<Args...> format,
+                  Args &&...args)
     {
-        detail::log_any(log::severity_code::info, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::info>(
+            format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    auto log_notice(Args &&...args)
+    auto log_notice(log::detail::log_format_string<Args...> format,
+                    Args &&...args)
     {
-        detail::log_any(log::severity_code::notice, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::notice>(
+            format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    auto log_warning(Args &&...args)
+    auto log_warning(log::detail::log_format_string<Args...> format,
+                     Args &&...args)
     {
-        detail::log_any(log::severity_code::warning, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::warning>(
+            format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    auto log_error(Args &&...args)
+    auto log_error(log::detail::log_format_string<Args...> format,
+                   Args &&...args)
     {
-        detail::log_any(log::severity_code::error, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::error>(
+            format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    auto log_fatal(Args &&...args)
+    auto log_fatal(log::detail::log_format_string<Args...> format,
+                   Args &&...args)
     {
-        detail::log_any(log::severity_code::fatal, std::forward<Args>(args)...);
+        detail::log_any<log::severity_code::fatal>(
+            format, std::forward<Args>(args)...);
     }
 
 } // namespace ivy
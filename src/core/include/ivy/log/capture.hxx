@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_CAPTURE_HXX_INCLUDED
+#define IVY_LOG_CAPTURE_HXX_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <ivy/log/field.hxx>
+
+/*
+ * Argument capture for deferred formatting.
+ *
+ * A log call's arguments are encoded into a flat byte buffer so the record
+ * can be queued with a memcpy and formatted later, on another thread, or not
+ * at all.  Arguments are stored as follows:
+ *
+ * - Trivially copyable values (integers, floating point, bool, durations,
+ *   time points, void pointers) are copied as-is.
+ *
+ * - Narrow strings (char const *, std::string, std::string_view) are copied
+ *   as a length followed by the characters, and are formatted as a
+ *   std::string_view.
+ *
+ * - Anything else is formatted with "{}" when the call is made, and the
+ *   resulting text is captured as a string.  Format specifications for these
+ *   arguments are applied to the text rather than to the original value.
+ *
+ * Arguments created by kv() are not format arguments; they become the
+ * record's fields, which are encoded after the format arguments.
+ */
+
+namespace ivy::log::detail {
+
+    // Appends the formatted message to 'out'.
+    using format_function = auto (*)(std::string &out,
+                                     std::string_view format_string,
+                                     std::byte const *arguments) -> void;
+
+    // Writes the encoded arguments to 'out'.
+    using encode_function = auto (*)(std::byte *out, void const *arguments)
+        -> void;
+
+    // A message whose arguments have been captured but not formatted.
+    struct captured_message {
+        format_function format;
+        std::string_view format_string;
+        encode_function encode;
+        void const *arguments;
+        std::size_t size;
+        std::span<field const> fields;
+    };
+
+    template <typename T>
+    concept field_argument = std::same_as<std::remove_cvref_t<T>, field>;
+
+    // The format string type for a log call, which only counts the
+    // arguments which are not fields.
+    template <typename Positional, typename... Args>
+    struct positional_format_string;
+
+    template <typename... Positional>
+    struct positional_format_string<std::tuple<Positional...>> {
+        using type = std::format_string<Positional...>;
+    };
+
+    template <typename... Positional, typename Arg, typename... Args>
+    struct positional_format_string<std::tuple<Positional...>, Arg, Args...>
+        : std::conditional_t<
+              field_argument<Arg>,
+              positional_format_string<std::tuple<Positional...>, Args...>,
+              positional_format_string<std::tuple<Positional..., Arg>,
+                                       Args...>> {
+    };
+
+    template <typename... Args>
+    using log_format_string =
+        typename positional_format_string<std::tuple<>, Args...>::type;
+
+    template <typename... Args>
+    inline constexpr std::size_t field_count =
+        (std::size_t(0) + ... + (field_argument<Args> ? 1 : 0));
+
+    template <typename T>
+    concept captured_as_string =
+        std::same_as<T, char const *> || std::same_as<T, char *> ||
+        std::same_as<T, std::string> || std::same_as<T, std::string_view> ||
+        (std::is_array_v<T> && std::same_as<std::remove_extent_t<T>, char>);
+
+    template <typename T>
+    concept captured_as_bytes =
+        !captured_as_string<T> && !std::is_array_v<T> &&
+        std::is_trivially_copyable_v<T> &&
+        (!std::is_pointer_v<T> || std::same_as<T, void const *> ||
+         std::same_as<T, void *>);
+
+    // The type an argument is stored as.
+    template <typename T>
+    struct capture_type {
+        using type = std::string_view;
+    };
+
+    template <captured_as_bytes T>
+    struct capture_type<T> {
+        using type = T;
+    };
+
+    template <typename T>
+    using capture_type_t = typename capture_type<std::remove_cvref_t<T>>::type;
+
+    // Convert an argument to something we know how to encode.  This is where
+    // arguments which are neither trivial nor strings are formatted.
+    template <typename T>
+    auto prepare_argument(T const &v) -> decltype(auto)
+    {
+        using type = std::remove_cvref_t<T>;
+
+        if constexpr (captured_as_bytes<type>)
+            return (v);
+        else if constexpr (captured_as_string<type>)
+            return std::string_view(v);
+        else
+            return std::format("{}", v);
+    }
+
+    // Prepare an argument which is not a field, returning a tuple which is
+    // either empty or holds the prepared argument.
+    template <typename T>
+    auto prepare_positional(T const &v)
+    {
+        if constexpr (field_argument<T>)
+            return std::tuple<>();
+        else
+            return std::tuple<decltype(prepare_argument(v))>(
+                prepare_argument(v));
+    }
+
+    template <typename T>
+    auto add_field(field *&out, T const &v) -> void
+    {
+        if constexpr (field_argument<T>)
+            *out++ = v;
+    }
+
+    template <typename T>
+    auto encoded_size(T const &v) noexcept -> std::size_t
+    {
+        if constexpr (captured_as_bytes<T>)
+            return sizeof(T);
+        else
+            return sizeof(std::size_t) + std::string_view(v).size();
+    }
+
+    template <typename T>
+    auto encode_argument(std::byte *&out, T const &v) noexcept -> void
+    {
+        if constexpr (captured_as_bytes<T>) {
+            std::memcpy(out, &v, sizeof(T));
+            out += sizeof(T);
+        } else {
+            std::string_view s(v);
+            auto size = s.size();
+            std::memcpy(out, &size, sizeof(size));
+            out += sizeof(size);
+            std::memcpy(out, s.data(), size);
+            out += size;
+        }
+    }
+
+    template <typename T>
+    auto decode_argument(std::byte const *&in) noexcept -> T
+    {
+        if constexpr (std::same_as<T, std::string_view>) {
+            std::size_t size;
+            std::memcpy(&size, in, sizeof(size));
+            in += sizeof(size);
+            auto data = reinterpret_cast<char const *>(in);
+            in += size;
+            return {data, size};
+        } else {
+            T v;
+            std::memcpy(&v, in, sizeof(T));
+            in += sizeof(T);
+            return v;
+        }
+    }
+
+    template <typename... Prepared>
+    auto encode_arguments(std::byte *out, void const *arguments) -> void
+    {
+        auto const &args =
+            *static_cast<std::tuple<Prepared...> const *>(arguments);
+
+        std::apply(
+            [&](auto const &...v) {
+                (encode_argument(out, v), ...);
+            },
+            args);
+    }
+
+    template <typename... Stored>
+    auto format_arguments(std::string &out,
+                          std::string_view format_string,
+                          [[maybe_unused]] std::byte const *arguments) -> void
+    {
+        // Braced initialisation guarantees left-to-right evaluation.
+        std::tuple<Stored...> values{decode_argument<Stored>(arguments)...};
+
+        std::apply(
+            [&](auto const &...v) {
+                std::vformat_to(std::back_inserter(out),
+                                format_string,
+                                std::make_format_args(v...));
+            },
+            values);
+    }
+
+    // Encoding of fields.  String values are copied.
+    auto encoded_fields_size(std::span<field const> fields) noexcept
+        -> std::size_t;
+    auto encode_fields(std::byte *out, std::span<field const> fields) noexcept
+        -> void;
+    auto decode_fields(std::byte const *in,
+                       std::size_t count,
+                       std::vector<field> &out) -> void;
+
+    // Capture the arguments of a log call.  The returned message refers to
+    // 'prepared' and 'fields', which must outlive it.
+    template <typename... Prepared>
+    auto capture_message(std::string_view format_string,
+                         std::tuple<Prepared...> const &prepared,
+                         std::span<field const> fields = {}) noexcept
+        -> captured_message
+    {
+        std::size_t size = std::apply(
+            [](auto const &...v) -> std::size_t {
+                return (std::size_t(0) + ... + encoded_size(v));
+            },
+            prepared);
+
+        return captured_message{
+            &format_arguments<capture_type_t<Prepared>...>,
+            format_string,
+            &encode_arguments<Prepared...>,
+            &prepared,
+            size,
+            fields};
+    }
+
+} // namespace ivy::log::detail
+
+#endif // IVY_LOG_CAPTURE_HXX_INCLUDED
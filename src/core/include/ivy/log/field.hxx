@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_FIELD_HXX_INCLUDED
+#define IVY_LOG_FIELD_HXX_INCLUDED
+
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace ivy::log {
+
+    /*
+     * A typed value attached to a log record.  The index of each alternative
+     * is used in the binary encodings (the async queue and log segments), so
+     * new types must only be added at the end.
+     */
+    using field_value = std::variant<std::int64_t,
+                                     std::uint64_t,
+                                     double,
+                                     bool,
+                                     std::string_view,
+                                     std::chrono::nanoseconds>;
+
+    // A key/value field.  The strings are only valid for as long as the
+    // record they belong to.
+    struct field {
+        std::string_view key;
+        field_value value;
+    };
+
+    template <typename T>
+    struct is_duration : std::false_type {
+    };
+
+    template <typename Rep, typename Period>
+    struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type {
+    };
+
+    template <typename T>
+    concept field_value_type =
+        std::integral<T> || std::floating_point<T> || is_duration<T>::value ||
+        std::convertible_to<T const &, std::string_view>;
+
+    template <field_value_type T>
+    [[nodiscard]] auto make_field_value(T const &v) -> field_value
+    {
+        if constexpr (std::same_as<T, bool>)
+            return v;
+        else if constexpr (std::signed_integral<T>)
+            return static_cast<std::int64_t>(v);
+        else if constexpr (std::unsigned_integral<T>)
+            return static_cast<std::uint64_t>(v);
+        else if constexpr (std::floating_point<T>)
+            return static_cast<double>(v);
+        else if constexpr (is_duration<T>::value)
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(v);
+        else
+            return std::string_view(v);
+    }
+
+    /*
+     * kv(): attach a field to a log message:
+     *
+     *    log_info("request done", kv("status", 200), kv("elapsed", t));
+     *
+     * The value is stored with its type and is not converted to text unless
+     * a sink needs text.
+     */
+    template <field_value_type T>
+    [[nodiscard]] auto kv(std::string_view key, T const &value) -> field
+    {
+        return field{key, make_field_value(value)};
+    }
+
+    // Append the value as text: numbers as std::format prints them, bool as
+    // true or false, durations in nanoseconds with an "ns" suffix, and
+    // strings unchanged.
+    auto format_field_value(std::string &out, field_value const &value)
+        -> void;
+
+} // namespace ivy::log
+
+#endif // IVY_LOG_FIELD_HXX_INCLUDED
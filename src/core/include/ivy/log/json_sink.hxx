@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_JSON_SINK_HXX_INCLUDED
+#define IVY_LOG_JSON_SINK_HXX_INCLUDED
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+
+#include <ivy/log.hxx>
+
+namespace ivy::log {
+
+    /*
+     * json_sink: write records as JSON lines, with the fields as members of
+     * the object.  Durations are written as integer nanoseconds.
+     */
+    class json_sink final : public sink {
+        std::ostream &_stream;
+        std::mutex _mutex;
+
+        // Reused for each batch, so formatting doesn't allocate once the
+        // buffer has grown.
+        std::string _buffer;
+
+    public:
+        json_sink(std::ostream &strm);
+
+        auto log_message(std::chrono::system_clock::time_point timestamp,
+                         severity_code severity,
+                         std::string_view message) -> void final;
+
+        auto log_records(std::span<record const> records) -> void final;
+    };
+
+    auto make_json_sink(std::ostream &) -> std::unique_ptr<json_sink>;
+
+    namespace detail {
+
+        // Append 's' as a quoted JSON string.
+        auto append_json_string(std::string &out, std::string_view s) -> void;
+
+    } // namespace detail
+
+} // namespace ivy::log
+
+#endif // IVY_LOG_JSON_SINK_HXX_INCLUDED
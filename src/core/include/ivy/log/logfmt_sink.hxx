@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_LOGFMT_SINK_HXX_INCLUDED
+#define IVY_LOG_LOGFMT_SINK_HXX_INCLUDED
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+
+#include <ivy/log.hxx>
+
+namespace ivy::log {
+
+    /*
+     * logfmt_sink: write records in logfmt format (key=value pairs), with the
+     * fields after the message.
+     */
+    class logfmt_sink final : public sink {
+        std::ostream &_stream;
+        std::mutex _mutex;
+
+        // Reused for each batch, so formatting doesn't allocate once the
+        // buffer has grown.
+        std::string _buffer;
+
+    public:
+        logfmt_sink(std::ostream &strm);
+
+        auto log_message(std::chrono::system_clock::time_point timestamp,
+                         severity_code severity,
+                         std::string_view message) -> void final;
+
+        auto log_records(std::span<record const> records) -> void final;
+    };
+
+    auto make_logfmt_sink(std::ostream &) -> std::unique_ptr<logfmt_sink>;
+
+} // namespace ivy::log
+
+#endif // IVY_LOG_LOGFMT_SINK_HXX_INCLUDED
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_MMAP_SEGMENT_SINK_HXX_INCLUDED
+#define IVY_LOG_MMAP_SEGMENT_SINK_HXX_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/io/mapped_file.hxx>
+#include <ivy/log.hxx>
+#include <ivy/log/segment.hxx>
+
+namespace ivy::log {
+
+    struct mmap_segment_options {
+        // Directory the segments are written to.  It must already exist.
+        std::filesystem::path directory;
+
+        // Segments are named <name>.<sequence>.ivylog.
+        std::string name = "ivy";
+
+        // Size each segment is preallocated to.  When a record doesn't fit,
+        // the sink moves on to a new segment.
+        std::size_t segment_size = 64 * 1024 * 1024;
+
+        // Delete the oldest segments when there are more than this many.
+        // Zero means keep all segments.
+        std::size_t max_segments = 0;
+    };
+
+    /*
+     * mmap_segment_sink: write records in binary form (see segment.hxx) to
+     * memory-mapped segment files.  Writing a record is a copy into the
+     * mapping; the operating system writes the pages to disk.
+     */
+    class mmap_segment_sink final : public sink {
+        mmap_segment_options _options;
+        std::mutex _mutex;
+        mapped_file _segment;
+        std::size_t _offset = 0;
+        std::uint64_t _sequence = 0;
+        std::deque<std::filesystem::path> _segments;
+        std::atomic<std::uint64_t> _lost{0};
+
+        auto open_segment() -> expected<void, error>;
+        auto close_segment() -> void;
+        auto write(record const &r) -> void;
+
+    public:
+        explicit mmap_segment_sink(mmap_segment_options options);
+        ~mmap_segment_sink() override;
+
+        // Find the existing segments and open a new one.
+        auto open() -> expected<void, error>;
+
+        auto log_message(std::chrono::system_clock::time_point timestamp,
+                         severity_code severity,
+                         std::string_view message) -> void final;
+
+        auto log_records(std::span<record const> records) -> void final;
+
+        // Number of records which could not be written because a new
+        // segment could not be created.
+        [[nodiscard]] auto lost_records() const noexcept -> std::uint64_t
+        {
+            return _lost.load(std::memory_order_relaxed);
+        }
+
+        // Path of the segment with the given sequence number.
+        [[nodiscard]] auto segment_path(std::uint64_t sequence) const
+            -> std::filesystem::path;
+    };
+
+    auto make_mmap_segment_sink(mmap_segment_options const &options)
+        -> expected<std::unique_ptr<mmap_segment_sink>, error>;
+
+} // namespace ivy::log
+
+#endif // IVY_LOG_MMAP_SEGMENT_SINK_HXX_INCLUDED
@@ -15,12 +15,16 @@ namespace ivy::log {
     class ostream_sink final : public sink {
         std::ostream &_stream;
 
+        auto write(std::string_view text) -> void;
+
     public:
         ostream_sink(std::ostream &strm);
 
         auto log_message(std::chrono::system_clock::time_point timestamp,
                          severity_code severity,
                          std::string_view message) -> void final;
+
+        auto log_records(std::span<record const> records) -> void final;
     };
 
     auto make_ostream_sink(std::ostream &) -> std::unique_ptr<ostream_sink>;
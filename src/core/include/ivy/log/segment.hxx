@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_LOG_SEGMENT_HXX_INCLUDED
+#define IVY_LOG_SEGMENT_HXX_INCLUDED
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/log.hxx>
+
+/*
+ * Binary log segments, as written by mmap_segment_sink.
+ *
+ * A segment is a segment_header followed by records.  Each record is a
+ * segment_record_header, the message, then 'field_count' fields, each of
+ * which is a segment_field_header followed by the key and the value.  Records
+ * are padded to a multiple of 8 bytes.
+ *
+ * A field's type is the index of its type in field_value.  String values are
+ * stored as their characters; other values are stored in their in-memory
+ * representation.
+ *
+ * Segments are preallocated and zero-filled, so a record header with a size
+ * of zero marks the end of the segment.  A closed segment is truncated to the
+ * end of its last record.
+ *
+ * Integers are stored in native byte order, which must be little-endian.
+ */
+
+namespace ivy::log {
+
+    static_assert(std::endian::native == std::endian::little,
+                  "log segments require a little-endian platform");
+
+    inline constexpr std::array<char, 8> segment_magic{
+        'I', 'V', 'Y', 'L', 'O', 'G', '\r', '\n'};
+
+    inline constexpr std::uint32_t segment_version = 1;
+
+    inline constexpr std::size_t segment_alignment = 8;
+
+    struct segment_header {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint64_t sequence;
+    };
+
+    struct segment_record_header {
+        // Size of the record including this header and padding.
+        std::uint32_t size;
+        std::uint8_t severity;
+        std::uint8_t reserved;
+        std::uint16_t field_count;
+
+        // Nanoseconds since the system_clock epoch.
+        std::int64_t timestamp;
+
+        std::uint32_t message_size;
+        std::uint32_t reserved2;
+    };
+
+    struct segment_field_header {
+        std::uint16_t key_size;
+        std::uint8_t type;
+        std::uint8_t reserved;
+        std::uint32_t value_size;
+    };
+
+    [[nodiscard]] constexpr auto segment_padded_size(std::size_t size)
+        -> std::size_t
+    {
+        return (size + segment_alignment - 1) & ~(segment_alignment - 1);
+    }
+
+    class segment_error : public std::runtime_error {
+    public:
+        segment_error(std::string const &message)
+            : std::runtime_error(message)
+        {
+        }
+    };
+
+    // A record read from a segment.  The strings refer to the segment data.
+    struct segment_record {
+        std::chrono::system_clock::time_point timestamp;
+        severity_code severity;
+        std::string_view message;
+        std::vector<field> fields;
+    };
+
+    /*
+     * segment_reader: read the records in a segment.  The segment data must
+     * remain valid while the reader and any records read from it are in use.
+     */
+    class segment_reader {
+        std::span<std::byte const> _data;
+        std::size_t _offset = 0;
+        std::uint64_t _sequence = 0;
+
+    public:
+        explicit segment_reader(std::span<std::byte const> data);
+
+        // Check the segment header.  This must be called before next().
+        auto open() -> expected<void, error>;
+
+        [[nodiscard]] auto sequence() const noexcept -> std::uint64_t
+        {
+            return _sequence;
+        }
+
+        // Read the next record.  Returns errc::end_of_file at the end of the
+        // segment, or segment_error if the segment is corrupt.
+        auto next() -> expected<segment_record, error>;
+    };
+
+} // namespace ivy::log
+
+#endif // IVY_LOG_SEGMENT_HXX_INCLUDED
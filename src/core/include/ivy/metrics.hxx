@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_METRICS_HXX_INCLUDED
+#define IVY_METRICS_HXX_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <ivy/mpmc_queue.hxx>
+#include <ivy/noncopyable.hxx>
+
+/*
+ * Metrics: counters, gauges and histograms, kept in a registry which can
+ * write them in the Prometheus text exposition format.
+ *
+ * Updating a metric never locks.  Counters and histograms are sharded: each
+ * thread updates one of several cache-line-aligned copies, and reading the
+ * metric adds the shards together.  Only creating a metric takes the
+ * registry's lock, so the usual pattern is to look the metric up once:
+ *
+ *    static auto &requests =
+ *        ivy::metrics::get_global_registry()->get_counter(
+ *            "myapp_requests_total", "Requests handled.");
+ *    requests.add();
+ */
+
+namespace ivy::metrics {
+
+    namespace detail {
+
+        inline constexpr std::size_t shard_count = 16;
+
+        // Threads are given shards round-robin as they first update a
+        // metric.
+        auto this_thread_shard() noexcept -> std::size_t;
+
+    } // namespace detail
+
+    /*************************************************************************
+     *
+     * counter: a value which only goes up.
+     */
+
+    class counter : nonmovable {
+        struct alignas(ivy::detail::cache_line_size) shard {
+            std::atomic<std::uint64_t> value{0};
+        };
+
+        std::array<shard, detail::shard_count> _shards;
+
+    public:
+        counter() = default;
+
+        auto add(std::uint64_t n = 1) noexcept -> void
+        {
+            _shards[detail::this_thread_shard()].value.fetch_add(
+                n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] auto value() const noexcept -> std::uint64_t;
+    };
+
+    /*************************************************************************
+     *
+     * gauge: a value which can go up and down.  A gauge is usually set from
+     * one place, so it isn't sharded.
+     */
+
+    class gauge : nonmovable {
+        std::atomic<std::int64_t> _value{0};
+
+    public:
+        gauge() = default;
+
+        auto set(std::int64_t v) noexcept -> void
+        {
+            _value.store(v, std::memory_order_relaxed);
+        }
+
+        auto add(std::int64_t n = 1) noexcept -> void
+        {
+            _value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        auto sub(std::int64_t n = 1) noexcept -> void
+        {
+            _value.fetch_sub(n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] auto value() const noexcept -> std::int64_t
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+    };
+
+    /*************************************************************************
+     *
+     * histogram: the distribution of a set of non-negative integer values,
+     * e.g. latencies in nanoseconds.
+     *
+     * Values are counted in log-linear buckets, as in HdrHistogram: each
+     * power of two is divided into 16 buckets of equal width, so a value
+     * is known to within 1/16th (about 6%) of its magnitude however large it
+     * is, and values below 16 are exact.  This needs 976 buckets to cover
+     * every 64-bit value.
+     */
+
+    namespace detail {
+
+        inline constexpr unsigned histogram_sub_bucket_bits = 4;
+        inline constexpr std::size_t histogram_sub_buckets =
+            std::size_t(1) << histogram_sub_bucket_bits;
+        inline constexpr std::size_t histogram_bucket_count =
+            (64 - histogram_sub_bucket_bits + 1) * histogram_sub_buckets;
+
+        [[nodiscard]] constexpr auto histogram_bucket(std::uint64_t v) noexcept
+            -> std::size_t
+        {
+            if (v < histogram_sub_buckets)
+                return static_cast<std::size_t>(v);
+
+            auto exponent = static_cast<unsigned>(std::bit_width(v)) - 1;
+            auto shift = exponent - histogram_sub_bucket_bits;
+            auto sub = (v >> shift) & (histogram_sub_buckets - 1);
+
+            return (shift + 1) * histogram_sub_buckets +
+                   static_cast<std::size_t>(sub);
+        }
+
+        // The smallest value counted in the bucket.
+        [[nodiscard]] constexpr auto
+        histogram_bucket_lower(std::size_t bucket) noexcept -> std::uint64_t
+        {
+            if (bucket < histogram_sub_buckets)
+                return bucket;
+
+            auto shift = bucket / histogram_sub_buckets - 1;
+            auto sub = bucket % histogram_sub_buckets;
+            return (histogram_sub_buckets + sub) << shift;
+        }
+
+        // The largest value counted in the bucket.
+        [[nodiscard]] constexpr auto
+        histogram_bucket_upper(std::size_t bucket) noexcept -> std::uint64_t
+        {
+            if (bucket < histogram_sub_buckets)
+                return bucket;
+
+            auto shift = bucket / histogram_sub_buckets - 1;
+            return histogram_bucket_lower(bucket) +
+                   ((std::uint64_t(1) << shift) - 1);
+        }
+
+    } // namespace detail
+
+    // A copy of a histogram's counts at one point in time.  Snapshots can
+    // be merged, e.g. to combine histograms from several processes.
+    class histogram_snapshot {
+        std::vector<std::uint64_t> _buckets =
+            std::vector<std::uint64_t>(detail::histogram_bucket_count);
+        std::uint64_t _count = 0;
+        std::uint64_t _sum = 0;
+
+        friend class histogram;
+
+    public:
+        [[nodiscard]] auto count() const noexcept -> std::uint64_t
+        {
+            return _count;
+        }
+
+        [[nodiscard]] auto sum() const noexcept -> std::uint64_t
+        {
+            return _sum;
+        }
+
+        [[nodiscard]] auto buckets() const noexcept
+            -> std::vector<std::uint64_t> const &
+        {
+            return _buckets;
+        }
+
+        // The value below which the fraction 'q' of the values fall, e.g.
+        // quantile(0.99) is the 99th percentile.  Returns the largest value
+        // in the bucket the quantile is in, or 0 if the histogram is empty.
+        [[nodiscard]] auto quantile(double q) const noexcept -> std::uint64_t;
+
+        auto merge(histogram_snapshot const &other) noexcept -> void;
+    };
+
+    class histogram : nonmovable {
+        struct alignas(ivy::detail::cache_line_size) shard {
+            std::atomic<std::uint64_t> sum{0};
+            std::array<std::atomic<std::uint64_t>,
+                       detail::histogram_bucket_count>
+                buckets{};
+        };
+
+        // Histograms are large, so they use fewer shards than counters.
+        static constexpr std::size_t shard_count = 4;
+        std::unique_ptr<shard[]> _shards =
+            std::make_unique<shard[]>(shard_count);
+
+    public:
+        histogram() = default;
+
+        auto record(std::uint64_t v) noexcept -> void
+        {
+            auto &s = _shards[detail::this_thread_shard() % shard_count];
+            s.buckets[detail::histogram_bucket(v)].fetch_add(
+                1, std::memory_order_relaxed);
+            s.sum.fetch_add(v, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] auto snapshot() const -> histogram_snapshot;
+    };
+
+    /*************************************************************************
+     *
+     * registry: a set of named metrics.  Metrics are created on first use
+     * and live as long as the registry, so references to them can be kept.
+     * Names should follow the Prometheus conventions: snake_case with the
+     * unit as a suffix, and _total for counters.
+     */
+
+    class registry : nonmovable {
+        using metric = std::variant<std::unique_ptr<counter>,
+                                    std::unique_ptr<gauge>,
+                                    std::unique_ptr<histogram>>;
+
+        struct entry {
+            std::string help;
+            metric value;
+        };
+
+        mutable std::mutex _mutex;
+        std::map<std::string, entry, std::less<>> _metrics;
+
+        template <typename T>
+        auto get(std::string_view name, std::string_view help) -> T &;
+
+    public:
+        registry() = default;
+
+        // Return the metric with the given name, creating it if it doesn't
+        // exist.  It is an error to use the same name for metrics of
+        // different kinds.
+        auto get_counter(std::string_view name, std::string_view help = {})
+            -> counter &;
+        auto get_gauge(std::string_view name, std::string_view help = {})
+            -> gauge &;
+        auto get_histogram(std::string_view name, std::string_view help = {})
+            -> histogram &;
+
+        // Write every metric in the Prometheus text format.  Histograms are
+        // written as summaries with the 0.5, 0.9, 0.99 and 0.999 quantiles.
+        auto write_text(std::ostream &strm) const -> void;
+        [[nodiscard]] auto text() const -> std::string;
+    };
+
+    auto get_global_registry() -> registry *;
+
+} // namespace ivy::metrics
+
+#endif // IVY_METRICS_HXX_INCLUDED
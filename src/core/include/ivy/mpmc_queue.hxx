@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_MPMC_QUEUE_HXX_INCLUDED
+#define IVY_MPMC_QUEUE_HXX_INCLUDED
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <ivy/check.hxx>
+#include <ivy/noncopyable.hxx>
+
+namespace ivy {
+
+    namespace detail {
+
+        // Assumed cache line size, used to keep the producer and consumer
+        // positions from sharing a line.
+        inline constexpr std::size_t cache_line_size = 64;
+
+    } // namespace detail
+
+    /*
+     * mpmc_queue<T>: a bounded, lock-free, multi-producer multi-consumer
+     * queue (Vyukov's algorithm).  Each cell carries a sequence number which
+     * tells producers and consumers whether the cell is ready for them, so
+     * the only contended operations are the two position counters.
+     *
+     * The capacity is rounded up to a power of two.  Neither try_emplace()
+     * nor try_pop() ever block; callers decide what to do when the queue is
+     * full or empty.
+     */
+    template <typename T>
+    class mpmc_queue : nonmovable {
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+
+            auto value() noexcept -> T *
+            {
+                return std::launder(reinterpret_cast<T *>(&storage[0]));
+            }
+        };
+
+        std::unique_ptr<cell[]> _cells;
+        std::size_t _mask;
+
+        alignas(detail::cache_line_size) std::atomic<std::size_t> _enqueue_pos{
+            0};
+        alignas(detail::cache_line_size) std::atomic<std::size_t> _dequeue_pos{
+            0};
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        explicit mpmc_queue(size_type capacity);
+        ~mpmc_queue();
+
+        // Construct a new element at the back of the queue.  Returns false
+        // if the queue is full.
+        template <typename... Args>
+        [[nodiscard]] auto try_emplace(Args &&...args) -> bool;
+
+        [[nodiscard]] auto try_push(T const &v) -> bool
+        {
+            return try_emplace(v);
+        }
+
+        [[nodiscard]] auto try_push(T &&v) -> bool
+        {
+            return try_emplace(std::move(v));
+        }
+
+        // Remove the element at the front of the queue and move it into
+        // 'out'.  Returns false if the queue is empty.
+        [[nodiscard]] auto try_pop(T &out) -> bool;
+
+        // Remove the element at the front of the queue and discard it.
+        [[nodiscard]] auto try_discard() -> bool;
+
+        [[nodiscard]] auto capacity() const noexcept -> size_type
+        {
+            return _mask + 1;
+        }
+
+        // Number of elements in the queue.  This is only a snapshot and may
+        // already be out of date when it returns.
+        [[nodiscard]] auto size_approx() const noexcept -> size_type;
+
+        [[nodiscard]] auto empty_approx() const noexcept -> bool
+        {
+            return size_approx() == 0;
+        }
+
+    private:
+        template <typename F>
+        auto _pop(F &&f) -> bool;
+    };
+
+    template <typename T>
+    mpmc_queue<T>::mpmc_queue(size_type capacity)
+        : _cells(std::make_unique<cell[]>(
+              std::bit_ceil(capacity < 2 ? size_type(2) : capacity)))
+        , _mask(std::bit_ceil(capacity < 2 ? size_type(2) : capacity) - 1)
+    {
+        for (size_type i = 0; i <= _mask; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    mpmc_queue<T>::~mpmc_queue()
+    {
+        while (try_discard())
+            ;
+    }
+
+    template <typename T>
+    template <typename... Args>
+    auto mpmc_queue<T>::try_emplace(Args &&...args) -> bool
+    {
+        cell *c;
+        auto pos = _enqueue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            c = &_cells[pos & _mask];
+            auto seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos);
+
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // If construction throws, the cell is still handed over to the
+        // consumers, so we must leave something in it.
+        static_assert(std::is_nothrow_constructible_v<T, Args &&...> ||
+                          std::is_nothrow_default_constructible_v<T>,
+                      "mpmc_queue: T must have a fallback constructor");
+
+        if constexpr (std::is_nothrow_constructible_v<T, Args &&...>) {
+            new (&c->storage[0]) T(std::forward<Args>(args)...);
+        } else {
+            try {
+                new (&c->storage[0]) T(std::forward<Args>(args)...);
+            } catch (...) {
+                new (&c->storage[0]) T();
+                c->sequence.store(pos + 1, std::memory_order_release);
+                throw;
+            }
+        }
+
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T>
+    template <typename F>
+    auto mpmc_queue<T>::_pop(F &&f) -> bool
+    {
+        cell *c;
+        auto pos = _dequeue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            c = &_cells[pos & _mask];
+            auto seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto *v = c->value();
+        f(*v);
+        v->~T();
+
+        c->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T>
+    auto mpmc_queue<T>::try_pop(T &out) -> bool
+    {
+        static_assert(std::is_nothrow_move_assignable_v<T>,
+                      "mpmc_queue: T must be nothrow move assignable");
+
+        return _pop([&](T &v) { out = std::move(v); });
+    }
+
+    template <typename T>
+    auto mpmc_queue<T>::try_discard() -> bool
+    {
+        return _pop([](T &) {});
+    }
+
+    template <typename T>
+    auto mpmc_queue<T>::size_approx() const noexcept -> size_type
+    {
+        auto head = _dequeue_pos.load(std::memory_order_relaxed);
+        auto tail = _enqueue_pos.load(std::memory_order_relaxed);
+
+        if (tail <= head)
+            return 0;
+
+        auto size = tail - head;
+        return size > capacity() ? capacity() : size;
+    }
+
+} // namespace ivy
+
+#endif // IVY_MPMC_QUEUE_HXX_INCLUDED
@@ -21,41 +21,90 @@
 #ifndef IVY_SIPHASH_HXX_INCLUDED
 #define IVY_SIPHASH_HXX_INCLUDED
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <span>
-#include <array>
 
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+
+#include <ivy/buffer/buffer.hxx>
 #include <ivy/check.hxx>
 
 namespace ivy {
 
     namespace detail {
 
-        inline auto sip_u32u8le(std::uint32_t v, std::byte *a) -> void {
-            a[0] = static_cast<std::byte>(v);
-            a[1] = static_cast<std::byte>(v >> 8);
-            a[2] = static_cast<std::byte>(v >> 16);
-            a[3] = static_cast<std::byte>(v >> 24);
+        inline auto sip_bswap64(std::uint64_t v) noexcept -> std::uint64_t
+        {
+            v = ((v & 0x00FF00FF00FF00FFull) << 8) |
+                ((v >> 8) & 0x00FF00FF00FF00FFull);
+            v = ((v & 0x0000FFFF0000FFFFull) << 16) |
+                ((v >> 16) & 0x0000FFFF0000FFFFull);
+            return (v << 32) | (v >> 32);
         }
 
-        inline auto sip_u64u8le(std::uint64_t v, std::byte *a) -> void {
-            sip_u32u8le(static_cast<std::uint32_t>(v), a);
-            sip_u32u8le(static_cast<std::uint32_t>(v >> 32), a + 4);
+        inline auto sip_u64u8le(std::uint64_t v, std::byte *a) -> void
+        {
+            if constexpr (std::endian::native == std::endian::big)
+                v = sip_bswap64(v);
+
+            std::memcpy(a, &v, sizeof(v));
         }
 
-        inline auto sip_u8u64le(std::byte const *a) -> std::uint64_t {
-            std::uint64_t r = 0;
-            r |= static_cast<std::uint64_t>(a[0]);
-            r |= static_cast<std::uint64_t>(a[1]) << 8;
-            r |= static_cast<std::uint64_t>(a[2]) << 16;
-            r |= static_cast<std::uint64_t>(a[3]) << 24;
-            r |= static_cast<std::uint64_t>(a[4]) << 32;
-            r |= static_cast<std::uint64_t>(a[5]) << 40;
-            r |= static_cast<std::uint64_t>(a[6]) << 48;
-            r |= static_cast<std::uint64_t>(a[7]) << 56;
+        // Load a little-endian word from a possibly unaligned address.
+        inline auto sip_u8u64le(std::byte const *a) -> std::uint64_t
+        {
+            std::uint64_t r;
+            std::memcpy(&r, a, sizeof(r));
+
+            if constexpr (std::endian::native == std::endian::big)
+                r = sip_bswap64(r);
+
             return r;
         }
 
+        // The last block of the message: the remaining 0-7 bytes, with the
+        // low byte of the message length in the top byte.
+        inline auto sip_final_block(std::byte const *ni, std::size_t inlen)
+            -> std::uint64_t
+        {
+            std::uint64_t b = static_cast<std::uint64_t>(inlen) << 56;
+
+            switch (inlen & 7) {
+            case 7:
+                b |= static_cast<std::uint64_t>(ni[6]) << 48;
+                [[fallthrough]];
+            case 6:
+                b |= static_cast<std::uint64_t>(ni[5]) << 40;
+                [[fallthrough]];
+            case 5:
+                b |= static_cast<std::uint64_t>(ni[4]) << 32;
+                [[fallthrough]];
+            case 4:
+                b |= static_cast<std::uint64_t>(ni[3]) << 24;
+                [[fallthrough]];
+            case 3:
+                b |= static_cast<std::uint64_t>(ni[2]) << 16;
+                [[fallthrough]];
+            case 2:
+                b |= static_cast<std::uint64_t>(ni[1]) << 8;
+                [[fallthrough]];
+            case 1:
+                b |= static_cast<std::uint64_t>(ni[0]);
+                break;
+            case 0:
+                break;
+            }
+
+            return b;
+        }
+
         inline auto sip_rotl(std::uint64_t x, std::uint64_t b) -> std::uint64_t
         {
             return (x << b) | (x >> (64 - b));
@@ -88,8 +137,102 @@ namespace ivy {
             v.v[2] = sip_rotl(v.v[2], 32);
         }
 
+        template <std::size_t crounds>
+        inline auto sip_compress(sip_state &state, std::uint64_t m) -> void
+        {
+            state.v[3] ^= m;
+
+            for (std::size_t i = 0; i < crounds; ++i)
+                sip_round(state);
+
+            state.v[0] ^= m;
+        }
+
+        // Absorb the whole message, including the final block.
+        template <std::size_t crounds>
+        inline auto sip_absorb(sip_state &state,
+                               std::span<std::byte const> in) -> void
+        {
+            auto inlen = in.size();
+            std::byte const *ni = in.data();
+            std::byte const *end = ni + inlen - (inlen % sizeof(std::uint64_t));
+
+            for (; ni != end; ni += 8)
+                sip_compress<crounds>(state, sip_u8u64le(ni));
+
+            sip_compress<crounds>(state, sip_final_block(ni, inlen));
+        }
+
+        // Half 'i' of a 16-byte key.  The size is checked before any of
+        // the key is read.
+        inline auto sip_key_half(std::span<std::byte const> k,
+                                 std::size_t i) noexcept -> std::uint64_t
+        {
+            IVY_CHECK(k.size() == 16, "siphash: invalid key size");
+            return sip_u8u64le(k.data() + 8 * i);
+        }
+
+        template <std::size_t drounds>
+        inline auto sip_finalize(sip_state &state) -> std::uint64_t
+        {
+            for (std::size_t i = 0; i < drounds; ++i)
+                sip_round(state);
+
+            return state.v[0] ^ state.v[1] ^ state.v[2] ^ state.v[3];
+        }
+
     } // namespace detail
 
+    /*
+     * siphash_key: a SipHash key, stored as the initial state it produces so
+     * that hashing with the same key repeatedly doesn't need to parse the
+     * key each time.
+     */
+    class siphash_key {
+        detail::sip_state _state;
+
+    public:
+        // The all-zeroes key.
+        siphash_key() noexcept
+            : siphash_key(0, 0)
+        {
+        }
+
+        siphash_key(std::uint64_t k0, std::uint64_t k1) noexcept
+        {
+            _state.v[0] ^= k0;
+            _state.v[1] ^= k1;
+            _state.v[2] ^= k0;
+            _state.v[3] ^= k1;
+        }
+
+        explicit siphash_key(std::span<std::byte const> k) noexcept
+            : siphash_key(detail::sip_key_half(k, 0),
+                          detail::sip_key_half(k, 1))
+        {
+        }
+
+        [[nodiscard]] auto initial_state() const noexcept
+            -> detail::sip_state const &
+        {
+            return _state;
+        }
+    };
+
+    // SipHash with a 64-bit result.
+    template <std::size_t crounds = 2, std::size_t drounds = 4>
+    [[nodiscard]] auto siphash64(std::span<std::byte const> in,
+                                 siphash_key const &key) noexcept
+        -> std::uint64_t
+    {
+        auto state = key.initial_state();
+        detail::sip_absorb<crounds>(state, in);
+        state.v[2] ^= 0xff;
+        return detail::sip_finalize<drounds>(state);
+    }
+
+    // SipHash with a 64-bit or 128-bit result, depending on the size of
+    // 'out'.
     template <std::size_t crounds = 2, std::size_t drounds = 4>
     auto siphash(std::span<std::byte const> in,
                  std::span<std::byte const> k,
@@ -99,86 +242,354 @@ namespace ivy {
         IVY_CHECK(out.size() == 8 || out.size() == 16,
                   "siphash: invalid out size");
 
-        auto inlen = in.size();
-        auto outlen = out.size();
+        siphash_key key(k);
 
-        std::byte const *ni = in.data();
+        if (out.size() == 8) {
+            detail::sip_u64u8le(siphash64<crounds, drounds>(in, key),
+                                out.data());
+            return;
+        }
 
-        detail::sip_state state;
+        auto state = key.initial_state();
+        state.v[1] ^= 0xee;
+        detail::sip_absorb<crounds>(state, in);
 
-        uint64_t k0 = detail::sip_u8u64le(k.data());
-        uint64_t k1 = detail::sip_u8u64le(k.data() + 8);
-        uint64_t m;
-        std::byte const *end = ni + inlen - (inlen % sizeof(uint64_t));
-        const int left = inlen & 7;
-        uint64_t b = ((uint64_t)inlen) << 56;
+        state.v[2] ^= 0xee;
+        detail::sip_u64u8le(detail::sip_finalize<drounds>(state), out.data());
 
-        state.v[3] ^= k1;
-        state.v[2] ^= k0;
-        state.v[1] ^= k1;
-        state.v[0] ^= k0;
+        state.v[1] ^= 0xdd;
+        detail::sip_u64u8le(detail::sip_finalize<drounds>(state),
+                            out.data() + 8);
+    }
 
-        if (outlen == 16)
-            state.v[1] ^= 0xee;
+    /*************************************************************************
+     *
+     * siphash_state: SipHash over input which arrives in pieces, e.g. the
+     * readable ranges of a buffer or data read from a channel.  Feeding the
+     * same bytes to update() in any number of pieces gives the same result
+     * as siphash64() over the whole input.
+     */
 
-        for (; ni != end; ni += 8) {
-            m = detail::sip_u8u64le(ni);
-            state.v[3] ^= m;
+    template <std::size_t crounds = 2, std::size_t drounds = 4>
+    class siphash_state {
+        detail::sip_state _state;
 
-            for (std::size_t i = 0; i < crounds; ++i)
-                sip_round(state);
+        // Bytes from the end of the last update() which didn't fill a word.
+        std::array<std::byte, 8> _tail{};
+        std::size_t _ntail = 0;
 
-            state.v[0] ^= m;
+        // The total number of bytes hashed; only the low byte is used.
+        std::uint64_t _length = 0;
+
+    public:
+        explicit siphash_state(siphash_key const &key = {}) noexcept
+            : _state(key.initial_state())
+        {
         }
 
-        switch (left) {
-        case 7:
-            b |= ((uint64_t)ni[6]) << 48;
-        case 6:
-            b |= ((uint64_t)ni[5]) << 40;
-        case 5:
-            b |= ((uint64_t)ni[4]) << 32;
-        case 4:
-            b |= ((uint64_t)ni[3]) << 24;
-        case 3:
-            b |= ((uint64_t)ni[2]) << 16;
-        case 2:
-            b |= ((uint64_t)ni[1]) << 8;
-        case 1:
-            b |= ((uint64_t)ni[0]);
-            break;
-        case 0:
-            break;
-        }
-
-        state.v[3] ^= b;
-
-        for (std::size_t i = 0; i < crounds; ++i)
-            sip_round(state);
-
-        state.v[0] ^= b;
-
-        if (outlen == 16)
-            state.v[2] ^= 0xee;
-        else
+        auto update(std::span<std::byte const> in) noexcept -> void
+        {
+            _length += in.size();
+
+            auto const *p = in.data();
+            auto n = in.size();
+
+            if (_ntail) {
+                auto take = std::min(n, _tail.size() - _ntail);
+                std::memcpy(_tail.data() + _ntail, p, take);
+                _ntail += take;
+                p += take;
+                n -= take;
+
+                if (_ntail < _tail.size())
+                    return;
+
+                detail::sip_compress<crounds>(_state,
+                                              detail::sip_u8u64le(_tail.data()));
+                _ntail = 0;
+            }
+
+            for (; n >= 8; p += 8, n -= 8)
+                detail::sip_compress<crounds>(_state, detail::sip_u8u64le(p));
+
+            if (n) {
+                std::memcpy(_tail.data(), p, n);
+                _ntail = n;
+            }
+        }
+
+        // Return the hash of everything passed to update() so far.  The
+        // state isn't changed, so more data can still be added.
+        [[nodiscard]] auto finish() const noexcept -> std::uint64_t
+        {
+            // _ntail is always _length % 8, so the tail is exactly the last
+            // block sip_final_block() expects.
+            auto state = _state;
+            detail::sip_compress<crounds>(
+                state,
+                detail::sip_final_block(_tail.data(),
+                                        static_cast<std::size_t>(_length)));
             state.v[2] ^= 0xff;
+            return detail::sip_finalize<drounds>(state);
+        }
 
-        for (std::size_t i = 0; i < drounds; ++i)
-            sip_round(state);
+        // The number of bytes hashed so far.
+        [[nodiscard]] auto size() const noexcept -> std::uint64_t
+        {
+            return _length;
+        }
+    };
 
-        b = state.v[0] ^ state.v[1] ^ state.v[2] ^ state.v[3];
-        detail::sip_u64u8le(b, out.data());
+    // Hash the readable contents of a buffer with siphash64(), without
+    // copying them out of the buffer.
+    template <readable_buffer Buffer>
+    [[nodiscard]] auto siphash_buffer(Buffer &buf, siphash_key const &key)
+        -> std::uint64_t
+    {
+        siphash_state<> state(key);
 
-        if (outlen == 8)
-            return;
+        for (auto &&range : buf.readable_ranges())
+            state.update(std::as_bytes(std::span(range)));
 
-        state.v[1] ^= 0xdd;
+        return state.finish();
+    }
+
+    /*************************************************************************
+     *
+     * siphash_many: hash several independent inputs with the same key, e.g.
+     * when building a hash table.  When built with AVX2, inputs are hashed
+     * in groups of siphash_lanes, one per 64-bit lane of a vector register,
+     * so the rounds of a group cost about the same as the rounds of one
+     * input.  Otherwise each input is hashed with siphash64().
+     */
+
+    inline constexpr std::size_t siphash_lanes = 4;
+
+    namespace detail {
+
+#if defined(__AVX2__)
+
+        using sip_vector = __m256i;
+
+        inline auto sip_vset(std::uint64_t const *v) noexcept -> sip_vector
+        {
+            return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(v));
+        }
+
+        inline auto sip_vsplat(std::uint64_t v) noexcept -> sip_vector
+        {
+            return _mm256_set1_epi64x(static_cast<long long>(v));
+        }
+
+        inline auto sip_vstore(std::uint64_t *out, sip_vector v) noexcept
+            -> void
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v);
+        }
+
+        inline auto sip_vadd(sip_vector a, sip_vector b) noexcept
+            -> sip_vector
+        {
+            return _mm256_add_epi64(a, b);
+        }
+
+        inline auto sip_vxor(sip_vector a, sip_vector b) noexcept
+            -> sip_vector
+        {
+            return _mm256_xor_si256(a, b);
+        }
+
+        // Take 'a' in lanes where 'mask' is zero, and 'b' elsewhere.
+        inline auto sip_vselect(sip_vector mask,
+                                sip_vector a,
+                                sip_vector b) noexcept -> sip_vector
+        {
+            return _mm256_blendv_epi8(a, b, mask);
+        }
+
+        template <int bits>
+        inline auto sip_vrotl(sip_vector x) noexcept -> sip_vector
+        {
+            if constexpr (bits == 32)
+                return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+            else if constexpr (bits == 16)
+                return _mm256_shuffle_epi8(
+                    x,
+                    _mm256_setr_epi8(6, 7, 0, 1, 2, 3, 4, 5,
+                                     14, 15, 8, 9, 10, 11, 12, 13,
+                                     6, 7, 0, 1, 2, 3, 4, 5,
+                                     14, 15, 8, 9, 10, 11, 12, 13));
+            else
+                return _mm256_or_si256(_mm256_slli_epi64(x, bits),
+                                       _mm256_srli_epi64(x, 64 - bits));
+        }
+
+        struct sip_vstate {
+            sip_vector v0, v1, v2, v3;
+        };
+
+        inline auto sip_vround(sip_vstate &s) noexcept -> void
+        {
+            s.v0 = sip_vadd(s.v0, s.v1);
+            s.v1 = sip_vrotl<13>(s.v1);
+            s.v1 = sip_vxor(s.v1, s.v0);
+            s.v0 = sip_vrotl<32>(s.v0);
+            s.v2 = sip_vadd(s.v2, s.v3);
+            s.v3 = sip_vrotl<16>(s.v3);
+            s.v3 = sip_vxor(s.v3, s.v2);
+            s.v0 = sip_vadd(s.v0, s.v3);
+            s.v3 = sip_vrotl<21>(s.v3);
+            s.v3 = sip_vxor(s.v3, s.v0);
+            s.v2 = sip_vadd(s.v2, s.v1);
+            s.v1 = sip_vrotl<17>(s.v1);
+            s.v1 = sip_vxor(s.v1, s.v2);
+            s.v2 = sip_vrotl<32>(s.v2);
+        }
+
+        // Hash exactly siphash_lanes inputs.
+        template <std::size_t crounds, std::size_t drounds>
+        auto sip_hash_lanes(std::span<std::byte const> const *in,
+                            siphash_key const &key,
+                            std::uint64_t *out) noexcept -> void
+        {
+            auto const &initial = key.initial_state();
+            sip_vstate s{sip_vsplat(initial.v[0]),
+                         sip_vsplat(initial.v[1]),
+                         sip_vsplat(initial.v[2]),
+                         sip_vsplat(initial.v[3])};
+
+            // Each input has blocks[i] full blocks and then its final block.
+            std::array<std::size_t, siphash_lanes> blocks;
+            for (std::size_t i = 0; i < siphash_lanes; ++i)
+                blocks[i] = in[i].size() / 8;
+
+            auto [min_blocks, max_blocks] = std::ranges::minmax(blocks);
+
+            std::array<std::uint64_t, siphash_lanes> m;
+            std::array<std::uint64_t, siphash_lanes> active;
+
+            for (std::size_t j = 0; j <= max_blocks; ++j) {
+                for (std::size_t i = 0; i < siphash_lanes; ++i) {
+                    if (j < blocks[i])
+                        m[i] = sip_u8u64le(in[i].data() + j * 8);
+                    else if (j == blocks[i])
+                        m[i] = sip_final_block(in[i].data() + j * 8,
+                                               in[i].size());
+                    else
+                        m[i] = 0;
+
+                    active[i] = j <= blocks[i] ? ~std::uint64_t(0) : 0;
+                }
+
+                auto mv = sip_vset(m.data());
+                auto before = s;
+
+                s.v3 = sip_vxor(s.v3, mv);
+                for (std::size_t r = 0; r < crounds; ++r)
+                    sip_vround(s);
+                s.v0 = sip_vxor(s.v0, mv);
+
+                // Lanes whose input has already ended keep their state.
+                if (j > min_blocks) {
+                    auto mask = sip_vset(active.data());
+                    s.v0 = sip_vselect(mask, before.v0, s.v0);
+                    s.v1 = sip_vselect(mask, before.v1, s.v1);
+                    s.v2 = sip_vselect(mask, before.v2, s.v2);
+                    s.v3 = sip_vselect(mask, before.v3, s.v3);
+                }
+            }
+
+            s.v2 = sip_vxor(s.v2, sip_vsplat(0xff));
+            for (std::size_t r = 0; r < drounds; ++r)
+                sip_vround(s);
+
+            sip_vstore(out,
+                       sip_vxor(sip_vxor(s.v0, s.v1), sip_vxor(s.v2, s.v3)));
+        }
+
+        // Hash exactly siphash_lanes 64-bit integers.  Every input is one
+        // block long, so no lane needs masking.
+        template <std::size_t crounds, std::size_t drounds>
+        auto sip_hash_lanes(std::uint64_t const *in,
+                            siphash_key const &key,
+                            std::uint64_t *out) noexcept -> void
+        {
+            auto const &initial = key.initial_state();
+            sip_vstate s{sip_vsplat(initial.v[0]),
+                         sip_vsplat(initial.v[1]),
+                         sip_vsplat(initial.v[2]),
+                         sip_vsplat(initial.v[3])};
+
+            auto compress = [&](sip_vector m) {
+                s.v3 = sip_vxor(s.v3, m);
+                for (std::size_t r = 0; r < crounds; ++r)
+                    sip_vround(s);
+                s.v0 = sip_vxor(s.v0, m);
+            };
+
+            compress(sip_vset(in));
+            compress(sip_vsplat(std::uint64_t(8) << 56));
 
-        for (std::size_t i = 0; i < drounds; ++i)
-            sip_round(state);
+            s.v2 = sip_vxor(s.v2, sip_vsplat(0xff));
+            for (std::size_t r = 0; r < drounds; ++r)
+                sip_vround(s);
 
-        b = state.v[0] ^ state.v[1] ^ state.v[2] ^ state.v[3];
-        detail::sip_u64u8le(b, out.data() + 8);
+            sip_vstore(out,
+                       sip_vxor(sip_vxor(s.v0, s.v1), sip_vxor(s.v2, s.v3)));
+        }
+
+#endif // __AVX2__
+
+    } // namespace detail
+
+    // Set out[i] to siphash64(in[i], key).  'out' must be at least as large
+    // as 'in'.
+    template <std::size_t crounds = 2, std::size_t drounds = 4>
+    auto siphash_many(std::span<std::span<std::byte const> const> in,
+                      siphash_key const &key,
+                      std::span<std::uint64_t> out) noexcept -> void
+    {
+        IVY_CHECK(out.size() >= in.size(), "siphash_many: output too small");
+
+        std::size_t i = 0;
+
+#if defined(__AVX2__)
+        for (; i + siphash_lanes <= in.size(); i += siphash_lanes)
+            detail::sip_hash_lanes<crounds, drounds>(&in[i], key, &out[i]);
+#endif
+
+        for (; i < in.size(); ++i)
+            out[i] = siphash64<crounds, drounds>(in[i], key);
+    }
+
+    // Set out[i] to siphash64() of the bytes of in[i], as ivy::hash does
+    // for integers.
+    template <std::size_t crounds = 2, std::size_t drounds = 4>
+    auto siphash_many(std::span<std::uint64_t const> in,
+                      siphash_key const &key,
+                      std::span<std::uint64_t> out) noexcept -> void
+    {
+        IVY_CHECK(out.size() >= in.size(), "siphash_many: output too small");
+
+        std::size_t i = 0;
+
+#if defined(__AVX2__)
+        if constexpr (std::endian::native == std::endian::little)
+            for (; i + siphash_lanes <= in.size(); i += siphash_lanes)
+                detail::sip_hash_lanes<crounds, drounds>(
+                    &in[i], key, &out[i]);
+#endif
+
+        for (; i < in.size(); ++i) {
+            auto state = key.initial_state();
+            detail::sip_compress<crounds>(
+                state,
+                detail::sip_u8u64le(
+                    reinterpret_cast<std::byte const *>(&in[i])));
+            detail::sip_compress<crounds>(state, std::uint64_t(8) << 56);
+            state.v[2] ^= 0xff;
+            out[i] = detail::sip_finalize<drounds>(state);
+        }
     }
 
 } // namespace ivy
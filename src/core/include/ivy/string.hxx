@@ -403,13 +403,38 @@ namespace ivy {
         return basic_string<Encoding, Alloc>(std::move(chars));
     }
 
-    template <typename encoding, typename alloc>
-    struct hash<basic_string<encoding, alloc>> {
+    template <character_encoding Encoding, typename Alloc>
+    auto operator==(basic_string<Encoding, Alloc> const &a,
+                    std::span<typename Encoding::char_type const> s) noexcept
+        -> bool
+    {
+        auto a_span = std::span(a.data(), a.data() + a.size());
+        return (a_span.size() == s.size()) && std::ranges::equal(a_span, s);
+    }
+
+    // Strings hash the same as a span or a nul-terminated array of the
+    // same characters, so hash tables can look strings up by either.
+    template <typename encoding, typename alloc, typename policy>
+    struct hash<basic_string<encoding, alloc>, policy> {
+        using is_transparent = void;
+        using char_type = typename encoding::char_type;
+
         auto operator()(basic_string<encoding, alloc> const &v) const noexcept
             -> std::size_t
         {
             auto bytes = as_bytes(std::span(v.data(), v.size()));
-            return detail::hash_bytes(bytes);
+            return policy::hash_bytes(bytes);
+        }
+
+        auto operator()(std::span<char_type const> v) const noexcept
+            -> std::size_t
+        {
+            return policy::hash_bytes(as_bytes(v));
+        }
+
+        auto operator()(char_type const *v) const noexcept -> std::size_t
+        {
+            return (*this)(std::span(v, encoding::length(v)));
         }
     };
 
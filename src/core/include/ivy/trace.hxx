@@ -6,73 +6,151 @@
 #ifndef IVY_TRACE_HXX_INCLUDED
 #define IVY_TRACE_HXX_INCLUDED
 
-#ifdef IVY_ENABLE_TRACING
-#    include <array>
-#    include <atomic>
-#    include <cstdio>
-#    include <cstdlib>
-#    include <format>
-#    include <iostream>
-#    include <mutex>
-
-namespace ivy::detail {
-
-    [[nodiscard]] inline auto tracing_enabled() -> bool
-    {
-        static std::atomic<int> enabled;
-
-        switch (enabled) {
-        case 1:
-            return true;
-
-        case -1:
-            return false;
-
-        default:
-#    ifdef _WIN32
-            std::array<char, 16> buf{};
-            const char *s = buf.data();
-            size_t size{};
-            auto err = getenv_s(&size, buf.data(), buf.size(), "IVY_TRACE");
-            if (err != 0 || size == 0)
-                s = nullptr;
-#    else
-            char const *s = std::getenv("IVY_TRACE");
-#    endif
-            if (s != nullptr && (*s != 0)) {
-                enabled = 1;
-                return true;
-            }
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <string_view>
+#include <iosfwd>
+#include <tuple>
+#include <utility>
+
+#include <ivy/log/capture.hxx>
+#include <ivy/noncopyable.hxx>
+
+/*
+ * IVY_TRACE(format, args...): record a trace event.
+ *
+ * Tracing is controlled by the IVY_TRACE environment variable:
+ *
+ *    unset, empty or "0"  tracing is off; IVY_TRACE costs one relaxed load.
+ *    "print"              each event is formatted and written to std::cerr.
+ *    anything else        events are recorded in a per-thread ring buffer
+ *                         and written to std::cerr if the program crashes,
+ *                         or when trace_dump() is called.
+ *
+ * In buffer mode an event is a timestamp, a pointer to the (static) format
+ * string and the raw arguments, written to the calling thread's ring without
+ * locking; formatting only happens when the buffer is dumped.  The ring keeps
+ * the most recent trace_buffer_events events of each thread.
+ *
+ * IVY_SPAN(name): record the time from here to the end of the enclosing
+ * scope as a span.  The name must be a string literal; by convention it is
+ * "<component>.<operation>", e.g. "odbc.fetch".  A span is one event,
+ * written when the scope exits.
+ *
+ * trace_export_chrome() writes the buffered events in the Chrome trace
+ * event format, which can be loaded into chrome://tracing or Perfetto.
+ * Spans become complete ("X") events and IVY_TRACE messages become instant
+ * events.
+ *
+ * IVY_TRACE and IVY_SPAN compile to nothing unless IVY_ENABLE_TRACING is
+ * defined.
+ */
+
+namespace ivy {
+
+    enum struct trace_mode : int {
+        off = -1,
+        buffer = 1,
+        print = 2,
+    };
+
+    inline constexpr std::size_t trace_buffer_events = 4096;
+
+    // Change the trace mode, overriding IVY_TRACE.
+    auto set_trace_mode(trace_mode mode) -> void;
+
+    // Write the buffered events of all threads to 'strm', oldest first.
+    auto trace_dump(std::ostream &strm) -> void;
+
+    // Write the buffered events of all threads to 'strm' as a Chrome trace
+    // event JSON document.
+    auto trace_export_chrome(std::ostream &strm) -> void;
+
+    namespace detail {
+
+        // 0 until the environment has been checked, then a trace_mode.
+        inline std::atomic<int> trace_state{0};
+
+        auto init_tracing() -> int;
+
+        [[nodiscard]] inline auto tracing_enabled() -> bool
+        {
+            auto state = trace_state.load(std::memory_order_relaxed);
+            if (state == 0)
+                state = init_tracing();
 
-            enabled = -1;
-            return false;
+            return state > 0;
         }
-    }
 
-    template <typename... Args>
-    inline auto trace_print(Args &&...args) -> void
-    {
-        static std::mutex print_guard;
+        auto trace_message(log::detail::captured_message const &message)
+            -> void;
 
-        std::string s(std::format(std::forward<Args>(args)...));
+        template <typename... Args>
+        auto trace_event(std::format_string<Args...> format, Args &&...args)
+            -> void
+        {
+            std::tuple<decltype(log::detail::prepare_argument(args))...>
+                prepared{log::detail::prepare_argument(args)...};
 
-        std::lock_guard lock(print_guard);
-        std::cerr.write(s.data(), static_cast<std::streamsize>(s.size()));
-        std::cerr.write("\n", 1);
-    }
+            trace_message(log::detail::capture_message(format.get(), prepared));
+        }
+
+        // The trace timestamp: steady_clock in nanoseconds.
+        [[nodiscard]] inline auto trace_clock() noexcept -> std::int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        auto trace_span_end(std::string_view name, std::int64_t start) noexcept
+            -> void;
+
+        class trace_span : nonmovable {
+            std::string_view _name;
+            std::int64_t _start = 0;
+
+        public:
+            template <std::size_t N>
+            explicit trace_span(char const (&name)[N]) noexcept
+                : _name(name, N - 1)
+            {
+                if (tracing_enabled())
+                    _start = trace_clock();
+            }
+
+            ~trace_span()
+            {
+                if (_start != 0)
+                    trace_span_end(_name, _start);
+            }
+        };
+
+    } // namespace detail
+
+} // namespace ivy
+
+#define IVY_TRACE_CONCAT2(a, b) a##b
+#define IVY_TRACE_CONCAT(a, b) IVY_TRACE_CONCAT2(a, b)
+
+#ifdef IVY_ENABLE_TRACING
 
 #    define IVY_TRACE(...)                                                     \
         do {                                                                   \
             if (::ivy::detail::tracing_enabled()) {                            \
-                ::ivy::detail::trace_print(__VA_ARGS__);                       \
+                ::ivy::detail::trace_event(__VA_ARGS__);                       \
             }                                                                  \
         } while (0)
 
-} // namespace ivy::detail
+#    define IVY_SPAN(name)                                                     \
+        ::ivy::detail::trace_span IVY_TRACE_CONCAT(ivy_span_, __LINE__)(name)
 
 #else
 
 #    define IVY_TRACE(...) ((void)0)
+#    define IVY_SPAN(name) ((void)0)
 
 #endif
 
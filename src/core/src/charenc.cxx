@@ -12,6 +12,7 @@
 #include <ivy/charenc/error.hxx>
 #include <ivy/charenc/icu/error.hxx>
 #include <ivy/charenc/icu/ucnv.hxx>
+#include <ivy/metrics.hxx>
 #include <ivy/noncopyable.hxx>
 #include <ivy/trace.hxx>
 
@@ -166,6 +167,15 @@ namespace ivy::icu {
                             std::vector<std::byte> &output)
         -> expected<void, error>
     {
+        IVY_SPAN("ucnv.convert");
+
+        static auto &transcoded_bytes =
+            metrics::get_global_registry()->get_counter(
+                "ivy_transcoded_bytes_total",
+                "Bytes passed to the ICU converter.");
+
+        transcoded_bytes.add(input.size());
+
         UErrorCode err = U_ZERO_ERROR;
 
         char const *input_begin = reinterpret_cast<char const *>(input.data());
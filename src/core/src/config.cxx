@@ -437,7 +437,7 @@ namespace ivy::config {
                 // Match closing '}'
                 if (std::tie(tok, rest) = expect(rest, T_RBRACE); !tok) {
                     IVY_TRACE(
-                        "config: parse_item: did not find '}' after subitems");
+                        "config: parse_item: did not find '}}' after subitems");
                     return {{}, s};
                 }
 
@@ -467,6 +467,8 @@ namespace ivy::config {
 
     auto parse(string const &text) -> expected<item, config_error>
     {
+        IVY_SPAN("config.parse");
+
         item ret(datum(U"<top-level>"));
 
         std::optional<item> itm;
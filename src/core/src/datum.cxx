@@ -3,12 +3,23 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <array>
+#include <charconv>
+#include <format>
+#include <optional>
+#include <string_view>
+
 #include <ivy/check.hxx>
 #include <ivy/datum.hxx>
+#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/bytes.hxx>
+#include <ivy/datum/date.hxx>
+#include <ivy/datum/decimal.hxx>
+#include <ivy/datum/double.hxx>
 #include <ivy/datum/integer.hxx>
-#include <ivy/datum/string.hxx>
 #include <ivy/datum/null.hxx>
-#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/datum/timestamp.hxx>
 #include <ivy/string/to_string.hxx>
 
 namespace ivy {
@@ -18,46 +29,266 @@ namespace ivy {
      * datum
      */
 
+    namespace {
+
+        using microseconds_timestamp =
+            std::chrono::sys_time<std::chrono::microseconds>;
+
+        // The text forms of the built-in types are all ASCII.
+        auto ascii_string(std::string_view s) -> string
+        {
+            std::vector<string::value_type> chars(s.begin(), s.end());
+            return string(std::move(chars));
+        }
+
+        auto double_str(double d) -> string
+        {
+            std::array<char, 32> buf;
+            auto r = std::to_chars(buf.data(), buf.data() + buf.size(), d);
+            return ascii_string(std::string_view(buf.data(), r.ptr));
+        }
+
+        auto date_str(std::chrono::sys_days d) -> string
+        {
+            std::chrono::year_month_day ymd(d);
+            return ascii_string(std::format("{:04}-{:02}-{:02}",
+                                            static_cast<int>(ymd.year()),
+                                            static_cast<unsigned>(ymd.month()),
+                                            static_cast<unsigned>(ymd.day())));
+        }
+
+        auto timestamp_str(microseconds_timestamp t) -> string
+        {
+            auto day = std::chrono::floor<std::chrono::days>(t);
+            std::chrono::year_month_day ymd(day);
+            std::chrono::hh_mm_ss hms(t - day);
+
+            auto s = std::format("{:04}-{:02}-{:02} {:02}:{:02}:{:02}",
+                                 static_cast<int>(ymd.year()),
+                                 static_cast<unsigned>(ymd.month()),
+                                 static_cast<unsigned>(ymd.day()),
+                                 hms.hours().count(),
+                                 hms.minutes().count(),
+                                 hms.seconds().count());
+
+            if (hms.subseconds().count())
+                s += std::format(".{:06}", hms.subseconds().count());
+
+            return ascii_string(s);
+        }
+
+        auto bytes_str(std::vector<std::byte> const &b) -> string
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+
+            std::vector<string::value_type> chars;
+            chars.reserve(b.size() * 2);
+
+            for (auto c : b) {
+                chars.push_back(hex[std::to_integer<unsigned>(c) >> 4]);
+                chars.push_back(hex[std::to_integer<unsigned>(c) & 0xF]);
+            }
+
+            return string(std::move(chars));
+        }
+
+        // Convert a value of a built-in type given as a std::any to its
+        // inline form.  Returns nothing if the type isn't built in.
+        auto builtin_datum(datum_type const *type, std::any const &value)
+            -> std::optional<datum>
+        {
+            if (type == get_null_type()) {
+                if (!std::any_cast<nullptr_t>(&value))
+                    throw bad_datum_cast();
+                return make_null_datum();
+            }
+
+            if (type == get_boolean_type()) {
+                auto const *b = std::any_cast<bool>(&value);
+                if (!b)
+                    throw bad_datum_cast();
+                return make_boolean_datum(*b);
+            }
+
+            if (type == get_integer_type()) {
+                auto const *i = std::any_cast<std::int64_t>(&value);
+                if (!i)
+                    throw bad_datum_cast();
+                return make_integer_datum(*i);
+            }
+
+            if (type == get_string_type()) {
+                auto const *s = std::any_cast<string>(&value);
+                if (!s)
+                    throw bad_datum_cast();
+                return make_string_datum(*s);
+            }
+
+            if (type == get_double_type()) {
+                auto const *d = std::any_cast<double>(&value);
+                if (!d)
+                    throw bad_datum_cast();
+                return make_double_datum(*d);
+            }
+
+            if (type == get_decimal_type()) {
+                auto const *d = std::any_cast<decimal>(&value);
+                if (!d)
+                    throw bad_datum_cast();
+                return make_decimal_datum(*d);
+            }
+
+            if (type == get_date_type()) {
+                auto const *d = std::any_cast<std::chrono::sys_days>(&value);
+                if (!d)
+                    throw bad_datum_cast();
+                return make_date_datum(*d);
+            }
+
+            if (type == get_timestamp_type()) {
+                auto const *t = std::any_cast<microseconds_timestamp>(&value);
+                if (!t)
+                    throw bad_datum_cast();
+                return make_timestamp_datum(*t);
+            }
+
+            if (type == get_bytes_type()) {
+                auto const *b = std::any_cast<std::vector<std::byte>>(&value);
+                if (!b)
+                    throw bad_datum_cast();
+                return make_bytes_datum(*b);
+            }
+
+            return {};
+        }
+
+    } // namespace
+
     datum::datum(datum_type const *type, std::any const &value)
-        : _type(type), _value(value)
+        : datum(type, std::any(value))
     {
     }
 
     datum::datum(datum_type const *type, std::any &&value)
-        : _type(type), _value(std::move(value))
     {
+        if (auto d = builtin_datum(type, value); d) {
+            *this = std::move(*d);
+            return;
+        }
+
+        _value.o = new detail::datum_box<detail::datum_other>{
+            .value = {type, std::move(value)}};
+        _kind = kind::other;
     }
 
-    datum::datum(datum const &) = default;
-    datum::datum(datum &&) noexcept = default;
+    auto datum::release_box() noexcept -> void
+    {
+        if (box_refs().fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
 
-    auto datum::operator=(datum const &) -> datum & = default;
-    auto datum::operator=(datum &&) noexcept -> datum & = default;
+        switch (_kind) {
+        case kind::string:
+            delete _value.s;
+            break;
+        case kind::decimal:
+            delete _value.dec;
+            break;
+        case kind::bytes:
+            delete _value.bytes;
+            break;
+        default:
+            delete _value.o;
+            break;
+        }
+    }
 
     auto datum::type() const noexcept -> datum_type const *
     {
-        return _type;
+        switch (_kind) {
+        case kind::null:
+            return get_null_type();
+        case kind::boolean:
+            return get_boolean_type();
+        case kind::integer:
+            return get_integer_type();
+        case kind::real:
+            return get_double_type();
+        case kind::date:
+            return get_date_type();
+        case kind::timestamp:
+            return get_timestamp_type();
+        case kind::string:
+            return get_string_type();
+        case kind::decimal:
+            return get_decimal_type();
+        case kind::bytes:
+            return get_bytes_type();
+        case kind::other:
+            return _value.o->value.type;
+        }
+
+        return nullptr;
     }
 
     auto datum::str() const -> string
     {
-        return _type->str(_value);
-    }
-
-    auto datum::equal_to(datum const &other) const -> bool
-    {
-        if (this == &other)
-            return true;
-
-        if (_type != other._type)
-            return false;
-
-        return _type->equal(_value, other._value);
+        switch (_kind) {
+        case kind::null:
+            return U"null";
+        case kind::boolean:
+            return _value.b ? U"true" : U"false";
+        case kind::integer:
+            return to_string<string>(_value.i);
+        case kind::real:
+            return double_str(_value.d);
+        case kind::date:
+            return date_str(_value.date);
+        case kind::timestamp:
+            return timestamp_str(_value.timestamp);
+        case kind::string:
+            return _value.s->value;
+        case kind::decimal:
+            return ascii_string(_value.dec->value.str());
+        case kind::bytes:
+            return bytes_str(_value.bytes->value);
+        case kind::other:
+            return _value.o->value.type->str(_value.o->value.value);
+        }
+
+        return {};
+    }
+
+    auto datum::boxed_equal_to(datum const &other) const -> bool
+    {
+        switch (_kind) {
+        case kind::string:
+            return _value.s == other._value.s ||
+                   _value.s->value == other._value.s->value;
+
+        case kind::decimal:
+            return _value.dec == other._value.dec ||
+                   _value.dec->value == other._value.dec->value;
+
+        case kind::bytes:
+            return _value.bytes == other._value.bytes ||
+                   _value.bytes->value == other._value.bytes->value;
+
+        default: {
+            if (_value.o == other._value.o)
+                return true;
+
+            auto const &a = _value.o->value;
+            auto const &b = other._value.o->value;
+            return a.type == b.type && a.type->equal(a.value, b.value);
+        }
+        }
     }
 
     auto datum::storage() const noexcept -> std::any const &
     {
-        return _value;
+        IVY_CHECK(_kind == kind::other,
+                  "datum::storage: built-in types are not stored in std::any");
+        return _value.o->value.value;
     }
 
     auto str(datum const &d) -> string
@@ -65,11 +296,6 @@ namespace ivy {
         return d.str();
     }
 
-    auto operator==(datum const &a, datum const &b) -> bool
-    {
-        return a.equal_to(b);
-    }
-
     /*************************************************************************
      *
      * bad_datum_cast
@@ -119,24 +345,10 @@ namespace ivy {
 
     auto make_integer_datum(std::int64_t i) -> datum
     {
-        return datum(get_integer_type(), i);
+        return datum(datum::kind::integer, {.i = i});
     }
 
-    template <>
-    auto datum_cast<std::int64_t>(datum const &d) -> std::int64_t
-    {
-        auto const *i = std::any_cast<std::int64_t>(&d.storage());
-        if (!i)
-            throw bad_datum_cast();
-        return *i;
-    }
 
-    template <>
-    auto datum_cast<std::int64_t>(datum const *d) -> std::int64_t const *
-    {
-        auto const *i = std::any_cast<std::int64_t>(&d->storage());
-        return i;
-    }
 
     /*************************************************************************
      *
@@ -180,29 +392,16 @@ namespace ivy {
 
     auto make_string_datum(string const &s) -> datum
     {
-        return datum(get_string_type(), s);
+        return datum(datum::kind::string,
+                     {.s = new detail::datum_box<string>{.value = s}});
     }
 
     auto make_string_datum(string::value_type const *s) -> datum
     {
-        return datum(get_string_type(), string(s));
+        return make_string_datum(string(s));
     }
 
-    template <>
-    auto datum_cast<string>(datum const &d) -> string
-    {
-        auto const *s = std::any_cast<string>(&d.storage());
-        if (!s)
-            throw bad_datum_cast();
-        return *s;
-    }
 
-    template <>
-    auto datum_cast<string>(datum const *d) -> string const *
-    {
-        auto const *s = std::any_cast<string>(&d->storage());
-        return s;
-    }
 
     /*************************************************************************
      *
@@ -246,7 +445,7 @@ namespace ivy {
 
     auto make_null_datum() -> datum
     {
-        return datum(get_null_type(), nullptr);
+        return {};
     }
 
     /*************************************************************************
@@ -291,23 +490,242 @@ namespace ivy {
 
     auto make_boolean_datum(bool b) -> datum
     {
-        return datum(get_boolean_type(), b);
+        return datum(datum::kind::boolean, {.b = b});
+    }
+
+    /*************************************************************************
+     *
+     * double_type
+     */
+
+    auto double_type::name() const noexcept -> char const *
+    {
+        return "double";
+    }
+
+    auto double_type::str(std::any const &v) const -> string
+    {
+        auto *d = std::any_cast<double>(&v);
+        IVY_CHECK(d != nullptr, "double_type: bad value");
+
+        return double_str(*d);
+    }
+
+    auto double_type::equal(std::any const &a, std::any const &b) const -> bool
+    {
+        auto *aptr = std::any_cast<double>(&a);
+        IVY_CHECK(aptr != nullptr, "double_type: bad value");
+
+        auto *bptr = std::any_cast<double>(&b);
+        IVY_CHECK(bptr != nullptr, "double_type: bad value");
+
+        return *aptr == *bptr;
+    }
+
+    auto double_type::get() const noexcept -> datum_type const *
+    {
+        return get_double_type();
+    }
+
+    auto get_double_type() -> double_type const *
+    {
+        static double_type type;
+        return &type;
+    }
+
+    auto make_double_datum(double d) -> datum
+    {
+        return datum(datum::kind::real, {.d = d});
+    }
+
+    /*************************************************************************
+     *
+     * decimal_type
+     */
+
+    auto decimal_type::name() const noexcept -> char const *
+    {
+        return "decimal";
+    }
+
+    auto decimal_type::str(std::any const &v) const -> string
+    {
+        auto *d = std::any_cast<decimal>(&v);
+        IVY_CHECK(d != nullptr, "decimal_type: bad value");
+
+        return ascii_string(d->str());
+    }
+
+    auto decimal_type::equal(std::any const &a, std::any const &b) const
+        -> bool
+    {
+        auto *aptr = std::any_cast<decimal>(&a);
+        IVY_CHECK(aptr != nullptr, "decimal_type: bad value");
+
+        auto *bptr = std::any_cast<decimal>(&b);
+        IVY_CHECK(bptr != nullptr, "decimal_type: bad value");
+
+        return *aptr == *bptr;
+    }
+
+    auto decimal_type::get() const noexcept -> datum_type const *
+    {
+        return get_decimal_type();
+    }
+
+    auto get_decimal_type() -> decimal_type const *
+    {
+        static decimal_type type;
+        return &type;
+    }
+
+    auto make_decimal_datum(decimal const &d) -> datum
+    {
+        return datum(datum::kind::decimal,
+                     {.dec = new detail::datum_box<decimal>{.value = d}});
+    }
+
+    /*************************************************************************
+     *
+     * date_type
+     */
+
+    auto date_type::name() const noexcept -> char const *
+    {
+        return "date";
+    }
+
+    auto date_type::str(std::any const &v) const -> string
+    {
+        auto *d = std::any_cast<std::chrono::sys_days>(&v);
+        IVY_CHECK(d != nullptr, "date_type: bad value");
+
+        return date_str(*d);
+    }
+
+    auto date_type::equal(std::any const &a, std::any const &b) const -> bool
+    {
+        auto *aptr = std::any_cast<std::chrono::sys_days>(&a);
+        IVY_CHECK(aptr != nullptr, "date_type: bad value");
+
+        auto *bptr = std::any_cast<std::chrono::sys_days>(&b);
+        IVY_CHECK(bptr != nullptr, "date_type: bad value");
+
+        return *aptr == *bptr;
+    }
+
+    auto date_type::get() const noexcept -> datum_type const *
+    {
+        return get_date_type();
+    }
+
+    auto get_date_type() -> date_type const *
+    {
+        static date_type type;
+        return &type;
+    }
+
+    auto make_date_datum(std::chrono::sys_days d) -> datum
+    {
+        return datum(datum::kind::date, {.date = d});
+    }
+
+    /*************************************************************************
+     *
+     * timestamp_type
+     */
+
+    auto timestamp_type::name() const noexcept -> char const *
+    {
+        return "timestamp";
+    }
+
+    auto timestamp_type::str(std::any const &v) const -> string
+    {
+        auto *t = std::any_cast<microseconds_timestamp>(&v);
+        IVY_CHECK(t != nullptr, "timestamp_type: bad value");
+
+        return timestamp_str(*t);
+    }
+
+    auto timestamp_type::equal(std::any const &a, std::any const &b) const
+        -> bool
+    {
+        auto *aptr = std::any_cast<microseconds_timestamp>(&a);
+        IVY_CHECK(aptr != nullptr, "timestamp_type: bad value");
+
+        auto *bptr = std::any_cast<microseconds_timestamp>(&b);
+        IVY_CHECK(bptr != nullptr, "timestamp_type: bad value");
+
+        return *aptr == *bptr;
+    }
+
+    auto timestamp_type::get() const noexcept -> datum_type const *
+    {
+        return get_timestamp_type();
+    }
+
+    auto get_timestamp_type() -> timestamp_type const *
+    {
+        static timestamp_type type;
+        return &type;
+    }
+
+    auto make_timestamp_datum(microseconds_timestamp t) -> datum
+    {
+        return datum(datum::kind::timestamp, {.timestamp = t});
+    }
+
+    /*************************************************************************
+     *
+     * bytes_type
+     */
+
+    auto bytes_type::name() const noexcept -> char const *
+    {
+        return "bytes";
+    }
+
+    auto bytes_type::str(std::any const &v) const -> string
+    {
+        auto *b = std::any_cast<std::vector<std::byte>>(&v);
+        IVY_CHECK(b != nullptr, "bytes_type: bad value");
+
+        return bytes_str(*b);
+    }
+
+    auto bytes_type::equal(std::any const &a, std::any const &b) const -> bool
+    {
+        auto *aptr = std::any_cast<std::vector<std::byte>>(&a);
+        IVY_CHECK(aptr != nullptr, "bytes_type: bad value");
+
+        auto *bptr = std::any_cast<std::vector<std::byte>>(&b);
+        IVY_CHECK(bptr != nullptr, "bytes_type: bad value");
+
+        return *aptr == *bptr;
+    }
+
+    auto bytes_type::get() const noexcept -> datum_type const *
+    {
+        return get_bytes_type();
+    }
+
+    auto get_bytes_type() -> bytes_type const *
+    {
+        static bytes_type type;
+        return &type;
     }
 
-    template <>
-    auto datum_cast<bool>(datum const &d) -> bool
+    auto make_bytes_datum(std::vector<std::byte> &&b) -> datum
     {
-        auto const *i = std::any_cast<bool>(&d.storage());
-        if (!i)
-            throw bad_datum_cast();
-        return *i;
+        return datum(datum::kind::bytes,
+                     {.bytes = new detail::datum_box<std::vector<std::byte>>{
+                          .value = std::move(b)}});
     }
 
-    template <>
-    auto datum_cast<bool>(datum const *d) -> bool const *
+    auto make_bytes_datum(std::span<std::byte const> b) -> datum
     {
-        auto const *i = std::any_cast<bool>(&d->storage());
-        return i;
+        return make_bytes_datum(std::vector<std::byte>(b.begin(), b.end()));
     }
 
 } // namespace ivy
@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <functional>
+
+#include <ivy/check.hxx>
+#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/column.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/hash.hxx>
+#include <ivy/siphash.hxx>
+
+namespace ivy {
+
+    /*************************************************************************
+     *
+     * column_bitmap
+     */
+
+    namespace {
+
+        // The kinds a datum_column can hold.
+        auto is_column_kind(datum::kind k) -> bool
+        {
+            switch (k) {
+            case datum::kind::null:
+            case datum::kind::boolean:
+            case datum::kind::integer:
+            case datum::kind::string:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        auto words_for(std::size_t bits) -> std::size_t
+        {
+            return (bits + 63) / 64;
+        }
+
+    } // namespace
+
+    column_bitmap::column_bitmap(std::size_t size, bool value)
+    {
+        resize(size, value);
+    }
+
+    auto column_bitmap::push_back(bool value) -> void
+    {
+        if (_size % 64 == 0)
+            _words.push_back(0);
+
+        ++_size;
+        set(_size - 1, value);
+    }
+
+    auto column_bitmap::resize(std::size_t size, bool value) -> void
+    {
+        auto old_size = _size;
+        _words.resize(words_for(size), 0);
+        _size = size;
+
+        if (value) {
+            for (auto i = old_size; i < size && i % 64; ++i)
+                set(i);
+
+            for (auto w = words_for(old_size); w < _words.size(); ++w)
+                _words[w] = ~std::uint64_t(0);
+        }
+
+        // Keep the bits past the end clear.
+        if (_size % 64)
+            _words.back() &= (std::uint64_t(1) << (_size % 64)) - 1;
+    }
+
+    auto column_bitmap::count() const noexcept -> std::size_t
+    {
+        std::size_t n = 0;
+        for (auto w : _words)
+            n += static_cast<std::size_t>(std::popcount(w));
+        return n;
+    }
+
+    auto column_bitmap::operator&=(column_bitmap const &other) noexcept
+        -> column_bitmap &
+    {
+        IVY_CHECK(_size == other._size, "column_bitmap: size mismatch");
+
+        for (std::size_t i = 0; i < _words.size(); ++i)
+            _words[i] &= other._words[i];
+        return *this;
+    }
+
+    auto column_bitmap::operator|=(column_bitmap const &other) noexcept
+        -> column_bitmap &
+    {
+        IVY_CHECK(_size == other._size, "column_bitmap: size mismatch");
+
+        for (std::size_t i = 0; i < _words.size(); ++i)
+            _words[i] |= other._words[i];
+        return *this;
+    }
+
+    auto column_bitmap::flip() noexcept -> column_bitmap &
+    {
+        for (auto &w : _words)
+            w = ~w;
+
+        if (_size % 64)
+            _words.back() &= (std::uint64_t(1) << (_size % 64)) - 1;
+        return *this;
+    }
+
+    auto operator&(column_bitmap a, column_bitmap const &b) -> column_bitmap
+    {
+        return a &= b;
+    }
+
+    auto operator|(column_bitmap a, column_bitmap const &b) -> column_bitmap
+    {
+        return a |= b;
+    }
+
+    /*************************************************************************
+     *
+     * datum_column
+     */
+
+    datum_column::datum_column(datum::kind type)
+        : _type(type)
+    {
+        IVY_CHECK(is_column_kind(type),
+                  "datum_column: this type cannot be stored in a column");
+    }
+
+    auto datum_column::reserve(std::size_t n) -> void
+    {
+        switch (_type) {
+        case datum::kind::integer:
+            _integers.reserve(n);
+            break;
+        case datum::kind::boolean:
+            _booleans.reserve(n);
+            break;
+        case datum::kind::string:
+            _offsets.reserve(n + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto datum_column::append_null() -> void
+    {
+        switch (_type) {
+        case datum::kind::integer:
+            _integers.push_back(0);
+            break;
+        case datum::kind::boolean:
+            _booleans.push_back(0);
+            break;
+        case datum::kind::string:
+            _offsets.push_back(_chars.size());
+            break;
+        default:
+            break;
+        }
+
+        _validity.push_back(false);
+        ++_size;
+    }
+
+    auto datum_column::append_integer(std::int64_t value) -> void
+    {
+        if (_type != datum::kind::integer)
+            throw bad_datum_cast();
+
+        _integers.push_back(value);
+        _validity.push_back(true);
+        ++_size;
+    }
+
+    auto datum_column::append_boolean(bool value) -> void
+    {
+        if (_type != datum::kind::boolean)
+            throw bad_datum_cast();
+
+        _booleans.push_back(value ? 1 : 0);
+        _validity.push_back(true);
+        ++_size;
+    }
+
+    auto datum_column::append_string(std::span<string::value_type const> value)
+        -> void
+    {
+        if (_type != datum::kind::string)
+            throw bad_datum_cast();
+
+        _chars.insert(_chars.end(), value.begin(), value.end());
+        _offsets.push_back(_chars.size());
+        _validity.push_back(true);
+        ++_size;
+    }
+
+    auto datum_column::append(datum const &value) -> void
+    {
+        switch (value.get_kind()) {
+        case datum::kind::null:
+            append_null();
+            break;
+
+        case datum::kind::integer:
+            append_integer(datum_cast<std::int64_t>(value));
+            break;
+
+        case datum::kind::boolean:
+            append_boolean(datum_cast<bool>(value));
+            break;
+
+        case datum::kind::string: {
+            auto const *s = datum_cast<string>(&value);
+            append_string(std::span(s->data(), s->size()));
+            break;
+        }
+
+        default:
+            throw bad_datum_cast();
+        }
+    }
+
+    auto datum_column::value(std::size_t i) const -> datum
+    {
+        IVY_CHECK(i < _size, "datum_column::value: index out of range");
+
+        if (is_null(i))
+            return make_null_datum();
+
+        switch (_type) {
+        case datum::kind::integer:
+            return make_integer_datum(_integers[i]);
+        case datum::kind::boolean:
+            return make_boolean_datum(_booleans[i] != 0);
+        case datum::kind::string: {
+            auto s = string_at(i);
+            return make_string_datum(string(s.data(), s.size()));
+        }
+        default:
+            return make_null_datum();
+        }
+    }
+
+    auto datum_column::to_datums() const -> std::vector<datum>
+    {
+        std::vector<datum> ret;
+        ret.reserve(_size);
+
+        for (std::size_t i = 0; i < _size; ++i)
+            ret.push_back(value(i));
+
+        return ret;
+    }
+
+    auto datum_column::filter(column_bitmap const &selection) const
+        -> datum_column
+    {
+        IVY_CHECK(selection.size() == _size,
+                  "datum_column::filter: size mismatch");
+
+        datum_column ret(_type);
+        ret.reserve(selection.count());
+
+        // Visit only the selected rows, a word at a time.
+        auto words = selection.words();
+        for (std::size_t w = 0; w < words.size(); ++w) {
+            for (auto bits = words[w]; bits; bits &= bits - 1) {
+                auto i =
+                    w * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+
+                if (is_null(i)) {
+                    ret.append_null();
+                    continue;
+                }
+
+                switch (_type) {
+                case datum::kind::integer:
+                    ret.append_integer(_integers[i]);
+                    break;
+                case datum::kind::boolean:
+                    ret.append_boolean(_booleans[i] != 0);
+                    break;
+                case datum::kind::string:
+                    ret.append_string(string_at(i));
+                    break;
+                default:
+                    ret.append_null();
+                    break;
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    auto datum_column::hash(std::span<std::size_t> out) const -> void
+    {
+        IVY_CHECK(out.size() >= _size, "datum_column::hash: output too small");
+
+        // Integers and strings are hashed as ivy::hash does, with
+        // siphash_many, which hashes several rows at once when it can.
+        // Rows are hashed in chunks so the inputs fit on the stack.
+        constexpr std::size_t chunk = 256;
+        std::array<std::uint64_t, chunk> hashes;
+
+        switch (_type) {
+        case datum::kind::integer: {
+            std::array<std::uint64_t, chunk> inputs;
+
+            for (std::size_t base = 0; base < _size; base += chunk) {
+                auto n = std::min(chunk, _size - base);
+
+                for (std::size_t j = 0; j < n; ++j)
+                    inputs[j] = static_cast<std::uint64_t>(_integers[base + j]);
+
+                siphash_many(std::span<std::uint64_t const>(inputs).first(n),
+                             detail::get_siphash_key(),
+                             hashes);
+
+                for (std::size_t j = 0; j < n; ++j)
+                    out[base + j] = static_cast<std::size_t>(hashes[j]);
+            }
+            break;
+        }
+
+        case datum::kind::string: {
+            std::array<std::span<std::byte const>, chunk> inputs;
+
+            for (std::size_t base = 0; base < _size; base += chunk) {
+                auto n = std::min(chunk, _size - base);
+
+                for (std::size_t j = 0; j < n; ++j)
+                    inputs[j] = std::as_bytes(string_at(base + j));
+
+                siphash_many(std::span<std::span<std::byte const> const>(
+                                 inputs).first(n),
+                             detail::get_siphash_key(),
+                             hashes);
+
+                for (std::size_t j = 0; j < n; ++j)
+                    out[base + j] = static_cast<std::size_t>(hashes[j]);
+            }
+            break;
+        }
+
+        case datum::kind::boolean: {
+            std::size_t const h[2] = {ivy::hash<bool>{}(false),
+                                      ivy::hash<bool>{}(true)};
+            for (std::size_t i = 0; i < _size; ++i)
+                out[i] = h[_booleans[i]];
+            break;
+        }
+
+        default:
+            std::ranges::fill(out.first(_size), 0);
+            return;
+        }
+
+        // Clear the hashes of null rows, a word of the bitmap at a time.
+        auto words = _validity.words();
+        for (std::size_t w = 0; w < words.size(); ++w) {
+            for (auto bits = ~words[w]; bits; bits &= bits - 1) {
+                auto i =
+                    w * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                if (i < _size)
+                    out[i] = 0;
+            }
+        }
+    }
+
+    auto make_datum_column(std::span<datum const> values)
+        -> expected<datum_column, error>
+    try {
+        auto type = datum::kind::null;
+
+        for (auto const &v : values) {
+            if (v.get_kind() != datum::kind::null) {
+                type = v.get_kind();
+                break;
+            }
+        }
+
+        if (!is_column_kind(type))
+            return make_unexpected(make_error<bad_datum_cast>());
+
+        datum_column column(type);
+        column.reserve(values.size());
+
+        for (auto const &v : values)
+            column.append(v);
+
+        return column;
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    /*************************************************************************
+     *
+     * Comparisons.
+     */
+
+    namespace {
+
+        // Apply 'pred' to each row, 64 rows per output word.  The inner loop
+        // has no branches, so the compiler can vectorize it.
+        template <typename Pred>
+        auto compare_rows(std::size_t size, Pred pred) -> column_bitmap
+        {
+            column_bitmap ret(size);
+            auto words = ret.words();
+
+            auto full = size / 64;
+
+            for (std::size_t w = 0; w < full; ++w) {
+                auto base = w * 64;
+                std::uint64_t bits = 0;
+
+                for (std::size_t j = 0; j < 64; ++j)
+                    bits |= std::uint64_t(pred(base + j) ? 1 : 0) << j;
+
+                words[w] = bits;
+            }
+
+            if (size % 64) {
+                auto base = full * 64;
+                std::uint64_t bits = 0;
+
+                for (std::size_t j = 0; j < size % 64; ++j)
+                    bits |= std::uint64_t(pred(base + j) ? 1 : 0) << j;
+
+                words[full] = bits;
+            }
+
+            return ret;
+        }
+
+        auto ordering_matches(compare_op op, std::strong_ordering c) noexcept
+            -> bool
+        {
+            switch (op) {
+            case compare_op::equal:
+                return c == 0;
+            case compare_op::not_equal:
+                return c != 0;
+            case compare_op::less:
+                return c < 0;
+            case compare_op::less_equal:
+                return c <= 0;
+            case compare_op::greater:
+                return c > 0;
+            case compare_op::greater_equal:
+                return c >= 0;
+            }
+
+            return false;
+        }
+
+        // Instantiate 'fn' with the comparison as a function object, so
+        // the per-row loop has no switch in it.
+        template <typename Fn>
+        auto with_op(compare_op op, Fn &&fn)
+        {
+            switch (op) {
+            case compare_op::equal:
+                return fn(std::equal_to<>());
+            case compare_op::not_equal:
+                return fn(std::not_equal_to<>());
+            case compare_op::less:
+                return fn(std::less<>());
+            case compare_op::less_equal:
+                return fn(std::less_equal<>());
+            case compare_op::greater:
+                return fn(std::greater<>());
+            case compare_op::greater_equal:
+                break;
+            }
+
+            return fn(std::greater_equal<>());
+        }
+
+        auto compare_strings(std::span<string::value_type const> a,
+                             std::span<string::value_type const> b) noexcept
+            -> std::strong_ordering
+        {
+            return std::lexicographical_compare_three_way(
+                a.begin(), a.end(), b.begin(), b.end());
+        }
+
+        auto type_mismatch() -> detail::unexpected<error>
+        {
+            return make_unexpected(make_error<bad_datum_cast>());
+        }
+
+    } // namespace
+
+    auto compare(datum_column const &column,
+                 compare_op op,
+                 datum const &value) -> expected<column_bitmap, error>
+    {
+        auto size = column.size();
+
+        if (value.get_kind() == datum::kind::null ||
+            column.type() == datum::kind::null)
+            return column_bitmap(size);
+
+        if (value.get_kind() != column.type())
+            return type_mismatch();
+
+        column_bitmap ret;
+
+        switch (column.type()) {
+        case datum::kind::integer: {
+            auto v = datum_cast<std::int64_t>(value);
+            auto const *data = column.integers().data();
+            ret = with_op(op, [&](auto cmp) {
+                return compare_rows(
+                    size, [&](std::size_t i) { return cmp(data[i], v); });
+            });
+            break;
+        }
+
+        case datum::kind::boolean: {
+            std::uint8_t v = datum_cast<bool>(value) ? 1 : 0;
+            auto const *data = column.booleans().data();
+            ret = with_op(op, [&](auto cmp) {
+                return compare_rows(
+                    size, [&](std::size_t i) { return cmp(data[i], v); });
+            });
+            break;
+        }
+
+        case datum::kind::string: {
+            auto const *s = datum_cast<string>(&value);
+            auto v = std::span(s->data(), s->size());
+            ret = compare_rows(size, [&](std::size_t i) {
+                return ordering_matches(
+                    op, compare_strings(column.string_at(i), v));
+            });
+            break;
+        }
+
+        default:
+            return type_mismatch();
+        }
+
+        ret &= column.validity();
+        return ret;
+    }
+
+    auto compare(datum_column const &a,
+                 compare_op op,
+                 datum_column const &b) -> expected<column_bitmap, error>
+    {
+        IVY_CHECK(a.size() == b.size(), "compare: column size mismatch");
+
+        auto size = a.size();
+
+        if (a.type() == datum::kind::null || b.type() == datum::kind::null)
+            return column_bitmap(size);
+
+        if (a.type() != b.type())
+            return type_mismatch();
+
+        column_bitmap ret;
+
+        switch (a.type()) {
+        case datum::kind::integer: {
+            auto const *x = a.integers().data();
+            auto const *y = b.integers().data();
+            ret = with_op(op, [&](auto cmp) {
+                return compare_rows(
+                    size, [&](std::size_t i) { return cmp(x[i], y[i]); });
+            });
+            break;
+        }
+
+        case datum::kind::boolean: {
+            auto const *x = a.booleans().data();
+            auto const *y = b.booleans().data();
+            ret = with_op(op, [&](auto cmp) {
+                return compare_rows(
+                    size, [&](std::size_t i) { return cmp(x[i], y[i]); });
+            });
+            break;
+        }
+
+        case datum::kind::string:
+            ret = compare_rows(size, [&](std::size_t i) {
+                return ordering_matches(
+                    op, compare_strings(a.string_at(i), b.string_at(i)));
+            });
+            break;
+
+        default:
+            return type_mismatch();
+        }
+
+        ret &= a.validity();
+        ret &= b.validity();
+        return ret;
+    }
+
+} // namespace ivy
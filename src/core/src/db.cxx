@@ -50,19 +50,19 @@ namespace ivy::db {
 
     auto row_iterator::operator->() const noexcept -> pointer
     {
-        return _row_range->_cur.get();
+        return _row_range->_cur;
     }
 
     auto row_iterator::operator++() -> row_iterator &
     {
-        auto next = _row_range->_rs->get_next_row();
+        auto next = _row_range->_rs->next_row();
         if (next) {
-            _row_range->_cur = std::move(*next);
+            _row_range->_cur = *next;
             return *this;
         }
 
         if (next.error().is<ivy::db::end_of_data>()) {
-            _row_range->_cur.reset();
+            _row_range->_cur = nullptr;
             _row_range = nullptr;
             return *this;
         }
@@ -186,23 +186,23 @@ namespace ivy::db {
 
     auto value_iterator::operator*() const noexcept -> reference
     {
-        return *_value_range->_cur.get();
+        return *_value_range->_cur;
     }
 
     auto value_iterator::operator->() const noexcept -> pointer
     {
-        return _value_range->_cur.get();
+        return _value_range->_cur;
     }
 
     auto value_iterator::operator++() -> value_iterator &
     {
         if (_cur == _value_range->_ncols) {
-            _value_range->_cur.reset();
+            _value_range->_cur = nullptr;
             _value_range = nullptr;
             return *this;
         }
 
-        _value_range->_cur = _value_range->_row->get_value(_cur).or_throw();
+        _value_range->_cur = _value_range->_row->value_at(_cur).or_throw();
         ++_cur;
         return *this;
     }
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include <ivy/db/async.hxx>
+#include <ivy/trace.hxx>
+
+namespace ivy::db {
+
+    /*************************************************************************
+     *
+     * worker_pool
+     */
+
+    worker_pool::worker_pool(std::size_t nthreads)
+    {
+        nthreads = std::max<std::size_t>(nthreads, 1);
+
+        try {
+            for (std::size_t i = 0; i < nthreads; ++i)
+                _threads.emplace_back([this] { run(); });
+        } catch (...) {
+            // Stop the threads which did start.
+            {
+                std::lock_guard lock(_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+
+            for (auto &&thread : _threads)
+                thread.join();
+            throw;
+        }
+    }
+
+    worker_pool::~worker_pool()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stopping = true;
+        }
+
+        _wake.notify_all();
+
+        for (auto &&thread : _threads)
+            thread.join();
+    }
+
+    auto worker_pool::push(std::function<void()> task) -> void
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+
+        _wake.notify_one();
+    }
+
+    auto worker_pool::run() -> void
+    {
+        for (;;) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock lock(_mutex);
+                _wake.wait(lock, [&] { return _stopping || !_tasks.empty(); });
+
+                if (_tasks.empty())
+                    return;
+
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+
+            // A packaged_task stores any exception in its future.
+            task();
+        }
+    }
+
+    auto execute_async(worker_pool &pool, query &query)
+        -> std::future<expected<query_result_handle, error>>
+    {
+        return pool.submit([&query] {
+            IVY_SPAN("db.execute_async");
+            return query.execute();
+        });
+    }
+
+    auto next_batch_async(worker_pool &pool,
+                          result_set &rs,
+                          record_batch &batch,
+                          std::size_t max_rows)
+        -> std::future<expected<std::size_t, error>>
+    {
+        return pool.submit([&rs, &batch, max_rows] {
+            IVY_SPAN("db.next_batch_async");
+            return rs.next_batch(batch, max_rows);
+        });
+    }
+
+    /*************************************************************************
+     *
+     * batch_reader
+     */
+
+    batch_reader::batch_reader(worker_pool &pool,
+                               result_set &rs,
+                               std::size_t batch_rows)
+        : _pool(&pool)
+        , _result_set(&rs)
+        , _batch_rows(std::max<std::size_t>(batch_rows, 1))
+    {
+        start();
+    }
+
+    batch_reader::~batch_reader()
+    {
+        if (_pending.valid())
+            _pending.wait();
+    }
+
+    auto batch_reader::start() -> void
+    {
+        _pending = next_batch_async(
+            *_pool, *_result_set, _batches[_filling], _batch_rows);
+    }
+
+    auto batch_reader::next() noexcept -> expected<record_batch const *, error>
+    try {
+        if (_error)
+            return make_unexpected(*_error);
+
+        if (!_pending.valid())
+            return nullptr;
+
+        auto n = _pending.get();
+        if (!n) {
+            _error = n.error();
+            return make_unexpected(n.error());
+        }
+
+        if (*n == 0)
+            return nullptr;
+
+        // The caller has finished with the other batch, since it called
+        // next() again.
+        auto const &ready = _batches[_filling];
+        _filling = 1 - _filling;
+
+        // A short batch means the result set has run out, so don't ask
+        // for another.  If the next fetch can't be started, still return
+        // this batch, and report the error on the next call.
+        if (*n == _batch_rows) {
+            try {
+                start();
+            } catch (...) {
+                _error = make_error(std::current_exception());
+            }
+        }
+
+        return &ready;
+    } catch (...) {
+        _error = make_error(std::current_exception());
+        return make_unexpected(*_error);
+    }
+
+} // namespace ivy::db
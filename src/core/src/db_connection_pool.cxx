@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+#include <ivy/check.hxx>
+#include <ivy/db/connection_pool.hxx>
+#include <ivy/trace.hxx>
+
+namespace ivy::db {
+
+    /*************************************************************************
+     *
+     * connection_lease
+     */
+
+    connection_lease::connection_lease(connection_pool *pool,
+                                       connection_handle conn)
+        : _pool(pool)
+        , _connection(std::move(conn))
+    {
+    }
+
+    connection_lease::connection_lease(connection_lease &&other) noexcept
+        : _pool(std::exchange(other._pool, nullptr))
+        , _connection(std::move(other._connection))
+        , _broken(std::exchange(other._broken, false))
+    {
+    }
+
+    auto connection_lease::operator=(connection_lease &&other) noexcept
+        -> connection_lease &
+    {
+        if (this != &other) {
+            release();
+            _pool = std::exchange(other._pool, nullptr);
+            _connection = std::move(other._connection);
+            _broken = std::exchange(other._broken, false);
+        }
+
+        return *this;
+    }
+
+    connection_lease::~connection_lease()
+    {
+        release();
+    }
+
+    auto connection_lease::discard() noexcept -> void
+    {
+        _broken = true;
+        release();
+    }
+
+    auto connection_lease::release() noexcept -> void
+    {
+        if (_pool && _connection)
+            _pool->give_back(std::move(_connection), _broken);
+
+        _pool = nullptr;
+        _connection.reset();
+        _broken = false;
+    }
+
+    /*************************************************************************
+     *
+     * connection_pool
+     */
+
+    namespace {
+
+        auto nanoseconds_since(std::chrono::steady_clock::time_point start)
+            -> std::uint64_t
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count());
+        }
+
+    } // namespace
+
+    connection_pool::connection_pool(factory_type factory,
+                                     connection_pool_config config)
+        : _factory(std::move(factory))
+        , _config(std::move(config))
+    {
+        _config.max_size = std::max<std::size_t>(_config.max_size, 1);
+        _config.min_size = std::min(_config.min_size, _config.max_size);
+        _idle.reserve(_config.max_size);
+
+        auto *registry = _config.registry;
+        auto const &prefix = _config.metrics_prefix;
+
+        _wait_time = &registry->get_histogram(
+            prefix + "_wait_nanoseconds",
+            "Time spent waiting to lease a database connection.");
+        _leases_in_use = &registry->get_gauge(
+            prefix + "_leases_in_use", "Database connections leased.");
+        _connections = &registry->get_gauge(
+            prefix + "_connections", "Open pooled database connections.");
+        _lease_timeouts = &registry->get_counter(
+            prefix + "_lease_timeouts_total",
+            "Leases which timed out waiting for a database connection.");
+    }
+
+    connection_pool::~connection_pool()
+    {
+        IVY_CHECK(_leased == 0,
+                  "connection_pool destroyed with connections leased");
+
+        std::vector<connection_handle> conns;
+        for (auto &&idle : _idle)
+            conns.push_back(std::move(idle.connection));
+
+        _open -= _idle.size();
+        _idle.clear();
+        update_gauges();
+        close(conns);
+    }
+
+    auto connection_pool::connect() noexcept
+        -> expected<connection_handle, error>
+    try {
+        IVY_SPAN("db.pool.connect");
+        return _factory();
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto connection_pool::update_gauges() noexcept -> void
+    {
+        _leases_in_use->set(static_cast<std::int64_t>(_leased));
+        _connections->set(static_cast<std::int64_t>(_open));
+    }
+
+    // Move expired connections into 'expired', but no more than its spare
+    // capacity, so this never allocates while the lock is held; the
+    // caller reserves it first.
+    auto connection_pool::take_expired(
+        clock::time_point now, std::vector<connection_handle> &expired) noexcept
+        -> void
+    {
+        // _idle is oldest first, so the expired connections are at the
+        // front.
+        std::size_t n = 0;
+        while (n < _idle.size() && expired.size() < expired.capacity() &&
+               _open > _config.min_size &&
+               now - _idle[n].since >= _config.idle_timeout) {
+            expired.push_back(std::move(_idle[n].connection));
+            --_open;
+            ++n;
+        }
+
+        _idle.erase(_idle.begin(),
+                    _idle.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+
+    // Disconnecting can mean a round trip to the server, so it's done
+    // without holding the lock.
+    auto connection_pool::close(std::span<connection_handle> conns) noexcept
+        -> void
+    {
+        for (auto &&conn : conns) {
+            try {
+                conn->disconnect();
+            } catch (...) {
+                // The connection is being thrown away anyway.
+            }
+        }
+    }
+
+    auto connection_pool::give_back(connection_handle conn,
+                                    bool broken) noexcept -> void
+    {
+        std::vector<connection_handle> expired;
+        try {
+            expired.reserve(_config.max_size);
+        } catch (...) {
+            // Leave the expired connections for the next eviction.
+        }
+
+        {
+            std::lock_guard lock(_mutex);
+            auto now = clock::now();
+
+            --_leased;
+
+            // _idle has room for every open connection, so this doesn't
+            // allocate.
+            if (broken)
+                --_open;
+            else
+                _idle.push_back({std::move(conn), now});
+
+            take_expired(now, expired);
+            update_gauges();
+        }
+
+        _available.notify_one();
+
+        if (conn)
+            close(std::span(&conn, 1));
+        close(expired);
+    }
+
+    auto connection_pool::fill() noexcept -> expected<void, error>
+    try {
+        for (;;) {
+            {
+                std::lock_guard lock(_mutex);
+                if (_open >= _config.min_size)
+                    return {};
+                ++_open;
+                update_gauges();
+            }
+
+            auto conn = connect();
+
+            if (!conn) {
+                {
+                    std::lock_guard lock(_mutex);
+                    --_open;
+                    update_gauges();
+                }
+
+                return make_unexpected(conn.error());
+            }
+
+            idle_connection entry{std::move(*conn), clock::now()};
+
+            try {
+                std::lock_guard lock(_mutex);
+                _idle.push_back(std::move(entry));
+            } catch (...) {
+                // push_back leaves 'entry' alone if it throws, so the
+                // connection is still ours to close.
+                {
+                    std::lock_guard lock(_mutex);
+                    --_open;
+                    update_gauges();
+                }
+
+                close(std::span(&entry.connection, 1));
+                throw;
+            }
+
+            _available.notify_one();
+        }
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto connection_pool::lease() noexcept
+        -> expected<connection_lease, error>
+    try {
+        IVY_SPAN("db.pool.lease");
+
+        auto start = clock::now();
+        auto deadline = start + _config.lease_timeout;
+
+        evict_idle();
+
+        for (;;) {
+            connection_handle conn;
+
+            {
+                std::unique_lock lock(_mutex);
+
+                auto ready = [&] {
+                    return !_idle.empty() || _open < _config.max_size;
+                };
+
+                if (!_available.wait_until(lock, deadline, ready)) {
+                    _lease_timeouts->add();
+                    _wait_time->record(nanoseconds_since(start));
+                    return make_unexpected(make_error(std::errc::timed_out));
+                }
+
+                // Take the most recently returned connection, or reserve a
+                // slot for a new one.
+                if (!_idle.empty()) {
+                    conn = std::move(_idle.back().connection);
+                    _idle.pop_back();
+                } else
+                    ++_open;
+
+                ++_leased;
+                update_gauges();
+            }
+
+            if (!conn) {
+                auto r = connect();
+                if (!r) {
+                    // Release the slot reserved for it.
+                    {
+                        std::lock_guard lock(_mutex);
+                        --_open;
+                        --_leased;
+                        update_gauges();
+                    }
+
+                    _available.notify_one();
+                    return make_unexpected(r.error());
+                }
+
+                conn = std::move(*r);
+            } else if (_config.check_on_lease && !conn->is_alive()) {
+                // Drop it and try again, which will open a new one if
+                // there are no more idle connections.
+                give_back(std::move(conn), true);
+                continue;
+            }
+
+            _wait_time->record(nanoseconds_since(start));
+            return connection_lease(this, std::move(conn));
+        }
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto connection_pool::evict_idle() noexcept -> std::size_t
+    {
+        std::vector<connection_handle> expired;
+        try {
+            expired.reserve(_config.max_size);
+        } catch (...) {
+            return 0;
+        }
+
+        {
+            std::lock_guard lock(_mutex);
+            take_expired(clock::now(), expired);
+            update_gauges();
+        }
+
+        close(expired);
+        return expired.size();
+    }
+
+    auto connection_pool::size() noexcept -> std::size_t
+    {
+        std::lock_guard lock(_mutex);
+        return _open;
+    }
+
+    auto connection_pool::idle() noexcept -> std::size_t
+    {
+        std::lock_guard lock(_mutex);
+        return _idle.size();
+    }
+
+    auto connection_pool::in_use() noexcept -> std::size_t
+    {
+        std::lock_guard lock(_mutex);
+        return _leased;
+    }
+
+} // namespace ivy::db
@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <ivy/charenc/utf.hxx>
+#include <ivy/db/error.hxx>
+#include <ivy/db/memory.hxx>
+#include <ivy/db/query_result.hxx>
+#include <ivy/db/result_set.hxx>
+#include <ivy/db/row.hxx>
+#include <ivy/db/value.hxx>
+
+namespace ivy::db::memory {
+
+    namespace {
+
+        auto to_key(u16string const &name) -> std::u16string
+        {
+            return std::u16string(name.data(), name.size());
+        }
+
+        auto utf8_to_utf16(std::string_view s, std::u16string &out) -> void
+        {
+            out.clear();
+            decode_utf8(s, [&](char32_t c) {
+                encode_utf16(c, std::back_inserter(out));
+            });
+        }
+
+        // Copy value i of 'from' to the end of 'to', which has the same
+        // type.
+        auto append_value(batch_column &to,
+                          batch_column const &from,
+                          std::size_t i) -> void
+        {
+            if (from.is_null(i)) {
+                to.append_null();
+                return;
+            }
+
+            switch (from.type()) {
+            case column_type::null:
+                to.append_null();
+                break;
+
+            case column_type::boolean:
+                to.append_boolean(from.booleans().test(i));
+                break;
+
+            case column_type::int64:
+                to.append_int64(from.int64s()[i]);
+                break;
+
+            case column_type::float64:
+                to.append_double(from.doubles()[i]);
+                break;
+
+            case column_type::date32:
+                to.append_date(std::chrono::sys_days(
+                    std::chrono::days(from.int32s()[i])));
+                break;
+
+            case column_type::timestamp_us:
+                to.append_timestamp(
+                    std::chrono::sys_time<std::chrono::microseconds>(
+                        std::chrono::microseconds(from.int64s()[i])));
+                break;
+
+            case column_type::utf8:
+                to.append_utf8(from.string_at(i));
+                break;
+
+            case column_type::binary:
+                to.append_binary(std::as_bytes(std::span(from.string_at(i))));
+                break;
+            }
+        }
+
+        auto bad_column() -> error
+        {
+            return make_error(std::errc::invalid_argument);
+        }
+
+        // Reads a value straight out of the table, which outlives it.
+        class bytes_channel final : public pmrichannel<std::byte> {
+            std::span<std::byte const> _data;
+
+        public:
+            explicit bytes_channel(std::span<std::byte const> data)
+                : _data(data)
+            {
+            }
+
+            auto read(std::span<std::byte> buf) noexcept
+                -> expected<io_size_t, error> override
+            {
+                if (_data.empty())
+                    return make_unexpected(make_error(errc::end_of_file));
+
+                auto n = std::min(buf.size(), _data.size());
+                std::ranges::copy(_data.first(n), buf.begin());
+                _data = _data.subspan(n);
+                return n;
+            }
+        };
+
+        class row;
+
+        class value final : public db::value {
+        public:
+            row const *_row;
+            std::size_t _column;
+
+            value(row const *r, std::size_t column)
+                : _row(r)
+                , _column(column)
+            {
+            }
+
+            auto as_datum() const noexcept -> expected<datum, error> override;
+
+            auto open_stream() noexcept
+                -> expected<std::unique_ptr<pmrichannel<std::byte>>,
+                            error> override;
+        };
+
+        class row final : public db::row {
+        public:
+            record_batch const *_table;
+            std::size_t _index = 0;
+            value _value;
+            std::u16string _text;
+
+            explicit row(record_batch const *table, std::size_t index = 0)
+                : _table(table)
+                , _index(index)
+                , _value(this, 0)
+            {
+            }
+
+            auto column(std::size_t i) const noexcept
+                -> expected<batch_column const *, error>
+            {
+                if (i >= _table->num_columns())
+                    return make_unexpected(bad_column());
+                return &_table->column(i);
+            }
+
+            auto column_count() -> std::size_t override
+            {
+                return _table->num_columns();
+            }
+
+            auto get_value(std::size_t column) noexcept
+                -> expected<value_handle, error> override
+            try {
+                return std::make_unique<value>(this, column);
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+
+            auto value_at(std::size_t column) noexcept
+                -> expected<db::value *, error> override
+            {
+                _value._column = column;
+                return &_value;
+            }
+
+            auto is_null(std::size_t i) noexcept
+                -> expected<bool, error> override
+            {
+                auto c = column(i);
+                if (!c)
+                    return make_unexpected(c.error());
+                return (*c)->is_null(_index);
+            }
+
+            auto get_int64(std::size_t i) noexcept
+                -> expected<std::int64_t, error> override
+            {
+                auto c = column(i);
+                if (!c)
+                    return make_unexpected(c.error());
+
+                if ((*c)->is_null(_index))
+                    return make_unexpected(bad_column());
+
+                switch ((*c)->type()) {
+                case column_type::int64:
+                    return (*c)->int64s()[_index];
+                case column_type::boolean:
+                    return (*c)->booleans().test(_index) ? 1 : 0;
+                default:
+                    return make_unexpected(bad_column());
+                }
+            }
+
+            auto get_double(std::size_t i) noexcept
+                -> expected<double, error> override
+            {
+                auto c = column(i);
+                if (!c)
+                    return make_unexpected(c.error());
+
+                if ((*c)->is_null(_index))
+                    return make_unexpected(bad_column());
+
+                switch ((*c)->type()) {
+                case column_type::float64:
+                    return (*c)->doubles()[_index];
+                case column_type::int64:
+                    return static_cast<double>((*c)->int64s()[_index]);
+                default:
+                    return make_unexpected(bad_column());
+                }
+            }
+
+            // Only utf8 columns can be read as text.
+            auto get_string_view(std::size_t i) noexcept
+                -> expected<std::u16string_view, error> override
+            try {
+                auto c = column(i);
+                if (!c)
+                    return make_unexpected(c.error());
+
+                if ((*c)->is_null(_index) ||
+                    (*c)->type() != column_type::utf8)
+                    return make_unexpected(bad_column());
+
+                utf8_to_utf16((*c)->string_at(_index), _text);
+                return std::u16string_view(_text);
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+
+            auto get_datum(std::size_t i) noexcept
+                -> expected<datum, error> override
+            {
+                return value(this, i).as_datum();
+            }
+        };
+
+        auto value::as_datum() const noexcept -> expected<datum, error>
+        try {
+            auto c = _row->column(_column);
+            if (!c)
+                return make_unexpected(c.error());
+            return (*c)->value(_row->_index);
+        } catch (...) {
+            return make_unexpected(make_error(std::current_exception()));
+        }
+
+        // Only utf8 and binary columns can be streamed.
+        auto value::open_stream() noexcept
+            -> expected<std::unique_ptr<pmrichannel<std::byte>>, error>
+        try {
+            auto c = _row->column(_column);
+            if (!c)
+                return make_unexpected(c.error());
+
+            auto type = (*c)->type();
+            if (type != column_type::utf8 && type != column_type::binary)
+                return make_unexpected(bad_column());
+
+            auto bytes = std::span<std::byte const>();
+            if (!(*c)->is_null(_row->_index))
+                bytes = std::as_bytes(std::span((*c)->string_at(_row->_index)));
+
+            return std::make_unique<bytes_channel>(bytes);
+        } catch (...) {
+            return make_unexpected(make_error(std::current_exception()));
+        }
+
+        class result_set final : public db::result_set {
+            table_handle _table;
+            std::size_t _next = 0;
+            row _row;
+
+        public:
+            explicit result_set(table_handle table)
+                : _table(std::move(table))
+                , _row(_table.get())
+            {
+            }
+
+            auto column_count() -> std::size_t override
+            {
+                return _table->num_columns();
+            }
+
+            auto get_next_row() noexcept
+                -> expected<row_handle, error> override
+            try {
+                if (_next >= _table->num_rows())
+                    return make_unexpected(make_error<end_of_data>());
+
+                return std::make_unique<row>(_table.get(), _next++);
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+
+            auto next_row() noexcept -> expected<db::row *, error> override
+            {
+                if (_next >= _table->num_rows())
+                    return make_unexpected(make_error<end_of_data>());
+
+                _row._index = _next++;
+                return &_row;
+            }
+
+            auto next_batch(record_batch &batch, std::size_t max_rows) noexcept
+                -> expected<std::size_t, error> override
+            try {
+                auto ncolumns = _table->num_columns();
+
+                bool same = batch.num_columns() == ncolumns;
+                for (std::size_t i = 0; same && i < ncolumns; ++i)
+                    same = batch.column(i).type() ==
+                               _table->column(i).type() &&
+                           batch.name(i) == _table->name(i);
+
+                if (same)
+                    batch.clear();
+                else {
+                    batch.reset();
+                    for (std::size_t i = 0; i < ncolumns; ++i)
+                        batch.add_column(_table->name(i),
+                                         _table->column(i).type());
+                }
+
+                auto n = std::min(max_rows, _table->num_rows() - _next);
+                for (std::size_t i = 0; i < ncolumns; ++i) {
+                    auto &to = batch.column(i);
+                    auto const &from = _table->column(i);
+
+                    to.reserve(n);
+                    for (std::size_t r = _next; r < _next + n; ++r)
+                        append_value(to, from, r);
+                }
+
+                _next += n;
+                return n;
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+        };
+
+        class query_result final : public db::query_result {
+            table_handle _table;
+            bool _first = true;
+
+        public:
+            explicit query_result(table_handle table)
+                : _table(std::move(table))
+            {
+            }
+
+            auto has_data() const -> bool override
+            {
+                return true;
+            }
+
+            auto get_next_result_set() noexcept
+                -> expected<result_set_handle, error> override
+            try {
+                if (!std::exchange(_first, false))
+                    return make_unexpected(make_error<end_of_data>());
+
+                return std::make_unique<result_set>(_table);
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+        };
+
+        class query final : public db::query {
+            table_handle _table;
+
+        public:
+            explicit query(table_handle table)
+                : _table(std::move(table))
+            {
+            }
+
+            auto execute() noexcept
+                -> expected<query_result_handle, error> override
+            try {
+                return std::make_unique<query_result>(_table);
+            } catch (...) {
+                return make_unexpected(make_error(std::current_exception()));
+            }
+
+            auto bind(std::size_t, datum const &) noexcept
+                -> expected<void, error> override
+            {
+                return make_unexpected(make_error(std::errc::not_supported));
+            }
+
+            auto bind_array(std::size_t, std::span<datum const>) noexcept
+                -> expected<void, error> override
+            {
+                return make_unexpected(make_error(std::errc::not_supported));
+            }
+
+            auto clear_bindings() noexcept -> void override {}
+        };
+
+    } // namespace
+
+    /*************************************************************************
+     *
+     * database
+     */
+
+    auto database::add_table(u16string const &name, record_batch table)
+        -> void
+    {
+        _tables[to_key(name)] =
+            std::make_shared<record_batch const>(std::move(table));
+    }
+
+    auto database::find_table(u16string const &name) const -> table_handle
+    {
+        if (auto it = _tables.find(to_key(name)); it != _tables.end())
+            return it->second;
+        return nullptr;
+    }
+
+    /*************************************************************************
+     *
+     * connection
+     */
+
+    connection::connection(std::shared_ptr<database const> database)
+        : _database(std::move(database))
+    {
+    }
+
+    auto connection::prepare_query(u16string const &text) noexcept
+        -> expected<query_handle, error>
+    try {
+        if (!_database)
+            return make_unexpected(
+                make_error<connection_error>("not connected"));
+
+        auto table = _database->find_table(text);
+        if (!table)
+            return make_unexpected(
+                make_error<query_execution_error>("no such table"));
+
+        return std::make_unique<query>(std::move(table));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto connection::disconnect() -> void
+    {
+        _database.reset();
+    }
+
+    auto connection::is_alive() noexcept -> bool
+    {
+        return _database != nullptr;
+    }
+
+    auto connect(std::shared_ptr<database const> database) noexcept
+        -> expected<db::connection_handle, error>
+    try {
+        return std::make_unique<connection>(std::move(database));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    /*************************************************************************
+     *
+     * generate_table
+     */
+
+    namespace {
+
+        // splitmix64, which is plenty for deciding which rows are null.
+        auto next_random(std::uint64_t &state) -> std::uint64_t
+        {
+            auto z = (state += 0x9E3779B97F4A7C15);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            return z ^ (z >> 31);
+        }
+
+        auto append_generated(batch_column &column, std::size_t row) -> void
+        {
+            auto i = static_cast<std::int64_t>(row);
+
+            switch (column.type()) {
+            case column_type::null:
+                column.append_null();
+                break;
+
+            case column_type::boolean:
+                column.append_boolean(i % 2 == 0);
+                break;
+
+            case column_type::int64:
+                column.append_int64(i);
+                break;
+
+            case column_type::float64:
+                column.append_double(static_cast<double>(i) / 2);
+                break;
+
+            case column_type::date32:
+                column.append_date(std::chrono::sys_days(
+                    std::chrono::days(static_cast<int>(i % 36525))));
+                break;
+
+            case column_type::timestamp_us:
+                column.append_timestamp(
+                    std::chrono::sys_time<std::chrono::microseconds>(
+                        std::chrono::seconds(i)));
+                break;
+
+            case column_type::utf8:
+                column.append_utf8("row " + std::to_string(i));
+                break;
+
+            case column_type::binary: {
+                std::byte bytes[8];
+                for (int b = 0; b < 8; ++b)
+                    bytes[b] = static_cast<std::byte>(
+                        static_cast<std::uint64_t>(i) >> (8 * b));
+                column.append_binary(bytes);
+                break;
+            }
+            }
+        }
+
+    } // namespace
+
+    auto generate_table(std::span<column_spec const> columns,
+                        std::size_t nrows,
+                        std::uint64_t seed) -> record_batch
+    {
+        record_batch table;
+        std::uint64_t state = seed;
+
+        // The top 53 bits of a random number as a fraction in [0, 1).
+        constexpr double scale = 1.0 / double(std::uint64_t(1) << 53);
+
+        for (auto &&spec : columns) {
+            auto &column = table.add_column(spec.name, spec.type);
+            column.reserve(nrows);
+
+            for (std::size_t i = 0; i < nrows; ++i) {
+                auto r = static_cast<double>(next_random(state) >> 11) * scale;
+                if (r < spec.null_ratio)
+                    column.append_null();
+                else
+                    append_generated(column, i);
+            }
+        }
+
+        return table;
+    }
+
+} // namespace ivy::db::memory
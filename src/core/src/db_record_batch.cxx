@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <ivy/charenc/utf.hxx>
+#include <ivy/check.hxx>
+#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/bytes.hxx>
+#include <ivy/datum/date.hxx>
+#include <ivy/datum/double.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/datum/timestamp.hxx>
+#include <ivy/db/record_batch.hxx>
+
+namespace ivy::db {
+
+    namespace {
+
+        // Decode UTF-8 which was given to append_utf8(), or encoded by
+        // append_utf16() or append_utf32().
+        auto utf8_to_string(std::string_view s) -> string
+        {
+            std::vector<char32_t> chars;
+            chars.reserve(s.size());
+            decode_utf8(s, [&](char32_t c) { chars.push_back(c); });
+            return string(chars.begin(), chars.end());
+        }
+
+    } // namespace
+
+    auto column_type_name(column_type type) noexcept -> char const *
+    {
+        switch (type) {
+        case column_type::null:
+            return "null";
+        case column_type::boolean:
+            return "bool";
+        case column_type::int64:
+            return "int64";
+        case column_type::float64:
+            return "double";
+        case column_type::date32:
+            return "date32";
+        case column_type::timestamp_us:
+            return "timestamp[us]";
+        case column_type::utf8:
+            return "utf8";
+        case column_type::binary:
+            return "binary";
+        }
+
+        return "unknown";
+    }
+
+    /*************************************************************************
+     *
+     * batch_column
+     */
+
+    batch_column::batch_column(column_type type)
+        : _type(type)
+    {
+    }
+
+    auto batch_column::clear() noexcept -> void
+    {
+        _size = 0;
+        _validity.resize(0);
+        _booleans.resize(0);
+        _int64s.clear();
+        _doubles.clear();
+        _int32s.clear();
+        _offsets.resize(1);
+        _data.clear();
+    }
+
+    auto batch_column::reserve(std::size_t n) -> void
+    {
+        switch (_type) {
+        case column_type::int64:
+        case column_type::timestamp_us:
+            _int64s.reserve(n);
+            break;
+        case column_type::float64:
+            _doubles.reserve(n);
+            break;
+        case column_type::date32:
+            _int32s.reserve(n);
+            break;
+        case column_type::utf8:
+        case column_type::binary:
+            _offsets.reserve(n + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto batch_column::append_valid() -> void
+    {
+        _validity.push_back(true);
+        ++_size;
+    }
+
+    // Finish a string value whose bytes have been added to _data.
+    auto batch_column::end_string() -> void
+    {
+        constexpr auto max_size = static_cast<std::size_t>(
+            std::numeric_limits<std::int32_t>::max());
+
+        if (_data.size() > max_size) {
+            _data.resize(static_cast<std::size_t>(_offsets.back()));
+            throw std::length_error("batch_column: string data exceeds 2GB");
+        }
+
+        _offsets.push_back(static_cast<std::int32_t>(_data.size()));
+        append_valid();
+    }
+
+    auto batch_column::append_null() -> void
+    {
+        switch (_type) {
+        case column_type::boolean:
+            _booleans.push_back(false);
+            break;
+        case column_type::int64:
+        case column_type::timestamp_us:
+            _int64s.push_back(0);
+            break;
+        case column_type::float64:
+            _doubles.push_back(0);
+            break;
+        case column_type::date32:
+            _int32s.push_back(0);
+            break;
+        case column_type::utf8:
+        case column_type::binary:
+            _offsets.push_back(_offsets.back());
+            break;
+        default:
+            break;
+        }
+
+        _validity.push_back(false);
+        ++_size;
+    }
+
+    auto batch_column::append_boolean(bool value) -> void
+    {
+        if (_type != column_type::boolean)
+            throw bad_datum_cast();
+
+        _booleans.push_back(value);
+        append_valid();
+    }
+
+    auto batch_column::append_int64(std::int64_t value) -> void
+    {
+        if (_type != column_type::int64)
+            throw bad_datum_cast();
+
+        _int64s.push_back(value);
+        append_valid();
+    }
+
+    auto batch_column::append_double(double value) -> void
+    {
+        if (_type != column_type::float64)
+            throw bad_datum_cast();
+
+        _doubles.push_back(value);
+        append_valid();
+    }
+
+    auto batch_column::append_date(std::chrono::sys_days value) -> void
+    {
+        if (_type != column_type::date32)
+            throw bad_datum_cast();
+
+        _int32s.push_back(
+            static_cast<std::int32_t>(value.time_since_epoch().count()));
+        append_valid();
+    }
+
+    auto batch_column::append_timestamp(
+        std::chrono::sys_time<std::chrono::microseconds> value) -> void
+    {
+        if (_type != column_type::timestamp_us)
+            throw bad_datum_cast();
+
+        _int64s.push_back(value.time_since_epoch().count());
+        append_valid();
+    }
+
+    auto batch_column::append_utf8(std::string_view value) -> void
+    {
+        if (_type != column_type::utf8)
+            throw bad_datum_cast();
+
+        _data.insert(_data.end(), value.begin(), value.end());
+        end_string();
+    }
+
+    auto batch_column::append_utf16(std::u16string_view value) -> void
+    {
+        if (_type != column_type::utf8)
+            throw bad_datum_cast();
+
+        decode_utf16(value, [&](char32_t c) {
+            encode_utf8(c, std::back_inserter(_data));
+        });
+
+        end_string();
+    }
+
+    auto batch_column::append_utf32(std::u32string_view value) -> void
+    {
+        if (_type != column_type::utf8)
+            throw bad_datum_cast();
+
+        for (auto c : value)
+            encode_utf8(c, std::back_inserter(_data));
+
+        end_string();
+    }
+
+    auto batch_column::append_binary(std::span<std::byte const> value)
+        -> void
+    {
+        if (_type != column_type::binary)
+            throw bad_datum_cast();
+
+        auto old_size = _data.size();
+        _data.resize(old_size + value.size());
+        if (!value.empty())
+            std::memcpy(_data.data() + old_size, value.data(), value.size());
+        end_string();
+    }
+
+    auto batch_column::append(datum const &value) -> void
+    {
+        switch (value.get_kind()) {
+        case datum::kind::null:
+            append_null();
+            break;
+
+        case datum::kind::boolean:
+            append_boolean(datum_cast<bool>(value));
+            break;
+
+        case datum::kind::integer:
+            append_int64(datum_cast<std::int64_t>(value));
+            break;
+
+        case datum::kind::real:
+            append_double(datum_cast<double>(value));
+            break;
+
+        case datum::kind::date:
+            append_date(datum_cast<std::chrono::sys_days>(value));
+            break;
+
+        case datum::kind::timestamp:
+            append_timestamp(
+                datum_cast<std::chrono::sys_time<std::chrono::microseconds>>(
+                    value));
+            break;
+
+        case datum::kind::string: {
+            auto const *s = datum_cast<string>(&value);
+            append_utf32(std::u32string_view(s->data(), s->size()));
+            break;
+        }
+
+        case datum::kind::bytes:
+            append_binary(*datum_cast<std::vector<std::byte>>(&value));
+            break;
+
+        default:
+            throw bad_datum_cast();
+        }
+    }
+
+    auto batch_column::value(std::size_t i) const -> datum
+    {
+        IVY_CHECK(i < _size, "batch_column::value: index out of range");
+
+        if (is_null(i))
+            return make_null_datum();
+
+        switch (_type) {
+        case column_type::boolean:
+            return make_boolean_datum(_booleans.test(i));
+        case column_type::int64:
+            return make_integer_datum(_int64s[i]);
+        case column_type::float64:
+            return make_double_datum(_doubles[i]);
+        case column_type::date32:
+            return make_date_datum(
+                std::chrono::sys_days(std::chrono::days(_int32s[i])));
+        case column_type::timestamp_us:
+            return make_timestamp_datum(
+                std::chrono::sys_time<std::chrono::microseconds>(
+                    std::chrono::microseconds(_int64s[i])));
+        case column_type::utf8:
+            return make_string_datum(utf8_to_string(string_at(i)));
+        case column_type::binary: {
+            auto s = string_at(i);
+            auto const *p = reinterpret_cast<std::byte const *>(s.data());
+            return make_bytes_datum(std::span(p, s.size()));
+        }
+        default:
+            return make_null_datum();
+        }
+    }
+
+    /*************************************************************************
+     *
+     * record_batch
+     */
+
+    auto record_batch::add_column(std::string name, column_type type)
+        -> batch_column &
+    {
+        _names.push_back(std::move(name));
+        try {
+            return _columns.emplace_back(type);
+        } catch (...) {
+            _names.pop_back();
+            throw;
+        }
+    }
+
+    auto record_batch::reset() noexcept -> void
+    {
+        _names.clear();
+        _columns.clear();
+    }
+
+    auto record_batch::clear() noexcept -> void
+    {
+        for (auto &&column : _columns)
+            column.clear();
+    }
+
+} // namespace ivy::db
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <array>
+#include <charconv>
+#include <system_error>
+
+#include <ivy/check.hxx>
+#include <ivy/decimal.hxx>
+
+namespace ivy {
+
+    namespace {
+
+        // A 128-bit magnitude as 32-bit limbs, least significant first, so
+        // the arithmetic needs no 128-bit integer type.
+        using decimal_limbs = std::array<std::uint32_t, 4>;
+
+        auto to_limbs(std::uint64_t high, std::uint64_t low) -> decimal_limbs
+        {
+            return {static_cast<std::uint32_t>(low),
+                    static_cast<std::uint32_t>(low >> 32),
+                    static_cast<std::uint32_t>(high),
+                    static_cast<std::uint32_t>(high >> 32)};
+        }
+
+        // v = v * m + a.  Returns the carry out of the top limb.
+        auto mul_add(decimal_limbs &v, std::uint32_t m, std::uint32_t a)
+            -> std::uint32_t
+        {
+            std::uint64_t carry = a;
+
+            for (auto &limb : v) {
+                auto t = std::uint64_t(limb) * m + carry;
+                limb = static_cast<std::uint32_t>(t);
+                carry = t >> 32;
+            }
+
+            return static_cast<std::uint32_t>(carry);
+        }
+
+        // v = v / d.  Returns the remainder.
+        auto div_mod(decimal_limbs &v, std::uint32_t d) -> std::uint32_t
+        {
+            std::uint64_t rem = 0;
+
+            for (auto i = v.size(); i-- > 0;) {
+                auto t = (rem << 32) | v[i];
+                v[i] = static_cast<std::uint32_t>(t / d);
+                rem = t % d;
+            }
+
+            return static_cast<std::uint32_t>(rem);
+        }
+
+        auto limbs_zero(decimal_limbs const &v) -> bool
+        {
+            return (v[0] | v[1] | v[2] | v[3]) == 0;
+        }
+
+        // Remove trailing zeros after the decimal point.
+        auto normalise(decimal_limbs &v, unsigned &scale) -> void
+        {
+            while (scale > 0) {
+                auto q = v;
+                if (div_mod(q, 10) != 0)
+                    break;
+                v = q;
+                --scale;
+            }
+        }
+
+    } // namespace
+
+    decimal::decimal(std::int64_t unscaled, unsigned scale)
+        : _high(0)
+        , _low(unscaled < 0 ? 0 - static_cast<std::uint64_t>(unscaled)
+                            : static_cast<std::uint64_t>(unscaled))
+        , _scale(static_cast<std::uint8_t>(scale))
+        , _negative(unscaled < 0)
+    {
+        IVY_CHECK(scale <= max_digits, "decimal: scale is too large");
+    }
+
+    decimal::decimal(bool negative,
+                     std::uint64_t high,
+                     std::uint64_t low,
+                     unsigned scale)
+        : _high(high)
+        , _low(low)
+        , _scale(static_cast<std::uint8_t>(scale))
+        , _negative(negative)
+    {
+        IVY_CHECK(scale <= max_digits, "decimal: scale is too large");
+    }
+
+    auto decimal::parse(std::string_view s) -> expected<decimal, error>
+    {
+        decimal_limbs v{};
+        bool negative = false;
+        bool point = false;
+        bool any_digits = false;
+        unsigned digits = 0;
+        unsigned scale = 0;
+
+        std::size_t i = 0;
+        if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+            negative = (s[i++] == '-');
+
+        for (; i < s.size(); ++i) {
+            auto c = s[i];
+
+            if (c == '.' && !point) {
+                point = true;
+                continue;
+            }
+
+            if (c < '0' || c > '9')
+                return make_unexpected(make_error(std::errc::invalid_argument));
+
+            any_digits = true;
+
+            // Leading zeros don't count towards the precision.
+            if (digits || c != '0')
+                ++digits;
+
+            if (point)
+                ++scale;
+
+            if (digits > max_digits || scale > max_digits)
+                return make_unexpected(
+                    make_error(std::errc::result_out_of_range));
+
+            mul_add(v, 10, static_cast<std::uint32_t>(c - '0'));
+        }
+
+        if (!any_digits)
+            return make_unexpected(make_error(std::errc::invalid_argument));
+
+        return decimal(negative,
+                       (std::uint64_t(v[3]) << 32) | v[2],
+                       (std::uint64_t(v[1]) << 32) | v[0],
+                       scale);
+    }
+
+    auto decimal::str() const -> std::string
+    {
+        auto v = to_limbs(_high, _low);
+
+        // Digits, least significant first.
+        std::string digits;
+        do {
+            digits.push_back(static_cast<char>('0' + div_mod(v, 10)));
+        } while (!limbs_zero(v));
+
+        while (digits.size() <= _scale)
+            digits.push_back('0');
+
+        std::string ret;
+        if (_negative && !is_zero())
+            ret.push_back('-');
+
+        for (auto i = digits.size(); i-- > 0;) {
+            ret.push_back(digits[i]);
+            if (i == _scale && i != 0)
+                ret.push_back('.');
+        }
+
+        return ret;
+    }
+
+    auto decimal::to_double() const -> double
+    {
+        // Go through the text form, so the result is correctly rounded.
+        auto s = str();
+        double d = 0;
+        std::from_chars(s.data(), s.data() + s.size(), d);
+        return d;
+    }
+
+    auto operator==(decimal const &a, decimal const &b) noexcept -> bool
+    {
+        auto av = to_limbs(a._high, a._low);
+        auto bv = to_limbs(b._high, b._low);
+
+        if (limbs_zero(av) || limbs_zero(bv))
+            return limbs_zero(av) && limbs_zero(bv);
+
+        if (a._negative != b._negative)
+            return false;
+
+        unsigned ascale = a._scale, bscale = b._scale;
+        normalise(av, ascale);
+        normalise(bv, bscale);
+        return ascale == bscale && av == bv;
+    }
+
+} // namespace ivy
@@ -3,12 +3,27 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <mutex>
 #include <syncstream>
+#include <thread>
+#include <variant>
 
 #include <ivy/check.hxx>
 #include <ivy/log.hxx>
+#include <ivy/log/json_sink.hxx>
+#include <ivy/log/logfmt_sink.hxx>
 #include <ivy/log/ostream_sink.hxx>
+#include <ivy/metrics.hxx>
+#include <ivy/mpmc_queue.hxx>
+#include <ivy/scope_guard.hxx>
 
 namespace ivy::log {
 
@@ -18,8 +33,6 @@ namespace ivy::log {
         return &global_logger;
     }
 
-    logger::logger() = default;
-
     auto str(severity_code sev) -> std::string_view {
         using namespace std::string_view_literals;
 
@@ -40,32 +53,830 @@ namespace ivy::log {
         return severity_names[isev];
     }
 
+    namespace detail {
+
+        /*********************************************************************
+         *
+         * Field encoding.  Each field is stored as its key, the index of the
+         * value's type in field_value, and the value, all encoded the same
+         * way as captured arguments.
+         */
+
+        auto encoded_fields_size(std::span<field const> fields) noexcept
+            -> std::size_t
+        {
+            std::size_t size = 0;
+
+            for (auto &&f : fields) {
+                size += encoded_size(f.key) + sizeof(std::uint8_t);
+                size += std::visit(
+                    [](auto const &v) { return encoded_size(v); }, f.value);
+            }
+
+            return size;
+        }
+
+        auto encode_fields(std::byte *out,
+                           std::span<field const> fields) noexcept -> void
+        {
+            for (auto &&f : fields) {
+                auto index = static_cast<std::uint8_t>(f.value.index());
+                encode_argument(out, f.key);
+                encode_argument(out, index);
+                std::visit([&](auto const &v) { encode_argument(out, v); },
+                           f.value);
+            }
+        }
+
+        template <std::size_t I = 0>
+        auto decode_field_value(std::size_t index, std::byte const *&in)
+            -> field_value
+        {
+            if constexpr (I < std::variant_size_v<field_value>) {
+                using type = std::variant_alternative_t<I, field_value>;
+
+                if (index == I)
+                    return field_value(std::in_place_index<I>,
+                                       decode_argument<type>(in));
+
+                return decode_field_value<I + 1>(index, in);
+            } else {
+                IVY_CHECK(false, "log: invalid field type");
+                return {};
+            }
+        }
+
+        auto decode_fields(std::byte const *in,
+                           std::size_t count,
+                           std::vector<field> &out) -> void
+        {
+            for (std::size_t i = 0; i < count; ++i) {
+                auto key = decode_argument<std::string_view>(in);
+                auto index = decode_argument<std::uint8_t>(in);
+                out.push_back(field{key, decode_field_value(index, in)});
+            }
+        }
+
+        // Format a captured message.  A bad format specification is reported
+        // in the message rather than thrown, since by this point there is
+        // nobody to throw to.
+        auto format_captured(std::string &text,
+                             format_function format,
+                             std::string_view format_string,
+                             std::byte const *arguments) -> void
+        {
+            auto size = text.size();
+
+            try {
+                format(text, format_string, arguments);
+            } catch (std::exception const &e) {
+                text.resize(size);
+                std::format_to(std::back_inserter(text),
+                               "{} [format error: {}]",
+                               format_string,
+                               e.what());
+            }
+        }
+
+        /*********************************************************************
+         *
+         * queued_record: a record waiting in the async queue.  The payload is
+         * either the message text, or the captured arguments of a message
+         * which has not been formatted yet, followed by the encoded fields.
+         * Small payloads are stored inline so that queueing a record does not
+         * allocate.
+         */
+
+        constexpr std::size_t queued_record_inline_size = 192;
+
+        class queued_record {
+            std::chrono::system_clock::time_point _timestamp;
+            severity_code _severity = severity_code::none;
+            format_function _format = nullptr;
+            std::string_view _format_string;
+            std::size_t _size = 0;
+            std::size_t _message_size = 0;
+            std::size_t _field_count = 0;
+            std::unique_ptr<std::byte[]> _overflow;
+            std::array<std::byte, queued_record_inline_size> _inline;
+
+            // Allocate the payload and encode the fields; returns where the
+            // message should be written.
+            auto allocate(std::size_t message_size,
+                          std::span<field const> fields) -> std::byte *
+            {
+                _message_size = message_size;
+                _field_count = fields.size();
+                _size = message_size + encoded_fields_size(fields);
+
+                auto *data = _inline.data();
+                if (_size > _inline.size()) {
+                    _overflow = std::make_unique<std::byte[]>(_size);
+                    data = _overflow.get();
+                }
+
+                encode_fields(data + message_size, fields);
+                return data;
+            }
+
+            [[nodiscard]] auto payload() const noexcept -> std::byte const *
+            {
+                return _overflow ? _overflow.get() : _inline.data();
+            }
+
+        public:
+            queued_record() noexcept = default;
+
+            queued_record(std::chrono::system_clock::time_point timestamp,
+                          severity_code severity,
+                          std::string_view message,
+                          std::span<field const> fields)
+                : _timestamp(timestamp)
+                , _severity(severity)
+            {
+                std::memcpy(allocate(message.size(), fields),
+                            message.data(),
+                            message.size());
+            }
+
+            queued_record(std::chrono::system_clock::time_point timestamp,
+                          severity_code severity,
+                          captured_message const &message,
+                          std::span<field const> fields)
+                : _timestamp(timestamp)
+                , _severity(severity)
+                , _format(message.format)
+                , _format_string(message.format_string)
+            {
+                message.encode(allocate(message.size, fields),
+                               message.arguments);
+            }
+
+            queued_record(queued_record &&other) noexcept
+            {
+                *this = std::move(other);
+            }
+
+            auto operator=(queued_record &&other) noexcept -> queued_record &
+            {
+                _timestamp = other._timestamp;
+                _severity = other._severity;
+                _format = other._format;
+                _format_string = other._format_string;
+                _size = other._size;
+                _message_size = other._message_size;
+                _field_count = other._field_count;
+                _overflow = std::move(other._overflow);
+
+                if (!_overflow)
+                    std::memcpy(_inline.data(), other._inline.data(), _size);
+
+                return *this;
+            }
+
+            [[nodiscard]] auto timestamp() const noexcept
+                -> std::chrono::system_clock::time_point
+            {
+                return _timestamp;
+            }
+
+            [[nodiscard]] auto severity() const noexcept -> severity_code
+            {
+                return _severity;
+            }
+
+            // Append the message text to 'text'.
+            auto format(std::string &text) const -> void
+            {
+                if (!_format) {
+                    text.append(reinterpret_cast<char const *>(payload()),
+                                _message_size);
+                    return;
+                }
+
+                format_captured(text, _format, _format_string, payload());
+            }
+
+            // Append the fields to 'out'.  String values refer to the
+            // payload.
+            auto fields(std::vector<field> &out) const -> void
+            {
+                decode_fields(payload() + _message_size, _field_count, out);
+            }
+        };
+
+        /*********************************************************************
+         *
+         * async_dispatcher: owns the record queue and the logging thread.
+         */
+
+        class async_dispatcher {
+            logger *_logger;
+            async_options _options;
+            mpmc_queue<queued_record> _queue;
+
+            // Records reserved for the queue, and records either written or
+            // discarded; flush() waits for the second to catch up.  A record
+            // is reserved before it's published, so a record can't be written
+            // (and counted) before the records which were queued ahead of it
+            // have been reserved.
+            std::atomic<std::uint64_t> _accepted{0};
+            std::atomic<std::uint64_t> _completed{0};
+            std::atomic<std::uint64_t> _dropped{0};
+
+            std::atomic<bool> _stopping{false};
+            std::atomic<bool> _sleeping{false};
+            std::mutex _wake_mutex;
+            std::condition_variable _wake;
+            std::condition_variable _progress;
+
+            std::thread _thread;
+
+            auto run() -> void;
+            auto wake() -> void;
+            auto count_dropped() noexcept -> void;
+            auto withdraw() noexcept -> void;
+
+        public:
+            async_dispatcher(logger *, async_options const &);
+            ~async_dispatcher();
+
+            template <typename Message>
+            auto enqueue(severity_code severity,
+                         Message const &message,
+                         std::span<field const> fields) -> void;
+            auto flush() -> void;
+
+            [[nodiscard]] auto dropped() const noexcept -> std::uint64_t
+            {
+                return _dropped.load(std::memory_order_relaxed);
+            }
+        };
+
+        async_dispatcher::async_dispatcher(logger *logger,
+                                           async_options const &options)
+            : _logger(logger)
+            , _options(options)
+            , _queue(options.queue_size)
+        {
+            if (_options.max_batch == 0)
+                _options.max_batch = 1;
+
+            _thread = std::thread([this] { run(); });
+        }
+
+        async_dispatcher::~async_dispatcher()
+        {
+            _stopping.store(true);
+            wake();
+            _thread.join();
+        }
+
+        auto async_dispatcher::wake() -> void
+        {
+            std::lock_guard lock(_wake_mutex);
+            _wake.notify_one();
+        }
+
+        auto async_dispatcher::count_dropped() noexcept -> void
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+
+            // Registering the metric can throw; dropped() still has the
+            // count if it does.
+            try {
+                static auto &dropped_metric =
+                    metrics::get_global_registry()->get_counter(
+                        "ivy_log_dropped_records_total",
+                        "Log records discarded because the queue was full.");
+
+                dropped_metric.add();
+            } catch (...) {
+            }
+        }
+
+        // Give back the reservation for a record which was dropped before it
+        // was queued, and let flush() see that it isn't coming.
+        auto async_dispatcher::withdraw() noexcept -> void
+        {
+            _accepted.fetch_sub(1);
+
+            try {
+                std::lock_guard lock(_wake_mutex);
+                _progress.notify_all();
+            } catch (...) {
+                // flush() still sees the change the next time it wakes.
+            }
+        }
+
+        template <typename Message>
+        auto async_dispatcher::enqueue(severity_code severity,
+                                       Message const &message,
+                                       std::span<field const> fields) -> void
+        {
+            auto timestamp = std::chrono::system_clock::now();
+            _accepted.fetch_add(1);
+
+            for (;;) {
+                if (_queue.try_emplace(timestamp, severity, message, fields))
+                    break;
+
+                switch (_options.overflow) {
+                case overflow_policy::drop:
+                    count_dropped();
+                    withdraw();
+                    return;
+
+                case overflow_policy::drop_oldest:
+                    if (_queue.try_discard()) {
+                        count_dropped();
+                        _completed.fetch_add(1);
+                    }
+                    break;
+
+                case overflow_policy::block:
+                    wake();
+                    std::this_thread::yield();
+                    break;
+                }
+            }
+
+            // Only take the lock if the logging thread is asleep; otherwise
+            // it will find the record on its next pass.
+            if (_sleeping.load())
+                wake();
+        }
+
+        auto async_dispatcher::flush() -> void
+        {
+            auto target = _accepted.load();
+            wake();
+
+            std::unique_lock lock(_wake_mutex);
+            // Records reserved before 'target' was read may since have been
+            // dropped, so never wait for more than are still reserved.
+            _progress.wait(lock, [&] {
+                return _completed.load() >= std::min(target, _accepted.load());
+            });
+        }
+
+        auto async_dispatcher::run() -> void
+        {
+            std::vector<queued_record> queued(_options.max_batch);
+            std::vector<std::size_t> ends(_options.max_batch);
+            std::vector<std::size_t> field_ends(_options.max_batch);
+            std::vector<record> batch;
+            std::vector<field> fields;
+            std::string text;
+            batch.reserve(_options.max_batch);
+
+            for (;;) {
+                std::size_t n = 0;
+                while (n < queued.size() && _queue.try_pop(queued[n]))
+                    ++n;
+
+                if (n > 0) {
+                    // Format the whole batch into one buffer first, since
+                    // growing it would invalidate the records' messages.
+                    text.clear();
+                    fields.clear();
+                    for (std::size_t i = 0; i < n; ++i) {
+                        queued[i].format(text);
+                        ends[i] = text.size();
+                        queued[i].fields(fields);
+                        field_ends[i] = fields.size();
+                    }
+
+                    batch.clear();
+                    std::size_t start = 0, field_start = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        batch.push_back(record{
+                            queued[i].timestamp(),
+                            queued[i].severity(),
+                            std::string_view(text).substr(start,
+                                                          ends[i] - start),
+                            std::span<field const>(fields).subspan(
+                                field_start, field_ends[i] - field_start)});
+                        start = ends[i];
+                        field_start = field_ends[i];
+                    }
+
+                    _logger->dispatch(batch);
+
+                    _completed.fetch_add(n);
+                    std::lock_guard lock(_wake_mutex);
+                    _progress.notify_all();
+                    continue;
+                }
+
+                if (_stopping.load())
+                    break;
+
+                std::unique_lock lock(_wake_mutex);
+                _sleeping.store(true);
+                _wake.wait_for(lock, _options.flush_interval, [&] {
+                    return _stopping.load() || !_queue.empty_approx();
+                });
+                _sleeping.store(false);
+            }
+
+            std::lock_guard lock(_wake_mutex);
+            _progress.notify_all();
+        }
+
+    } // namespace detail
+
+    /*************************************************************************
+     *
+     * logger
+     */
+
+    logger::logger() = default;
+
+    logger::~logger()
+    {
+        stop_async();
+    }
+
     auto logger::log_message(severity_code severity,
-                             std::string_view message) -> void
+                             std::string_view message,
+                             std::span<field const> fields) -> void
+    {
+        if (!is_enabled(severity))
+            return;
+
+        if (_async) {
+            _async->enqueue(severity, message, fields);
+            return;
+        }
+
+        record r{std::chrono::system_clock::now(), severity, message, fields};
+        dispatch(std::span(&r, 1));
+    }
+
+    auto logger::log_captured(severity_code severity,
+                              detail::captured_message const &message) -> void
+    {
+        if (!is_enabled(severity))
+            return;
+
+        if (_async) {
+            _async->enqueue(severity, message, message.fields);
+            return;
+        }
+
+        // Encode the arguments on the stack unless they're unusually large.
+        std::array<std::byte, detail::queued_record_inline_size> inline_args;
+        std::unique_ptr<std::byte[]> overflow_args;
+        auto *arguments = inline_args.data();
+        if (message.size > inline_args.size()) {
+            overflow_args = std::make_unique<std::byte[]>(message.size);
+            arguments = overflow_args.get();
+        }
+
+        message.encode(arguments, message.arguments);
+
+        // Reuse this thread's buffer for the text, unless a formatter or a
+        // sink has logged while we're already using it.
+        thread_local std::string thread_text;
+        thread_local bool thread_text_busy = false;
+
+        std::string local_text;
+        auto &text = thread_text_busy ? local_text : thread_text;
+        auto was_busy = std::exchange(thread_text_busy, true);
+        scope_guard release([&] { thread_text_busy = was_busy; });
+
+        text.clear();
+        detail::format_captured(
+            text, message.format, message.format_string, arguments);
+        log_message(severity, text, message.fields);
+    }
+
+    namespace {
+
+        // The logger whose sinks this thread is calling, if any.
+        thread_local logger const *dispatching_logger = nullptr;
+
+    } // namespace
+
+    auto logger::dispatch(std::span<record const> records) -> void
+    {
+        {
+            dispatching_logger = this;
+            scope_guard reset([] { dispatching_logger = nullptr; });
+            dispatch_locked(records);
+        }
+
+        // A sink changed its minimum severity during the batch.
+        if (_threshold_stale.exchange(false))
+            update_threshold();
+    }
+
+    auto logger::dispatch_locked(std::span<record const> records) -> void
     {
+        std::shared_lock lock(_mutex);
+
         if (_loggers.empty()) {
-            std::cerr << message << '\n';
+            std::string text;
+            for (auto &&r : records) {
+                text.append(r.message);
+                text.push_back('\n');
+            }
+
+            std::cerr.write(text.data(),
+                            static_cast<std::streamsize>(text.size()));
             return;
         }
 
-        auto timestamp = std::chrono::system_clock::now();
+        std::vector<record> filtered;
 
-        for (auto &&logger : _loggers)
-            logger->log_message(timestamp, severity, message);
+        for (auto &&logger : _loggers) {
+            auto min = logger->min_severity();
+            if (min == severity_code::none) {
+                logger->log_records(records);
+                continue;
+            }
+
+            filtered.clear();
+            std::ranges::copy_if(
+                records, std::back_inserter(filtered), [&](auto const &r) {
+                    return r.severity >= min;
+                });
+
+            if (!filtered.empty())
+                logger->log_records(filtered);
+        }
     }
 
     auto logger::add_sink(std::unique_ptr<sink> &&s) -> void
     {
+        std::unique_lock lock(_mutex);
+        s->_logger = this;
         _loggers.push_back(std::move(s));
+        update_threshold_locked();
+    }
+
+    auto logger::set_min_severity(severity_code severity) -> void
+    {
+        _min_severity.store(severity, std::memory_order_relaxed);
+        update_threshold();
+    }
+
+    auto logger::update_threshold() -> void
+    {
+        std::unique_lock lock(_mutex);
+        update_threshold_locked();
+    }
+
+    auto logger::update_threshold_locked() -> void
+    {
+        // With no sinks, messages go to std::cerr and only the logger's
+        // own minimum applies.
+        auto threshold = severity_code::last;
+        if (_loggers.empty())
+            threshold = severity_code::none;
+
+        for (auto &&logger : _loggers)
+            threshold = std::min(threshold, logger->min_severity());
+
+        threshold = std::max(threshold, min_severity());
+        _threshold.store(threshold, std::memory_order_relaxed);
+    }
+
+    auto logger::start_async(async_options const &options) -> void
+    {
+        if (_async)
+            return;
+
+        _async = std::make_unique<detail::async_dispatcher>(this, options);
+    }
+
+    auto logger::stop_async() -> void
+    {
+        // The dispatcher's destructor drains the queue before the thread
+        // exits.
+        _async.reset();
+    }
+
+    auto logger::flush() -> void
+    {
+        if (_async)
+            _async->flush();
     }
 
+    auto logger::dropped_records() const noexcept -> std::uint64_t
+    {
+        return _async ? _async->dropped() : 0;
+    }
+
+    /*************************************************************************
+     *
+     * sink
+     */
+
     sink::~sink() = default;
 
+    auto sink::set_min_severity(severity_code severity) -> void
+    {
+        _min_severity.store(severity, std::memory_order_relaxed);
+
+        if (!_logger)
+            return;
+
+        // The logger's lock is already held while it calls its sinks.
+        if (dispatching_logger == _logger)
+            _logger->_threshold_stale = true;
+        else
+            _logger->update_threshold();
+    }
+
+    auto sink::log_records(std::span<record const> records) -> void
+    {
+        for (auto &&r : records)
+            log_message(r.timestamp, r.severity, r.message);
+    }
+
+    /*************************************************************************
+     *
+     * Text formatting shared by the sinks.
+     */
+
+    auto format_field_value(std::string &out, field_value const &value)
+        -> void
+    {
+        std::visit(
+            [&](auto const &v) {
+                using type = std::remove_cvref_t<decltype(v)>;
+
+                if constexpr (std::same_as<type, std::string_view>)
+                    out.append(v);
+                else
+                    std::format_to(std::back_inserter(out), "{}", v);
+            },
+            value);
+    }
+
+    namespace detail {
+
+        auto append_json_string(std::string &out, std::string_view s) -> void
+        {
+            out.push_back('"');
+
+            for (char c : s) {
+                switch (c) {
+                case '"':
+                case '\\':
+                    out.push_back('\\');
+                    out.push_back(c);
+                    break;
+
+                case '\n':
+                    out.append("\\n");
+                    break;
+
+                case '\r':
+                    out.append("\\r");
+                    break;
+
+                case '\t':
+                    out.append("\\t");
+                    break;
+
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        std::format_to(std::back_inserter(out),
+                                       "\\u{:04x}",
+                                       static_cast<unsigned>(c));
+                    else
+                        out.push_back(c);
+                    break;
+                }
+            }
+
+            out.push_back('"');
+        }
+
+    } // namespace detail
+
+    namespace {
+
+        // Append a string, quoting it if it contains anything that would
+        // confuse a logfmt parser.
+        auto append_logfmt_string(std::string &out, std::string_view s)
+            -> void
+        {
+            auto needs_quotes =
+                s.empty() || std::ranges::any_of(s, [](char c) {
+                    return c <= ' ' || c == '=' || c == '"' || c == '\\';
+                });
+
+            if (!needs_quotes) {
+                out.append(s);
+                return;
+            }
+
+            out.push_back('"');
+
+            for (char c : s) {
+                switch (c) {
+                case '"':
+                case '\\':
+                    out.push_back('\\');
+                    out.push_back(c);
+                    break;
+
+                case '\n':
+                    out.append("\\n");
+                    break;
+
+                case '\r':
+                    out.append("\\r");
+                    break;
+
+                case '\t':
+                    out.append("\\t");
+                    break;
+
+                default:
+                    out.push_back(c);
+                    break;
+                }
+            }
+
+            out.push_back('"');
+        }
+
+        auto append_logfmt_fields(std::string &out,
+                                  std::span<field const> fields) -> void
+        {
+            for (auto &&f : fields) {
+                out.push_back(' ');
+                append_logfmt_string(out, f.key);
+                out.push_back('=');
+
+                if (auto s = std::get_if<std::string_view>(&f.value))
+                    append_logfmt_string(out, *s);
+                else
+                    format_field_value(out, f.value);
+            }
+        }
+
+        auto append_json_value(std::string &out, field_value const &value)
+            -> void
+        {
+            std::visit(
+                [&](auto const &v) {
+                    using type = std::remove_cvref_t<decltype(v)>;
+                    auto it = std::back_inserter(out);
+
+                    if constexpr (std::same_as<type, std::string_view>)
+                        detail::append_json_string(out, v);
+                    else if constexpr (std::same_as<type,
+                                                    std::chrono::nanoseconds>)
+                        std::format_to(it, "{}", v.count());
+                    else if constexpr (std::same_as<type, double>) {
+                        if (std::isfinite(v))
+                            std::format_to(it, "{}", v);
+                        else
+                            out.append("null");
+                    } else
+                        std::format_to(it, "{}", v);
+                },
+                value);
+        }
+
+        // Write a batch of text in one operation, so it isn't interleaved
+        // with other output to the same stream.
+        auto write_stream(std::ostream &stream, std::string_view text) -> void
+        {
+            std::osyncstream strm(stream);
+            strm.write(text.data(), static_cast<std::streamsize>(text.size()));
+            strm << std::flush;
+        }
+
+    } // namespace
+
     /*************************************************************************
      *
      * ostream_sink
      */
 
+    namespace {
+
+        auto format_record(std::string &text, record const &r) -> void
+        {
+            std::format_to(std::back_inserter(text),
+                           "{} | {} | {}",
+                           r.timestamp,
+                           str(r.severity),
+                           r.message);
+
+            append_logfmt_fields(text, r.fields);
+            text.push_back('\n');
+        }
+
+    } // namespace
+
     ostream_sink::ostream_sink(std::ostream &stream) : _stream(stream) {}
 
     auto
@@ -73,8 +884,24 @@ namespace ivy::log {
                               severity_code severity,
                               std::string_view message) -> void
     {
-        auto text = std::format("{} | {} | {}", timestamp, str(severity), message);
-        std::osyncstream(_stream) << text << std::endl;
+        std::string text;
+        format_record(text, record{timestamp, severity, message});
+        write(text);
+    }
+
+    auto ostream_sink::log_records(std::span<record const> records) -> void
+    {
+        std::string text;
+        for (auto &&r : records)
+            format_record(text, r);
+
+        write(text);
+    }
+
+    auto ostream_sink::write(std::string_view text) -> void
+    {
+        // One write and one flush for the whole batch.
+        write_stream(_stream, text);
     }
 
     auto make_ostream_sink(std::ostream &strm) -> std::unique_ptr<ostream_sink>
@@ -82,4 +909,88 @@ namespace ivy::log {
         return std::make_unique<ostream_sink>(strm);
     }
 
-    } // namespace ivy::log
+    /*************************************************************************
+     *
+     * logfmt_sink
+     */
+
+    logfmt_sink::logfmt_sink(std::ostream &stream) : _stream(stream) {}
+
+    auto
+    logfmt_sink::log_message(std::chrono::system_clock::time_point timestamp,
+                             severity_code severity,
+                             std::string_view message) -> void
+    {
+        record r{timestamp, severity, message};
+        log_records(std::span(&r, 1));
+    }
+
+    auto logfmt_sink::log_records(std::span<record const> records) -> void
+    {
+        std::lock_guard lock(_mutex);
+        _buffer.clear();
+
+        for (auto &&r : records) {
+            std::format_to(std::back_inserter(_buffer),
+                           "time={:%FT%TZ} level={} msg=",
+                           r.timestamp,
+                           str(r.severity));
+            append_logfmt_string(_buffer, r.message);
+            append_logfmt_fields(_buffer, r.fields);
+            _buffer.push_back('\n');
+        }
+
+        write_stream(_stream, _buffer);
+    }
+
+    auto make_logfmt_sink(std::ostream &strm) -> std::unique_ptr<logfmt_sink>
+    {
+        return std::make_unique<logfmt_sink>(strm);
+    }
+
+    /*************************************************************************
+     *
+     * json_sink
+     */
+
+    json_sink::json_sink(std::ostream &stream) : _stream(stream) {}
+
+    auto json_sink::log_message(std::chrono::system_clock::time_point timestamp,
+                                severity_code severity,
+                                std::string_view message) -> void
+    {
+        record r{timestamp, severity, message};
+        log_records(std::span(&r, 1));
+    }
+
+    auto json_sink::log_records(std::span<record const> records) -> void
+    {
+        std::lock_guard lock(_mutex);
+        _buffer.clear();
+
+        for (auto &&r : records) {
+            std::format_to(std::back_inserter(_buffer),
+                           R"({{"time":"{:%FT%TZ}","level":"{}","msg":)",
+                           r.timestamp,
+                           str(r.severity));
+            detail::append_json_string(_buffer, r.message);
+
+            for (auto &&f : r.fields) {
+                _buffer.push_back(',');
+                detail::append_json_string(_buffer, f.key);
+                _buffer.push_back(':');
+                append_json_value(_buffer, f.value);
+            }
+
+            _buffer.append("}\n");
+        }
+
+        write_stream(_stream, _buffer);
+    }
+
+    auto make_json_sink(std::ostream &strm) -> std::unique_ptr<json_sink>
+    {
+        return std::make_unique<json_sink>(strm);
+    }
+
+} // namespace ivy::log
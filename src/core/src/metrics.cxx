@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <ostream>
+
+#include <ivy/check.hxx>
+#include <ivy/metrics.hxx>
+
+namespace ivy::metrics {
+
+    namespace detail {
+
+        auto this_thread_shard() noexcept -> std::size_t
+        {
+            static std::atomic<std::size_t> next_shard{0};
+            thread_local std::size_t shard =
+                next_shard.fetch_add(1, std::memory_order_relaxed) %
+                shard_count;
+            return shard;
+        }
+
+    } // namespace detail
+
+    /*************************************************************************
+     *
+     * counter
+     */
+
+    auto counter::value() const noexcept -> std::uint64_t
+    {
+        std::uint64_t total = 0;
+
+        for (auto &&s : _shards)
+            total += s.value.load(std::memory_order_relaxed);
+
+        return total;
+    }
+
+    /*************************************************************************
+     *
+     * histogram
+     */
+
+    auto histogram_snapshot::quantile(double q) const noexcept
+        -> std::uint64_t
+    {
+        if (_count == 0)
+            return 0;
+
+        q = std::clamp(q, 0.0, 1.0);
+
+        // The rank of the value we want, counting from 1.
+        auto rank = static_cast<std::uint64_t>(
+            std::ceil(q * static_cast<double>(_count)));
+        rank = std::clamp<std::uint64_t>(rank, 1, _count);
+
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < _buckets.size(); ++i) {
+            seen += _buckets[i];
+            if (seen >= rank)
+                return detail::histogram_bucket_upper(i);
+        }
+
+        // Only reachable if the counts were updated while the snapshot was
+        // being taken, so that _count is ahead of the buckets.
+        return detail::histogram_bucket_upper(_buckets.size() - 1);
+    }
+
+    auto histogram_snapshot::merge(histogram_snapshot const &other) noexcept
+        -> void
+    {
+        for (std::size_t i = 0; i < _buckets.size(); ++i)
+            _buckets[i] += other._buckets[i];
+
+        _count += other._count;
+        _sum += other._sum;
+    }
+
+    auto histogram::snapshot() const -> histogram_snapshot
+    {
+        histogram_snapshot ret;
+
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            auto &s = _shards[i];
+
+            for (std::size_t b = 0; b < s.buckets.size(); ++b)
+                ret._buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+
+            ret._sum += s.sum.load(std::memory_order_relaxed);
+        }
+
+        // Use the bucket counts for the total, so the snapshot is
+        // consistent even if values were recorded while we were reading.
+        for (auto n : ret._buckets)
+            ret._count += n;
+
+        return ret;
+    }
+
+    /*************************************************************************
+     *
+     * registry
+     */
+
+    template <typename T>
+    auto registry::get(std::string_view name, std::string_view help) -> T &
+    {
+        std::lock_guard lock(_mutex);
+
+        auto it = _metrics.find(name);
+
+        if (it == _metrics.end())
+            it = _metrics
+                     .emplace(std::string(name),
+                              entry{std::string(help), std::make_unique<T>()})
+                     .first;
+
+        IVY_CHECK(std::holds_alternative<std::unique_ptr<T>>(it->second.value),
+                  "metrics: metric registered with a different type");
+
+        return *std::get<std::unique_ptr<T>>(it->second.value);
+    }
+
+    auto registry::get_counter(std::string_view name, std::string_view help)
+        -> counter &
+    {
+        return get<counter>(name, help);
+    }
+
+    auto registry::get_gauge(std::string_view name, std::string_view help)
+        -> gauge &
+    {
+        return get<gauge>(name, help);
+    }
+
+    auto registry::get_histogram(std::string_view name, std::string_view help)
+        -> histogram &
+    {
+        return get<histogram>(name, help);
+    }
+
+    namespace {
+
+        auto write_header(std::string &out,
+                          std::string const &name,
+                          std::string const &help,
+                          std::string_view type) -> void
+        {
+            auto it = std::back_inserter(out);
+
+            if (!help.empty())
+                std::format_to(it, "# HELP {} {}\n", name, help);
+
+            std::format_to(it, "# TYPE {} {}\n", name, type);
+        }
+
+    } // namespace
+
+    auto registry::text() const -> std::string
+    {
+        static constexpr std::array quantiles{0.5, 0.9, 0.99, 0.999};
+
+        std::string out;
+        auto it = std::back_inserter(out);
+
+        std::lock_guard lock(_mutex);
+
+        for (auto &&[name, e] : _metrics) {
+            if (auto c = std::get_if<std::unique_ptr<counter>>(&e.value)) {
+                write_header(out, name, e.help, "counter");
+                std::format_to(it, "{} {}\n", name, (*c)->value());
+            } else if (auto g = std::get_if<std::unique_ptr<gauge>>(&e.value)) {
+                write_header(out, name, e.help, "gauge");
+                std::format_to(it, "{} {}\n", name, (*g)->value());
+            } else if (auto h =
+                           std::get_if<std::unique_ptr<histogram>>(&e.value)) {
+                auto snap = (*h)->snapshot();
+
+                write_header(out, name, e.help, "summary");
+
+                for (auto q : quantiles)
+                    std::format_to(it,
+                                   "{}{{quantile=\"{}\"}} {}\n",
+                                   name,
+                                   q,
+                                   snap.quantile(q));
+
+                std::format_to(it, "{}_sum {}\n", name, snap.sum());
+                std::format_to(it, "{}_count {}\n", name, snap.count());
+            }
+        }
+
+        return out;
+    }
+
+    auto registry::write_text(std::ostream &strm) const -> void
+    {
+        auto s = text();
+        strm.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    auto get_global_registry() -> registry *
+    {
+        static registry global_registry;
+        return &global_registry;
+    }
+
+} // namespace ivy::metrics
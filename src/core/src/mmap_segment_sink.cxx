@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <ivy/log/mmap_segment_sink.hxx>
+#include <ivy/log/segment.hxx>
+
+namespace ivy::log {
+
+    namespace {
+
+        constexpr std::string_view segment_extension = ".ivylog";
+
+        // The smallest segment we'll create, so there is always room for
+        // the header and a reasonable record.
+        constexpr std::size_t min_segment_size = 4096;
+
+        // If 'filename' is <name>.<sequence>.ivylog, return the sequence.
+        auto parse_segment_name(std::string_view name,
+                                std::string_view filename)
+            -> std::optional<std::uint64_t>
+        {
+            if (!filename.starts_with(name))
+                return {};
+            filename.remove_prefix(name.size());
+
+            if (!filename.starts_with('.'))
+                return {};
+            filename.remove_prefix(1);
+
+            if (!filename.ends_with(segment_extension))
+                return {};
+            filename.remove_suffix(segment_extension.size());
+
+            if (filename.empty())
+                return {};
+
+            std::uint64_t sequence{};
+            auto *end = filename.data() + filename.size();
+            auto [p, ec] = std::from_chars(filename.data(), end, sequence);
+            if (ec != std::errc() || p != end)
+                return {};
+
+            return sequence;
+        }
+
+        auto field_value_size(field_value const &value) -> std::size_t
+        {
+            return std::visit(
+                [](auto const &v) -> std::size_t {
+                    if constexpr (std::same_as<std::remove_cvref_t<decltype(v)>,
+                                               std::string_view>)
+                        return v.size();
+                    else
+                        return sizeof(v);
+                },
+                value);
+        }
+
+        auto fields_size(std::span<field const> fields) -> std::size_t
+        {
+            std::size_t size = 0;
+
+            for (auto &&f : fields)
+                size += sizeof(segment_field_header) + f.key.size() +
+                        field_value_size(f.value);
+
+            return size;
+        }
+
+        auto write_fields(std::byte *out, std::span<field const> fields)
+            -> void
+        {
+            for (auto &&f : fields) {
+                segment_field_header header{};
+                header.key_size = static_cast<std::uint16_t>(f.key.size());
+                header.type = static_cast<std::uint8_t>(f.value.index());
+                header.value_size =
+                    static_cast<std::uint32_t>(field_value_size(f.value));
+
+                std::memcpy(out, &header, sizeof(header));
+                out += sizeof(header);
+
+                std::memcpy(out, f.key.data(), f.key.size());
+                out += f.key.size();
+
+                std::visit(
+                    [&](auto const &v) {
+                        if constexpr (std::same_as<
+                                          std::remove_cvref_t<decltype(v)>,
+                                          std::string_view>)
+                            std::memcpy(out, v.data(), v.size());
+                        else
+                            std::memcpy(out, &v, sizeof(v));
+                    },
+                    f.value);
+                out += header.value_size;
+            }
+        }
+
+        template <std::size_t I = 0>
+        auto read_field_value(std::size_t type, std::string_view bytes)
+            -> std::optional<field_value>
+        {
+            if constexpr (I < std::variant_size_v<field_value>) {
+                using value_type = std::variant_alternative_t<I, field_value>;
+
+                if (type != I)
+                    return read_field_value<I + 1>(type, bytes);
+
+                if constexpr (std::same_as<value_type, std::string_view>) {
+                    return field_value(std::in_place_index<I>, bytes);
+                } else {
+                    if (bytes.size() != sizeof(value_type))
+                        return {};
+
+                    value_type v;
+                    std::memcpy(&v, bytes.data(), sizeof(v));
+                    return field_value(std::in_place_index<I>, v);
+                }
+            } else {
+                return {};
+            }
+        }
+
+    } // namespace
+
+    /*************************************************************************
+     *
+     * mmap_segment_sink
+     */
+
+    mmap_segment_sink::mmap_segment_sink(mmap_segment_options options)
+        : _options(std::move(options))
+    {
+        _options.segment_size = segment_padded_size(
+            std::max(_options.segment_size, min_segment_size));
+    }
+
+    mmap_segment_sink::~mmap_segment_sink()
+    {
+        std::lock_guard lock(_mutex);
+        close_segment();
+    }
+
+    auto mmap_segment_sink::segment_path(std::uint64_t sequence) const
+        -> std::filesystem::path
+    {
+        return _options.directory / std::format("{}.{:08}{}",
+                                                _options.name,
+                                                sequence,
+                                                segment_extension);
+    }
+
+    auto mmap_segment_sink::open() -> expected<void, error>
+    {
+        std::lock_guard lock(_mutex);
+
+        std::vector<std::pair<std::uint64_t, std::filesystem::path>> found;
+        std::error_code ec;
+
+        for (std::filesystem::directory_iterator it(_options.directory, ec),
+             end;
+             !ec && it != end;
+             it.increment(ec)) {
+            auto filename = it->path().filename().string();
+            if (auto seq = parse_segment_name(_options.name, filename))
+                found.emplace_back(*seq, it->path());
+        }
+
+        if (ec)
+            return make_unexpected(make_error(ec));
+
+        std::ranges::sort(found);
+
+        _segments.clear();
+        for (auto &&[seq, path] : found) {
+            _segments.push_back(path);
+            _sequence = seq;
+        }
+
+        return open_segment();
+    }
+
+    auto mmap_segment_sink::open_segment() -> expected<void, error>
+    {
+        std::filesystem::path path;
+
+        for (;;) {
+            auto sequence = _sequence + 1;
+            path = segment_path(sequence);
+
+            auto segment = create_mapped_file(path, _options.segment_size);
+            if (segment) {
+                _segment = std::move(*segment);
+                _sequence = sequence;
+                break;
+            }
+
+            if (segment.error() != std::errc::file_exists)
+                return make_unexpected(segment.error());
+
+            // Another writer has created this segment since we last looked,
+            // so move on to the next one rather than retrying it forever.
+            _sequence = sequence;
+        }
+
+        segment_header header{};
+        header.magic = segment_magic;
+        header.version = segment_version;
+        header.header_size = sizeof(header);
+        header.sequence = _sequence;
+        std::memcpy(_segment.data().data(), &header, sizeof(header));
+        _offset = segment_padded_size(sizeof(header));
+
+        _segments.push_back(std::move(path));
+
+        if (_options.max_segments > 0) {
+            while (_segments.size() > _options.max_segments) {
+                std::error_code ec;
+                std::filesystem::remove(_segments.front(), ec);
+                _segments.pop_front();
+            }
+        }
+
+        return {};
+    }
+
+    auto mmap_segment_sink::close_segment() -> void
+    {
+        if (_segment.is_open())
+            (void)_segment.close(_offset);
+    }
+
+    auto mmap_segment_sink::write(record const &r) -> void
+    {
+        auto message = r.message;
+        auto fields = r.fields;
+        auto fields_bytes = fields_size(fields);
+
+        // Keys are limited to 64k, and the fields must leave room for the
+        // message; if not, drop them rather than the message.
+        if (fields.size() > 0xFFFF ||
+            std::ranges::any_of(fields,
+                                [](auto const &f) {
+                                    return f.key.size() > 0xFFFF;
+                                }) ||
+            sizeof(segment_record_header) + fields_bytes >
+                _options.segment_size / 2) {
+            fields = {};
+            fields_bytes = 0;
+        }
+
+        auto size = segment_padded_size(sizeof(segment_record_header) +
+                                        message.size() + fields_bytes);
+
+        if (!_segment.is_open() || _offset + size > _segment.size()) {
+            close_segment();
+
+            if (!open_segment()) {
+                _lost.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        // A record larger than a whole segment is truncated.
+        auto available = _segment.size() - _offset;
+        if (size > available) {
+            message = message.substr(
+                0, available - sizeof(segment_record_header) - fields_bytes);
+            size = segment_padded_size(sizeof(segment_record_header) +
+                                       message.size() + fields_bytes);
+        }
+
+        auto *out = _segment.data().data() + _offset;
+
+        segment_record_header header{};
+        header.size = static_cast<std::uint32_t>(size);
+        header.severity = static_cast<std::uint8_t>(r.severity);
+        header.field_count = static_cast<std::uint16_t>(fields.size());
+        header.timestamp =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                r.timestamp.time_since_epoch())
+                .count();
+        header.message_size = static_cast<std::uint32_t>(message.size());
+
+        // Write the header last: a reader stops at the first header with a
+        // size of zero, so it never sees a partially written record.
+        std::memcpy(out + sizeof(header), message.data(), message.size());
+        write_fields(out + sizeof(header) + message.size(), fields);
+        std::memcpy(out, &header, sizeof(header));
+
+        _offset += size;
+    }
+
+    auto mmap_segment_sink::log_message(
+        std::chrono::system_clock::time_point timestamp,
+        severity_code severity,
+        std::string_view message) -> void
+    {
+        std::lock_guard lock(_mutex);
+        write(record{timestamp, severity, message});
+    }
+
+    auto mmap_segment_sink::log_records(std::span<record const> records)
+        -> void
+    {
+        std::lock_guard lock(_mutex);
+
+        for (auto &&r : records)
+            write(r);
+    }
+
+    auto make_mmap_segment_sink(mmap_segment_options const &options)
+        -> expected<std::unique_ptr<mmap_segment_sink>, error>
+    {
+        auto sink = std::make_unique<mmap_segment_sink>(options);
+
+        if (auto r = sink->open(); !r)
+            return make_unexpected(r.error());
+
+        return sink;
+    }
+
+    /*************************************************************************
+     *
+     * segment_reader
+     */
+
+    segment_reader::segment_reader(std::span<std::byte const> data)
+        : _data(data)
+    {
+    }
+
+    auto segment_reader::open() -> expected<void, error>
+    {
+        segment_header header;
+
+        if (_data.size() < sizeof(header))
+            return make_unexpected(make_error<segment_error>(
+                "log segment: truncated header"));
+
+        std::memcpy(&header, _data.data(), sizeof(header));
+
+        if (header.magic != segment_magic)
+            return make_unexpected(
+                make_error<segment_error>("log segment: bad magic number"));
+
+        if (header.version != segment_version)
+            return make_unexpected(make_error<segment_error>(std::format(
+                "log segment: unsupported version {}", header.version)));
+
+        if (header.header_size < sizeof(header) ||
+            header.header_size > _data.size())
+            return make_unexpected(
+                make_error<segment_error>("log segment: bad header size"));
+
+        _sequence = header.sequence;
+        _offset = segment_padded_size(header.header_size);
+        return {};
+    }
+
+    auto segment_reader::next() -> expected<segment_record, error>
+    {
+        segment_record_header header;
+
+        if (_offset + sizeof(header) > _data.size())
+            return make_unexpected(make_error(errc::end_of_file));
+
+        std::memcpy(&header, _data.data() + _offset, sizeof(header));
+
+        if (header.size == 0)
+            return make_unexpected(make_error(errc::end_of_file));
+
+        auto corrupt = [&](std::string_view what) {
+            return make_unexpected(make_error<segment_error>(std::format(
+                "log segment: {} in record at offset {}", what, _offset)));
+        };
+
+        if (header.size < sizeof(header) ||
+            header.size > _data.size() - _offset)
+            return corrupt("bad record size");
+
+        if (header.severity >= static_cast<std::uint8_t>(severity_code::last))
+            return corrupt("bad severity");
+
+        auto body = _data.subspan(_offset + sizeof(header),
+                                  header.size - sizeof(header));
+
+        auto take = [&](std::size_t n) -> std::string_view {
+            auto s = std::string_view(
+                reinterpret_cast<char const *>(body.data()), n);
+            body = body.subspan(n);
+            return s;
+        };
+
+        if (header.message_size > body.size())
+            return corrupt("bad message size");
+
+        segment_record r;
+        r.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(header.timestamp)));
+        r.severity = static_cast<severity_code>(header.severity);
+        r.message = take(header.message_size);
+
+        for (unsigned i = 0; i < header.field_count; ++i) {
+            segment_field_header field{};
+
+            if (body.size() < sizeof(field))
+                return corrupt("truncated field");
+
+            std::memcpy(&field, body.data(), sizeof(field));
+            body = body.subspan(sizeof(field));
+
+            if (std::size_t(field.key_size) + field.value_size > body.size())
+                return corrupt("bad field size");
+
+            auto key = take(field.key_size);
+            auto value = read_field_value(field.type, take(field.value_size));
+            if (!value)
+                return corrupt("bad field value");
+
+            r.fields.push_back(log::field{key, *value});
+        }
+
+        _offset += header.size;
+        return r;
+    }
+
+} // namespace ivy::log
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ivy/io/mapped_file.hxx>
+
+namespace ivy {
+
+    namespace {
+
+        auto last_error() -> std::error_code
+        {
+            return {errno, std::generic_category()};
+        }
+
+    } // namespace
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+        : _fd(std::exchange(other._fd, -1))
+        , _data(std::exchange(other._data, nullptr))
+        , _size(std::exchange(other._size, 0))
+    {
+    }
+
+    auto mapped_file::operator=(mapped_file &&other) noexcept -> mapped_file &
+    {
+        if (this != &other) {
+            close();
+            _fd = std::exchange(other._fd, -1);
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    auto mapped_file::unmap() noexcept -> void
+    {
+        if (_data)
+            ::munmap(_data, _size);
+
+        _data = nullptr;
+        _size = 0;
+    }
+
+    auto mapped_file::close() noexcept -> void
+    {
+        unmap();
+
+        if (_fd != -1)
+            ::close(_fd);
+
+        _fd = -1;
+    }
+
+    auto mapped_file::close(std::size_t size) -> expected<void, error>
+    {
+        unmap();
+
+        if (_fd == -1)
+            return {};
+
+        std::error_code ec;
+        if (::ftruncate(_fd, static_cast<off_t>(size)) != 0)
+            ec = last_error();
+
+        close();
+
+        if (ec)
+            return make_unexpected(make_error(ec));
+
+        return {};
+    }
+
+    auto create_mapped_file(std::filesystem::path const &path,
+                            std::size_t size) -> expected<mapped_file, error>
+    {
+        mapped_file file;
+
+        file._fd = ::open(
+            path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (file._fd == -1)
+            return make_unexpected(make_error(last_error()));
+
+        // Don't leave a file behind which the next attempt can't create.
+        auto fail = [&] {
+            auto ec = last_error();
+            file.close();
+            ::unlink(path.c_str());
+            return make_unexpected(make_error(ec));
+        };
+
+        if (::ftruncate(file._fd, static_cast<off_t>(size)) != 0)
+            return fail();
+
+        auto *data = ::mmap(
+            nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file._fd, 0);
+        if (data == MAP_FAILED)
+            return fail();
+
+        file._data = static_cast<std::byte *>(data);
+        file._size = size;
+        return file;
+    }
+
+    auto open_mapped_file(std::filesystem::path const &path)
+        -> expected<mapped_file, error>
+    {
+        mapped_file file;
+
+        file._fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file._fd == -1)
+            return make_unexpected(make_error(last_error()));
+
+        struct stat st {};
+        if (::fstat(file._fd, &st) != 0)
+            return make_unexpected(make_error(last_error()));
+
+        // An empty file can't be mapped.
+        if (st.st_size == 0)
+            return file;
+
+        auto size = static_cast<std::size_t>(st.st_size);
+        auto *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file._fd, 0);
+        if (data == MAP_FAILED)
+            return make_unexpected(make_error(last_error()));
+
+        file._data = static_cast<std::byte *>(data);
+        file._size = size;
+        return file;
+    }
+
+} // namespace ivy
@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ivy/log/json_sink.hxx>
+#include <ivy/trace.hxx>
+
+namespace ivy::detail {
+
+    namespace {
+
+        /*********************************************************************
+         *
+         * trace_slot: one event in a ring.  The sequence number is odd while
+         * the owning thread is writing the slot, so a reader can tell when it
+         * has copied a slot that was being overwritten.  A slot is two cache
+         * lines.
+         *
+         * For a message, the payload holds the encoded arguments.  A span
+         * has no format function; the format string is the span's name, the
+         * timestamp is when it began and the payload holds when it ended.
+         */
+
+        struct alignas(64) trace_slot {
+            std::atomic<std::uint64_t> sequence{0};
+            std::int64_t timestamp = 0;
+            log::detail::format_function format = nullptr;
+            char const *format_string = nullptr;
+            std::uint32_t format_size = 0;
+            std::uint16_t size = 0;
+            std::uint16_t thread = 0;
+            std::array<std::byte, 88> payload{};
+        };
+
+        static_assert(sizeof(trace_slot) == 128);
+
+        // Marks an event whose arguments didn't fit in the slot.
+        constexpr std::uint16_t oversized_event = 0xFFFF;
+
+        static_assert((trace_buffer_events & (trace_buffer_events - 1)) == 0,
+                      "trace_buffer_events must be a power of two");
+
+        /*********************************************************************
+         *
+         * trace_ring: the events of one thread.  Only the owning thread
+         * writes to the ring.  When the thread exits the ring is kept, with
+         * its events, and given to the next new thread.
+         */
+
+        struct trace_ring {
+            std::unique_ptr<trace_slot[]> slots =
+                std::make_unique<trace_slot[]>(trace_buffer_events);
+            std::uint64_t next = 0;
+            std::uint16_t thread = 0;
+
+            // Mark the next slot as being written and return it.
+            auto begin_slot() noexcept -> trace_slot &
+            {
+                auto &slot = slots[next & (trace_buffer_events - 1)];
+
+                slot.sequence.store(2 * next + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.thread = thread;
+                return slot;
+            }
+
+            auto commit_slot(trace_slot &slot) noexcept -> void
+            {
+                slot.sequence.store(2 * next + 2, std::memory_order_release);
+                ++next;
+            }
+
+            auto record(log::detail::captured_message const &message) noexcept
+                -> void
+            {
+                auto now = trace_clock();
+                auto &slot = begin_slot();
+
+                slot.timestamp = now;
+                slot.format = message.format;
+                slot.format_string = message.format_string.data();
+                slot.format_size =
+                    static_cast<std::uint32_t>(message.format_string.size());
+
+                if (message.size <= slot.payload.size()) {
+                    message.encode(slot.payload.data(), message.arguments);
+                    slot.size = static_cast<std::uint16_t>(message.size);
+                } else
+                    slot.size = oversized_event;
+
+                commit_slot(slot);
+            }
+
+            auto record_span(std::string_view name,
+                             std::int64_t start,
+                             std::int64_t end) noexcept -> void
+            {
+                auto &slot = begin_slot();
+
+                slot.timestamp = start;
+                slot.format = nullptr;
+                slot.format_string = name.data();
+                slot.format_size = static_cast<std::uint32_t>(name.size());
+                slot.size = sizeof(end);
+                std::memcpy(slot.payload.data(), &end, sizeof(end));
+
+                commit_slot(slot);
+            }
+        };
+
+        /*********************************************************************
+         *
+         * The registry of rings.
+         */
+
+        struct trace_registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<trace_ring>> rings;
+            std::vector<trace_ring *> free_rings;
+            std::uint16_t next_thread = 0;
+
+            auto acquire() -> trace_ring *
+            {
+                std::lock_guard lock(mutex);
+                trace_ring *ring;
+
+                if (!free_rings.empty()) {
+                    ring = free_rings.back();
+                    free_rings.pop_back();
+                } else
+                    ring = rings.emplace_back(std::make_unique<trace_ring>())
+                               .get();
+
+                ring->thread = ++next_thread;
+                return ring;
+            }
+
+            auto release(trace_ring *ring) -> void
+            {
+                std::lock_guard lock(mutex);
+                free_rings.push_back(ring);
+            }
+        };
+
+        // Never destroyed, so threads which exit after main() returns can
+        // still release their rings.
+        auto get_registry() -> trace_registry &
+        {
+            static auto *registry = new trace_registry;
+            return *registry;
+        }
+
+        struct thread_ring {
+            trace_ring *ring = get_registry().acquire();
+
+            thread_ring() = default;
+            thread_ring(thread_ring const &) = delete;
+            auto operator=(thread_ring const &) -> thread_ring & = delete;
+
+            ~thread_ring()
+            {
+                get_registry().release(ring);
+            }
+        };
+
+        auto this_thread_ring() -> trace_ring &
+        {
+            thread_local thread_ring ring;
+            return *ring.ring;
+        }
+
+        /*********************************************************************
+         *
+         * Dumping.
+         */
+
+        struct trace_event_copy {
+            std::int64_t timestamp;
+            log::detail::format_function format;
+            std::string_view format_string;
+            std::uint16_t size;
+            std::uint16_t thread;
+            std::array<std::byte, 88> payload;
+        };
+
+        // Copy a slot, or return false if it's empty or was being written.
+        auto copy_slot(trace_slot const &slot, trace_event_copy &event) -> bool
+        {
+            auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before == 0 || (before & 1) != 0)
+                return false;
+
+            event.timestamp = slot.timestamp;
+            event.format = slot.format;
+            event.format_string = {slot.format_string, slot.format_size};
+            event.size = slot.size;
+            event.thread = slot.thread;
+            event.payload = slot.payload;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.sequence.load(std::memory_order_relaxed) == before;
+        }
+
+        auto is_span(trace_event_copy const &event) -> bool
+        {
+            return event.format == nullptr;
+        }
+
+        auto span_end(trace_event_copy const &event) -> std::int64_t
+        {
+            std::int64_t end;
+            std::memcpy(&end, event.payload.data(), sizeof(end));
+            return end;
+        }
+
+        auto format_event(std::string &text, trace_event_copy const &event)
+            -> void
+        {
+            if (is_span(event)) {
+                std::format_to(std::back_inserter(text),
+                               "span {} {:.3f}us",
+                               event.format_string,
+                               double(span_end(event) - event.timestamp) /
+                                   1000);
+                return;
+            }
+
+            if (event.size == oversized_event) {
+                text.append(event.format_string);
+                text.append(" [arguments too large]");
+                return;
+            }
+
+            auto size = text.size();
+
+            try {
+                event.format(text, event.format_string, event.payload.data());
+            } catch (std::exception const &e) {
+                text.resize(size);
+                std::format_to(std::back_inserter(text),
+                               "{} [format error: {}]",
+                               event.format_string,
+                               e.what());
+            }
+        }
+
+        // Copy the events from every ring, sorted by timestamp.  When
+        // crashing, the registry mutex might be held by the thread that
+        // crashed, so don't wait for it.
+        auto collect_events(bool crashing) -> std::vector<trace_event_copy>
+        {
+            auto &registry = get_registry();
+            std::unique_lock lock(registry.mutex, std::defer_lock);
+
+            if (crashing) {
+                if (!lock.try_lock())
+                    return {};
+            } else
+                lock.lock();
+
+            std::vector<trace_event_copy> events;
+            trace_event_copy event;
+
+            for (auto &&ring : registry.rings)
+                for (std::size_t i = 0; i < trace_buffer_events; ++i)
+                    if (copy_slot(ring->slots[i], event))
+                        events.push_back(event);
+
+            lock.unlock();
+
+            std::ranges::sort(events, {}, &trace_event_copy::timestamp);
+            return events;
+        }
+
+        auto dump_events(std::ostream &strm, bool crashing) -> void
+        {
+            auto events = collect_events(crashing);
+
+            std::string text;
+            auto start = events.empty() ? 0 : events.front().timestamp;
+
+            for (auto &&e : events) {
+                auto us = (e.timestamp - start) / 1000;
+                std::format_to(std::back_inserter(text),
+                               "{:>6}.{:06} [{}] ",
+                               us / 1000000,
+                               us % 1000000,
+                               e.thread);
+                format_event(text, e);
+                text.push_back('\n');
+            }
+
+            strm.write(text.data(), static_cast<std::streamsize>(text.size()));
+            strm.flush();
+        }
+
+        /*
+         * Chrome trace event format: a JSON object whose traceEvents member
+         * is an array of events.  Timestamps are in microseconds, relative to
+         * the first event.
+         */
+        auto export_chrome(std::ostream &strm) -> void
+        {
+            auto events = collect_events(false);
+            auto start = events.empty() ? 0 : events.front().timestamp;
+
+            auto micros = [=](std::int64_t ns) {
+                return double(ns - start) / 1000;
+            };
+
+            std::string text("{\"traceEvents\":[");
+            std::string message;
+            bool first = true;
+
+            for (auto &&e : events) {
+                if (!first)
+                    text.push_back(',');
+                first = false;
+
+                text.append("\n{\"name\":");
+
+                if (is_span(e)) {
+                    log::detail::append_json_string(text, e.format_string);
+                    std::format_to(std::back_inserter(text),
+                                   ",\"cat\":\"ivy\",\"ph\":\"X\","
+                                   "\"ts\":{:.3f},\"dur\":{:.3f},",
+                                   micros(e.timestamp),
+                                   double(span_end(e) - e.timestamp) / 1000);
+                } else {
+                    message.clear();
+                    format_event(message, e);
+                    log::detail::append_json_string(text, message);
+                    std::format_to(std::back_inserter(text),
+                                   ",\"cat\":\"ivy\",\"ph\":\"i\","
+                                   "\"s\":\"t\",\"ts\":{:.3f},",
+                                   micros(e.timestamp));
+                }
+
+                std::format_to(std::back_inserter(text),
+                               "\"pid\":1,\"tid\":{}}}",
+                               e.thread);
+            }
+
+            text.append("\n]}\n");
+
+            strm.write(text.data(), static_cast<std::streamsize>(text.size()));
+            strm.flush();
+        }
+
+        /*********************************************************************
+         *
+         * Crash handling.  Formatting allocates, so this is not strictly
+         * safe in a signal handler; it's a best effort to get the trace out
+         * before the process goes away.
+         */
+
+        std::atomic_flag crash_dumped = ATOMIC_FLAG_INIT;
+        std::terminate_handler previous_terminate = nullptr;
+
+        constexpr std::array crash_signals{SIGSEGV, SIGABRT, SIGFPE, SIGILL};
+        std::array<void (*)(int), crash_signals.size()> previous_handlers{};
+
+        auto crash_dump() -> void
+        {
+            if (crash_dumped.test_and_set())
+                return;
+
+            std::cerr << "ivy: trace buffer at crash:\n";
+            dump_events(std::cerr, true);
+        }
+
+        extern "C" void trace_signal_handler(int sig)
+        {
+            crash_dump();
+
+            for (std::size_t i = 0; i < crash_signals.size(); ++i) {
+                if (crash_signals[i] == sig) {
+                    auto previous = previous_handlers[i];
+                    std::signal(sig, previous == SIG_ERR ? SIG_DFL : previous);
+                    break;
+                }
+            }
+
+            std::raise(sig);
+        }
+
+        auto trace_terminate_handler() -> void
+        {
+            crash_dump();
+
+            if (previous_terminate != nullptr)
+                previous_terminate();
+
+            std::abort();
+        }
+
+        auto install_crash_handlers() -> void
+        {
+            static std::once_flag installed;
+
+            std::call_once(installed, [] {
+                previous_terminate = std::set_terminate(trace_terminate_handler);
+
+                for (std::size_t i = 0; i < crash_signals.size(); ++i)
+                    previous_handlers[i] =
+                        std::signal(crash_signals[i], trace_signal_handler);
+            });
+        }
+
+        /*********************************************************************
+         *
+         * Print mode.
+         */
+
+        std::mutex print_guard;
+
+        auto print_message(log::detail::captured_message const &message)
+            -> void
+        {
+            std::vector<std::byte> arguments(message.size);
+            message.encode(arguments.data(), message.arguments);
+
+            std::string text;
+
+            try {
+                message.format(text, message.format_string, arguments.data());
+            } catch (std::exception const &e) {
+                text.clear();
+                std::format_to(std::back_inserter(text),
+                               "{} [format error: {}]",
+                               message.format_string,
+                               e.what());
+            }
+
+            text.push_back('\n');
+
+            std::lock_guard lock(print_guard);
+            std::cerr.write(text.data(),
+                            static_cast<std::streamsize>(text.size()));
+        }
+
+        auto print_span(std::string_view name, std::int64_t start) -> void
+        {
+            auto text = std::format("span {} {:.3f}us\n",
+                                    name,
+                                    double(trace_clock() - start) / 1000);
+
+            std::lock_guard lock(print_guard);
+            std::cerr.write(text.data(),
+                            static_cast<std::streamsize>(text.size()));
+        }
+
+        auto mode_from_environment() -> trace_mode
+        {
+#ifdef _WIN32
+            std::array<char, 16> buf{};
+            const char *s = buf.data();
+            size_t size{};
+            auto err = getenv_s(&size, buf.data(), buf.size(), "IVY_TRACE");
+            if (err != 0 || size == 0)
+                s = nullptr;
+#else
+            char const *s = std::getenv("IVY_TRACE");
+#endif
+            if (s == nullptr || *s == 0 || std::strcmp(s, "0") == 0)
+                return trace_mode::off;
+
+            if (std::strcmp(s, "print") == 0)
+                return trace_mode::print;
+
+            return trace_mode::buffer;
+        }
+
+    } // namespace
+
+    auto init_tracing() -> int
+    {
+        auto mode = static_cast<int>(mode_from_environment());
+        int state = 0;
+
+        if (!trace_state.compare_exchange_strong(state, mode))
+            return state;
+
+        if (mode == static_cast<int>(trace_mode::buffer))
+            install_crash_handlers();
+
+        return mode;
+    }
+
+    auto trace_message(log::detail::captured_message const &message) -> void
+    {
+        if (trace_state.load(std::memory_order_relaxed) ==
+            static_cast<int>(trace_mode::print))
+            print_message(message);
+        else
+            this_thread_ring().record(message);
+    }
+
+    auto trace_span_end(std::string_view name, std::int64_t start) noexcept
+        -> void
+    {
+        auto state = trace_state.load(std::memory_order_relaxed);
+
+        try {
+            if (state == static_cast<int>(trace_mode::buffer))
+                this_thread_ring().record_span(name, start, trace_clock());
+            else if (state == static_cast<int>(trace_mode::print))
+                print_span(name, start);
+        } catch (...) {
+            // A span ends in a destructor, which mustn't throw.
+        }
+    }
+
+} // namespace ivy::detail
+
+namespace ivy {
+
+    auto set_trace_mode(trace_mode mode) -> void
+    {
+        if (mode == trace_mode::buffer)
+            detail::install_crash_handlers();
+
+        detail::trace_state.store(static_cast<int>(mode),
+                                  std::memory_order_relaxed);
+    }
+
+    auto trace_dump(std::ostream &strm) -> void
+    {
+        detail::dump_events(strm, false);
+    }
+
+    auto trace_export_chrome(std::ostream &strm) -> void
+    {
+        detail::export_chrome(strm);
+    }
+
+} // namespace ivy
@@ -7,6 +7,7 @@
 #include <ivy/io/textchannel.hxx>
 #include <ivy/net/uri.hxx>
 #include <ivy/string/transcode.hxx>
+#include <ivy/trace.hxx>
 
 namespace ivy::net {
 
@@ -479,6 +480,8 @@ namespace ivy::net {
     auto parse_uri(u8string const &s, urioption::flagset options) noexcept
         -> expected<uri, std::error_code>
     {
+        IVY_SPAN("uri.parse");
+
         auto ret = detail::raw_parse_uri(s);
         if (!ret)
             return make_unexpected(ret.error());
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <utility>
+
+#include <ivy/io/mapped_file.hxx>
+#include <ivy/win32/error.hxx>
+#include <ivy/win32/windows.hxx>
+
+namespace ivy {
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+        : _file(std::exchange(other._file, nullptr))
+        , _mapping(std::exchange(other._mapping, nullptr))
+        , _data(std::exchange(other._data, nullptr))
+        , _size(std::exchange(other._size, 0))
+    {
+    }
+
+    auto mapped_file::operator=(mapped_file &&other) noexcept -> mapped_file &
+    {
+        if (this != &other) {
+            close();
+            _file = std::exchange(other._file, nullptr);
+            _mapping = std::exchange(other._mapping, nullptr);
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+
+        return *this;
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    auto mapped_file::unmap() noexcept -> void
+    {
+        if (_data)
+            ::UnmapViewOfFile(_data);
+
+        if (_mapping)
+            ::CloseHandle(_mapping);
+
+        _data = nullptr;
+        _mapping = nullptr;
+        _size = 0;
+    }
+
+    auto mapped_file::close() noexcept -> void
+    {
+        unmap();
+
+        if (_file)
+            ::CloseHandle(_file);
+
+        _file = nullptr;
+    }
+
+    auto mapped_file::close(std::size_t size) -> expected<void, error>
+    {
+        unmap();
+
+        if (!_file)
+            return {};
+
+        LARGE_INTEGER pos;
+        pos.QuadPart = static_cast<LONGLONG>(size);
+
+        std::error_code ec;
+        if (!::SetFilePointerEx(_file, pos, nullptr, FILE_BEGIN) ||
+            !::SetEndOfFile(_file))
+            ec = win32::get_last_error();
+
+        close();
+
+        if (ec)
+            return make_unexpected(make_error(ec));
+
+        return {};
+    }
+
+    auto create_mapped_file(std::filesystem::path const &path,
+                            std::size_t size) -> expected<mapped_file, error>
+    {
+        mapped_file file;
+
+        auto h = ::CreateFileW(path.c_str(),
+                               GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               CREATE_NEW,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+        if (h == INVALID_HANDLE_VALUE)
+            return make_unexpected(make_error(win32::get_last_error()));
+
+        file._file = h;
+
+        // Don't leave a file behind which the next attempt can't create.
+        auto fail = [&] {
+            auto ec = win32::get_last_error();
+            file.close();
+            ::DeleteFileW(path.c_str());
+            return make_unexpected(make_error(ec));
+        };
+
+        // Creating the mapping extends the file to 'size'.
+        auto size64 = static_cast<std::uint64_t>(size);
+        file._mapping = ::CreateFileMappingW(h,
+                                             nullptr,
+                                             PAGE_READWRITE,
+                                             static_cast<DWORD>(size64 >> 32),
+                                             static_cast<DWORD>(size64),
+                                             nullptr);
+        if (!file._mapping)
+            return fail();
+
+        auto *data = ::MapViewOfFile(file._mapping, FILE_MAP_WRITE, 0, 0, size);
+        if (!data)
+            return fail();
+
+        file._data = static_cast<std::byte *>(data);
+        file._size = size;
+        return file;
+    }
+
+    auto open_mapped_file(std::filesystem::path const &path)
+        -> expected<mapped_file, error>
+    {
+        mapped_file file;
+
+        auto h = ::CreateFileW(path.c_str(),
+                               GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE |
+                                   FILE_SHARE_DELETE,
+                               nullptr,
+                               OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+        if (h == INVALID_HANDLE_VALUE)
+            return make_unexpected(make_error(win32::get_last_error()));
+
+        file._file = h;
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(h, &size))
+            return make_unexpected(make_error(win32::get_last_error()));
+
+        // An empty file can't be mapped.
+        if (size.QuadPart == 0)
+            return file;
+
+        file._mapping =
+            ::CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!file._mapping)
+            return make_unexpected(make_error(win32::get_last_error()));
+
+        auto *data = ::MapViewOfFile(file._mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+            return make_unexpected(make_error(win32::get_last_error()));
+
+        file._data = static_cast<std::byte *>(data);
+        file._size = static_cast<std::size_t>(size.QuadPart);
+        return file;
+    }
+
+} // namespace ivy
@@ -3,14 +3,20 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <chrono>
+#include <cstdint>
+
 #include <ivy/http/service.hxx>
 #include <ivy/log.hxx>
+#include <ivy/metrics.hxx>
+#include <ivy/scope_guard.hxx>
 #include <ivy/win32/error.hxx>
 #include <ivy/win32/httpsys/request_context.hxx>
 #include <ivy/win32/httpsys/request_controller.hxx>
 #include <ivy/win32/httpsys/response.hxx>
 #include <ivy/win32/httpsys/service.hxx>
 #include <ivy/string/transcode.hxx>
+#include <ivy/trace.hxx>
 
 namespace ivy::win32::httpsys {
 
@@ -57,6 +63,32 @@ namespace ivy::win32::httpsys {
 
     auto request_controller::run() noexcept -> void
     {
+        IVY_SPAN("http.request");
+
+        // Registering the metric can throw, which mustn't escape run();
+        // the request is still served if it does, just not timed.
+        metrics::histogram *request_duration = nullptr;
+        try {
+            static auto &histogram =
+                metrics::get_global_registry()->get_histogram(
+                    "ivy_http_request_duration_nanoseconds",
+                    "Time from receiving an HTTP request to sending the "
+                    "response.");
+            request_duration = &histogram;
+        } catch (...) {
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        scope_guard record_duration([&] {
+            if (!request_duration)
+                return;
+
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            request_duration->record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count()));
+        });
+
         http::http_listener *lsnr = reinterpret_cast<http::http_listener *>(
             _httpsys_request->UrlContext);
 
@@ -74,6 +106,7 @@ namespace ivy::win32::httpsys {
         http::http_response resp;
 
         try {
+            IVY_SPAN("http.handler");
             resp = lsnr->handler(ctx, *reqs);
         } catch (...) {
             log_warning("HTTP: Failed to handle request: unexpected exception "
@@ -82,9 +115,11 @@ namespace ivy::win32::httpsys {
             return;
         }
 
+        IVY_SPAN("http.send_response");
+
         if (auto r = send_response(*reqs, resp); !r) {
-            log_warning(std::format("HTTP: Failed to send response: {}",
-                                    r.error().what()));
+            log_warning("HTTP: Failed to send response: {}",
+                        r.error().what());
         }
     }
 
@@ -6,11 +6,15 @@
 #ifndef IVY_DB_ODBC_CONNECTION_HXX_INCLUDED
 #define IVY_DB_ODBC_CONNECTION_HXX_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <memory>
 
 #include <nanodbc/nanodbc.h>
 
 #include <ivy/db/connection.hxx>
+#include <ivy/flat_hash_map.hxx>
 #include <ivy/noncopyable.hxx>
 #include <ivy/string.hxx>
 
@@ -18,11 +22,45 @@ namespace ivy::db::odbc {
 
     class query;
 
+    // The number of rows fetched at once by queries which don't set it.
+    inline constexpr std::size_t default_rowset_size = 1000;
+
+    // The number of prepared statements a connection keeps for reuse.
+    inline constexpr std::size_t default_statement_cache_size = 64;
+
     class connection final : public db::connection {
     protected:
         friend class query;
 
         nanodbc::connection _connection;
+        std::size_t _rowset_size = default_rowset_size;
+
+        // Prepared statements which no query is using, most recently used
+        // first, and an index of them by query text.  These are declared
+        // after _connection so they're freed before it's closed.
+        struct cached_statement {
+            u16string text;
+            std::shared_ptr<nanodbc::statement> statement;
+        };
+
+        using statement_list = std::list<cached_statement>;
+
+        std::size_t _statement_cache_size = default_statement_cache_size;
+        statement_list _statement_lru;
+        flat_hash_map<u16string, statement_list::iterator> _statement_cache;
+        std::uint64_t _statement_cache_hits = 0;
+        std::uint64_t _statement_cache_misses = 0;
+
+        // Take the cached statement for this text, or return null.
+        auto take_statement(u16string const &text)
+            -> std::shared_ptr<nanodbc::statement>;
+
+        // Put a statement back in the cache when its query is destroyed.
+        auto return_statement(u16string &&text,
+                              std::shared_ptr<nanodbc::statement> &&statement)
+            -> void;
+
+        auto trim_statement_cache(std::size_t size) noexcept -> void;
 
     public:
         connection();
@@ -40,6 +78,27 @@ namespace ivy::db::odbc {
             -> expected<db::query_handle, error> override;
 
         auto disconnect() -> void override;
+
+        [[nodiscard]] auto is_alive() noexcept -> bool override;
+
+        // The rowset size for queries prepared after this call.  Queries
+        // fetch up to this many rows with each SQLFetchScroll() into
+        // column-wise bound buffers; 1 fetches a row at a time.
+        auto set_rowset_size(std::size_t rows) noexcept -> void;
+        [[nodiscard]] auto rowset_size() const noexcept -> std::size_t;
+
+        // prepare_query() reuses the prepared statement of a query with
+        // the same text which has been destroyed, instead of preparing it
+        // again.  This sets how many such statements are kept, evicting
+        // the least recently used; 0 turns the cache off.
+        auto set_statement_cache_size(std::size_t size) noexcept -> void;
+        [[nodiscard]] auto statement_cache_size() const noexcept
+            -> std::size_t;
+
+        [[nodiscard]] auto statement_cache_hits() const noexcept
+            -> std::uint64_t;
+        [[nodiscard]] auto statement_cache_misses() const noexcept
+            -> std::uint64_t;
     };
 
     using connection_handle = std::unique_ptr<connection>;
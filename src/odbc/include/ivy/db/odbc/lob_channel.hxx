@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#ifndef IVY_DB_ODBC_LOB_CHANNEL_HXX_INCLUDED
+#define IVY_DB_ODBC_LOB_CHANNEL_HXX_INCLUDED
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <ivy/charenc/utf.hxx>
+#include <ivy/error.hxx>
+#include <ivy/expected.hxx>
+#include <ivy/io/pmrchannel.hxx>
+
+namespace ivy::db::odbc {
+
+    /*************************************************************************
+     *
+     * lob_channel: reads one column of the current row with repeated calls
+     * to SQLGetData(), so a large value can be copied to a file or a
+     * response body a piece at a time.
+     *
+     * Binary columns are read as they are.  Anything else is read as
+     * SQL_C_WCHAR and encoded to UTF-8, so the driver does the conversion
+     * from the column's character set.
+     *
+     * SQLGetData() only works on columns which nanodbc didn't bind, which
+     * are the long and variable-length ones; a bound column is copied
+     * from nanodbc's buffer when the channel is made, and read from
+     * there.
+     */
+
+    class lob_channel final : public pmrichannel<std::byte> {
+    public:
+        enum struct mode { binary, text, buffered };
+
+    private:
+        void *_statement;
+        unsigned short _column;
+        mode _mode;
+        bool _done = false;
+
+        // Bytes which have been fetched but not read yet: the rest of a
+        // chunk of text which didn't fit in the caller's buffer, or all
+        // of a buffered value.
+        std::vector<std::byte> _pending;
+        std::size_t _pending_pos = 0;
+
+        // Text is fetched a chunk at a time into here.  The decoder keeps
+        // a high surrogate at the end of a chunk until its pair arrives.
+        std::vector<char16_t> _chunk;
+        utf16_decoder _decoder;
+
+        auto read_binary(std::span<std::byte>) -> expected<io_size_t, error>;
+        auto fetch_text() -> expected<void, error>;
+
+    public:
+        // Stream column 'column' (counting from 1, as ODBC does) of the
+        // statement's current row.
+        lob_channel(void *statement, unsigned short column, mode mode);
+
+        // Stream a value which has already been fetched.
+        explicit lob_channel(std::vector<std::byte> value);
+
+        // Returns errc::end_of_file after the last byte.
+        auto read(std::span<std::byte>) noexcept
+            -> expected<io_size_t, error> override;
+    };
+
+} // namespace ivy::db::odbc
+
+#endif // IVY_DB_ODBC_LOB_CHANNEL_HXX_INCLUDED
@@ -6,18 +6,40 @@
 #ifndef IVY_DB_ODBC_QUERY_HXX_INCLUDED
 #define IVY_DB_ODBC_QUERY_HXX_INCLUDED
 
+#include <cstddef>
 #include <memory>
+#include <span>
+#include <vector>
 
+#include <ivy/datum.hxx>
 #include <ivy/error.hxx>
 #include <ivy/expected.hxx>
 #include <ivy/noncopyable.hxx>
 
 namespace ivy::db::odbc {
 
+    // The values bound to one parameter.  nanodbc binds these buffers in
+    // place rather than copying them, so they must live until the
+    // statement is executed.  Binary values are copied by nanodbc.
+    struct parameter_buffer {
+        std::vector<long long> integers;
+        std::vector<double> reals;
+        std::vector<nanodbc::date> dates;
+        std::vector<nanodbc::timestamp> timestamps;
+        std::vector<nanodbc::wide_char_t> wide_chars;
+        std::vector<char> chars;
+
+        // The number of values bound; 0 if the parameter isn't bound.
+        std::size_t size = 0;
+    };
+
     class query final : public db::query {
     protected:
         connection *_connection;
-        nanodbc::statement _statement;
+        u16string _text;
+        std::shared_ptr<nanodbc::statement> _statement;
+        std::size_t _rowset_size;
+        std::vector<parameter_buffer> _parameters;
 
     public:
         query(connection &);
@@ -26,6 +48,24 @@ namespace ivy::db::odbc {
         auto prepare(u16string const &query_string) noexcept -> expected<void, error>;
 
         auto execute() noexcept -> expected<db::query_result_handle, error> override;
+
+        [[nodiscard]] auto bind(std::size_t param, datum const &value) noexcept
+            -> expected<void, error> override;
+
+        [[nodiscard]] auto
+        bind_array(std::size_t param, std::span<datum const> values) noexcept
+            -> expected<void, error> override;
+
+        auto clear_bindings() noexcept -> void override;
+
+        // The most rows to fetch at once.  The rowset is smaller if the
+        // bound buffers would be too large, and is 1 if the result has a
+        // long column which can't be bound.  It is not used when any
+        // parameter is bound: nanodbc uses one number for both the rowset
+        // and the parameter sets, so the rowset is then the number of
+        // values bound to each parameter.
+        auto set_rowset_size(std::size_t rows) noexcept -> void;
+        [[nodiscard]] auto rowset_size() const noexcept -> std::size_t;
     };
 
     using query_handle = std::unique_ptr<query>;
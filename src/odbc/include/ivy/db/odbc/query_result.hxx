@@ -6,6 +6,9 @@
 #ifndef IVY_DB_ODBC_QUERY_RESULT_HXX_INCLUDED
 #define IVY_DB_ODBC_QUERY_RESULT_HXX_INCLUDED
 
+#include <cstdint>
+#include <memory>
+
 #include <ivy/db/query_result.hxx>
 #include <ivy/db/result_set.hxx>
 #include <ivy/noncopyable.hxx>
@@ -16,8 +19,16 @@ namespace ivy::db::odbc {
         nanodbc::result _result;
         bool first = true;
 
+        // Held so the statement isn't reused while the result is open.
+        std::shared_ptr<nanodbc::statement> _statement;
+
+        // Rows fetched from all result sets, for the rows-per-query metric.
+        std::uint64_t _rows = 0;
+
     public:
-        query_result(nanodbc::result &&) noexcept;
+        query_result(nanodbc::result &&,
+                     std::shared_ptr<nanodbc::statement> statement) noexcept;
+        ~query_result();
 
         [[nodiscard]] auto has_data() const noexcept -> bool override;
         [[nodiscard]] auto get_next_result_set() noexcept
@@ -6,10 +6,14 @@
 #ifndef IVY_DB_ODBC_RESULT_SET_HXX_INCLUDED
 #define IVY_DB_ODBC_RESULT_SET_HXX_INCLUDED
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <nanodbc/nanodbc.h>
 
+#include <ivy/db/odbc/row.hxx>
 #include <ivy/db/result_set.hxx>
 #include <ivy/noncopyable.hxx>
 
@@ -17,15 +21,33 @@ namespace ivy::db::odbc {
 
     class result_set : public db::result_set {
         nanodbc::result *_result;
+        std::uint64_t *_rows;
+
+        // The row returned by next_row().
+        row _row;
+
+        // Reused by next_batch() for fetching strings and binary values.
+        nanodbc::wide_string _text;
+        std::string _narrow_text;
+        std::string _utf8;
+        std::vector<std::uint8_t> _bytes;
+
+        auto set_up_batch(record_batch &batch) -> void;
+        auto append_cell(batch_column &column, short i) -> void;
 
     public:
-        result_set(nanodbc::result *) noexcept;
+        result_set(nanodbc::result *, std::uint64_t *rows) noexcept;
 
         virtual ~result_set();
 
         [[nodiscard]] auto column_count() -> std::size_t override;
         [[nodiscard]] auto get_next_row() noexcept
             -> expected<row_handle, error> override;
+        [[nodiscard]] auto next_row() noexcept
+            -> expected<db::row *, error> override;
+        [[nodiscard]] auto next_batch(record_batch &batch,
+                                      std::size_t max_rows) noexcept
+            -> expected<std::size_t, error> override;
     };
 
     using result_set_handle = std::unique_ptr<result_set>;
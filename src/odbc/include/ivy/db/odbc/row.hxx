@@ -7,10 +7,14 @@
 #define IVY_DB_ODBC_ROW_HXX_INCLUDED
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
 #include <nanodbc/nanodbc.h>
 
 #include <ivy/db/row.hxx>
+#include <ivy/db/odbc/value.hxx>
 #include <ivy/db/value.hxx>
 
 namespace ivy::db::odbc {
@@ -18,6 +22,11 @@ namespace ivy::db::odbc {
     class row final : public db::row {
         nanodbc::result *_result;
 
+        // Reused by value_at() and get_string_view().
+        value _value;
+        nanodbc::wide_string _text;
+        std::string _narrow_text;
+
     public:
         row(nanodbc::result *);
         ~row();
@@ -25,6 +34,19 @@ namespace ivy::db::odbc {
         auto column_count() -> std::size_t override;
         auto get_value(std::size_t column) noexcept
             -> expected<db::value_handle, error> override;
+        auto value_at(std::size_t column) noexcept
+            -> expected<db::value *, error> override;
+
+        auto is_null(std::size_t column) noexcept
+            -> expected<bool, error> override;
+        auto get_int64(std::size_t column) noexcept
+            -> expected<std::int64_t, error> override;
+        auto get_double(std::size_t column) noexcept
+            -> expected<double, error> override;
+        auto get_string_view(std::size_t column) noexcept
+            -> expected<std::u16string_view, error> override;
+        auto get_datum(std::size_t column) noexcept
+            -> expected<datum, error> override;
     };
 
 } // namespace ivy::db::odbc
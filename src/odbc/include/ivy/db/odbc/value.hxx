@@ -26,6 +26,9 @@ namespace ivy::db::odbc {
         value(nanodbc::result *, short);
 
         auto as_datum() const noexcept -> expected<datum, error> override;
+        auto open_stream() noexcept
+            -> expected<std::unique_ptr<pmrichannel<std::byte>>, error>
+            override;
     };
 
     using value_handle = std::unique_ptr<value>;
@@ -3,7 +3,18 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <format>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <nanodbc/nanodbc.h>
 
@@ -14,22 +25,87 @@
 #include <sql.h>
 #include <sqlext.h>
 
+#include <ivy/charenc/utf.hxx>
 #include <ivy/datum/boolean.hxx>
+#include <ivy/datum/bytes.hxx>
+#include <ivy/datum/date.hxx>
+#include <ivy/datum/decimal.hxx>
+#include <ivy/datum/double.hxx>
 #include <ivy/datum/integer.hxx>
 #include <ivy/datum/null.hxx>
 #include <ivy/datum/string.hxx>
+#include <ivy/datum/timestamp.hxx>
 #include <ivy/db/error.hxx>
 #include <ivy/db/odbc/connect.hxx>
 #include <ivy/db/odbc/connection.hxx>
+#include <ivy/db/odbc/lob_channel.hxx>
 #include <ivy/db/odbc/query.hxx>
 #include <ivy/db/odbc/query_result.hxx>
 #include <ivy/db/odbc/result_set.hxx>
 #include <ivy/db/odbc/row.hxx>
 #include <ivy/db/odbc/value.hxx>
+#include <ivy/metrics.hxx>
 #include <ivy/string/transcode.hxx>
+#include <ivy/trace.hxx>
 
 namespace ivy::db::odbc {
 
+    namespace {
+
+        // nanodbc is built with NANODBC_ENABLE_UNICODE, so its strings are
+        // UTF-16 on every platform (std::wstring on Windows, u16string
+        // elsewhere), and our u16strings can be copied straight in.
+        auto to_nanodbc(u16string const &s) -> nanodbc::wide_string
+        {
+            static_assert(sizeof(nanodbc::wide_char_t) == sizeof(char16_t));
+
+            return nanodbc::wide_string(
+                reinterpret_cast<nanodbc::wide_char_t const *>(s.data()),
+                s.size());
+        }
+
+        // Convert between the driver's UTF-16 and the UTF-32 of string
+        // datums directly, rather than through ICU; this runs for every
+        // string cell.
+        auto from_utf16(std::u16string_view s) -> string
+        {
+            std::vector<char32_t> chars;
+            chars.reserve(s.size());
+            decode_utf16(s, [&](char32_t c) { chars.push_back(c); });
+            return string(std::move(chars));
+        }
+
+        auto from_utf8(std::string_view s) -> string
+        {
+            std::vector<char32_t> chars;
+            chars.reserve(s.size());
+            decode_utf8(s, [&](char32_t c) { chars.push_back(c); });
+            return string(std::move(chars));
+        }
+
+        // nanodbc fetches SQL_CHAR, SQL_VARCHAR and SQL_LONGVARCHAR columns
+        // as SQL_C_CHAR.  Asking it for a wide_string would convert them
+        // with codecvt, which throws on anything that isn't UTF-8, before
+        // we decode the UTF-16 again; instead, get the bytes and decode
+        // them once, with anything malformed becoming U+FFFD.
+        auto is_narrow(nanodbc::result const &result, short column) -> bool
+        {
+            return result.column_c_datatype(column) == SQL_C_CHAR;
+        }
+
+        auto to_utf16(string const &s) -> nanodbc::wide_string
+        {
+            nanodbc::wide_string ret;
+            ret.reserve(s.size());
+
+            for (char32_t c : s)
+                encode_utf16(c, std::back_inserter(ret));
+
+            return ret;
+        }
+
+    } // namespace
+
     auto connect(u16string const &connection_string) noexcept
         -> expected<db::connection_handle, error>
     try {
@@ -62,12 +138,7 @@ namespace ivy::db::odbc {
     auto connection::connect(u16string const &connection_string) noexcept
         -> expected<void, error>
     try {
-        auto wconnstr = transcode<wstring>(connection_string)
-                            .or_throw_with_nested(connection_error(
-                                "cannot transcode connection string"));
-
-        std::wstring str(wconnstr.begin(), wconnstr.end());
-        _connection.connect(str);
+        _connection.connect(to_nanodbc(connection_string));
         return {};
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<connection_error>(e.what()));
@@ -80,20 +151,9 @@ namespace ivy::db::odbc {
                              u16string const &password) noexcept
         -> expected<void, error>
     try {
-        auto wconnstr = transcode<wstring>(connection_string)
-                            .or_throw_with_nested(connection_error(
-                                "cannot transcode connection string"));
-
-        auto wusername = transcode<wstring>(username).or_throw_with_nested(
-            connection_error("cannot transcode username string"));
-
-        auto wpassword = transcode<wstring>(password).or_throw_with_nested(
-            connection_error("cannot transcode password string"));
-
-        std::wstring connstr(wconnstr.begin(), wconnstr.end());
-        std::wstring unstr(wusername.begin(), wusername.end());
-        std::wstring pwstr(wpassword.begin(), wpassword.end());
-        _connection.connect(connstr, unstr, pwstr);
+        _connection.connect(to_nanodbc(connection_string),
+                            to_nanodbc(username),
+                            to_nanodbc(password));
         return {};
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<connection_error>(e.what()));
@@ -113,23 +173,291 @@ namespace ivy::db::odbc {
 
     auto connection::disconnect() -> void
     {
+        trim_statement_cache(0);
         _connection.disconnect();
     }
 
+    auto connection::is_alive() noexcept -> bool
+    try {
+        if (!_connection.connected())
+            return false;
+
+        // SQL_ATTR_CONNECTION_DEAD reports whether the driver has seen the
+        // connection fail, without a round trip to the server.  Assume a
+        // driver which doesn't support it is alive.
+        SQLUINTEGER dead = SQL_CD_FALSE;
+        auto rc = SQLGetConnectAttr(
+            static_cast<SQLHDBC>(_connection.native_dbc_handle()),
+            SQL_ATTR_CONNECTION_DEAD,
+            &dead,
+            0,
+            nullptr);
+
+        return !SQL_SUCCEEDED(rc) || dead != SQL_CD_TRUE;
+    } catch (...) {
+        return false;
+    }
+
+    auto connection::set_rowset_size(std::size_t rows) noexcept -> void
+    {
+        _rowset_size = std::max<std::size_t>(rows, 1);
+    }
+
+    auto connection::rowset_size() const noexcept -> std::size_t
+    {
+        return _rowset_size;
+    }
+
+    /*************************************************************************
+     *
+     * The prepared statement cache.
+     */
+
+    auto connection::set_statement_cache_size(std::size_t size) noexcept
+        -> void
+    {
+        _statement_cache_size = size;
+        trim_statement_cache(size);
+    }
+
+    auto connection::statement_cache_size() const noexcept -> std::size_t
+    {
+        return _statement_cache_size;
+    }
+
+    auto connection::statement_cache_hits() const noexcept -> std::uint64_t
+    {
+        return _statement_cache_hits;
+    }
+
+    auto connection::statement_cache_misses() const noexcept -> std::uint64_t
+    {
+        return _statement_cache_misses;
+    }
+
+    auto connection::take_statement(u16string const &text)
+        -> std::shared_ptr<nanodbc::statement>
+    {
+        static auto &hits = metrics::get_global_registry()->get_counter(
+            "ivy_db_statement_cache_hits_total",
+            "Queries which reused a cached prepared statement.");
+
+        static auto &misses = metrics::get_global_registry()->get_counter(
+            "ivy_db_statement_cache_misses_total",
+            "Queries which had to be prepared.");
+
+        auto it = _statement_cache.find(text);
+        if (it == _statement_cache.end()) {
+            ++_statement_cache_misses;
+            misses.add();
+            return {};
+        }
+
+        auto entry = it->second;
+        auto statement = std::move(entry->statement);
+        _statement_cache.erase(it);
+        _statement_lru.erase(entry);
+
+        ++_statement_cache_hits;
+        hits.add();
+        return statement;
+    }
+
+    auto connection::return_statement(
+        u16string &&text, std::shared_ptr<nanodbc::statement> &&statement)
+        -> void
+    {
+        // If the query's result is still open, the statement can't be
+        // reused yet; the result will free it.  If another query with the
+        // same text is already cached, keep that one.
+        if (_statement_cache_size == 0 || statement.use_count() != 1 ||
+            _statement_cache.find(text) != _statement_cache.end())
+            return;
+
+        // Close any cursor, and unbind the query's parameter buffers,
+        // which are about to be freed.
+        statement->reset_parameters();
+        SQLFreeStmt(static_cast<SQLHSTMT>(statement->native_statement_handle()),
+                    SQL_CLOSE);
+
+        _statement_lru.push_front({text, std::move(statement)});
+        _statement_cache.try_emplace(std::move(text), _statement_lru.begin());
+        trim_statement_cache(_statement_cache_size);
+    }
+
+    auto connection::trim_statement_cache(std::size_t size) noexcept -> void
+    {
+        while (_statement_lru.size() > size) {
+            _statement_cache.erase(_statement_lru.back().text);
+            _statement_lru.pop_back();
+        }
+    }
+
+    namespace {
+
+        // The most memory a result's bound buffers may use.
+        constexpr std::size_t max_rowset_bytes = 16 * 1024 * 1024;
+
+        // SQL Server types, from msodbcsql.h.
+        constexpr SQLSMALLINT sql_ss_udt = -151;
+        constexpr SQLSMALLINT sql_ss_xml = -152;
+
+        // The size of the buffer nanodbc binds for one value of a column,
+        // or nothing if it doesn't bind the column and reads it with
+        // SQLGetData() instead.  This follows result_impl::auto_bind().
+        auto bound_width(SQLSMALLINT type, SQLULEN size)
+            -> std::optional<std::size_t>
+        {
+            switch (type) {
+            case SQL_BIT:
+            case SQL_TINYINT:
+            case SQL_SMALLINT:
+            case SQL_INTEGER:
+            case SQL_BIGINT:
+            case SQL_DOUBLE:
+            case SQL_FLOAT:
+            case SQL_REAL:
+                return 8;
+
+            case SQL_DECIMAL:
+            case SQL_NUMERIC:
+                return size + 3;
+
+            case SQL_DATE:
+            case SQL_TYPE_DATE:
+            case SQL_TIME:
+            case SQL_TYPE_TIME:
+            case SQL_TIMESTAMP:
+            case SQL_TYPE_TIMESTAMP:
+                return sizeof(SQL_TIMESTAMP_STRUCT);
+
+            case SQL_CHAR:
+            case SQL_VARCHAR:
+                if (size == 0)
+                    return {};
+                return size + 1;
+
+            case SQL_WCHAR:
+            case SQL_WVARCHAR:
+            case sql_ss_xml:
+                if (size == 0)
+                    return {};
+                return (size + 1) * sizeof(SQLWCHAR);
+
+            case SQL_LONGVARCHAR:
+            case SQL_WLONGVARCHAR:
+            case SQL_BINARY:
+            case SQL_VARBINARY:
+            case SQL_LONGVARBINARY:
+            case sql_ss_udt:
+                return {};
+
+            default:
+                return 128;
+            }
+        }
+
+        // The rowset size to execute a prepared statement with.  nanodbc
+        // reads the columns it doesn't bind with SQLGetData(), which only
+        // sees the first row of a rowset, so a result with such a column
+        // is fetched a row at a time.  So is a statement which returns no
+        // result, since nanodbc also uses the rowset size as the number
+        // of parameter sets.
+        auto choose_rowset_size(nanodbc::statement &statement,
+                                std::size_t wanted) -> long
+        {
+            if (wanted <= 1)
+                return 1;
+
+            auto stmt = static_cast<SQLHSTMT>(
+                statement.native_statement_handle());
+
+            SQLSMALLINT ncolumns = 0;
+            if (!SQL_SUCCEEDED(SQLNumResultCols(stmt, &ncolumns)) ||
+                ncolumns <= 0)
+                return 1;
+
+            std::size_t row_bytes = 0;
+
+            for (SQLSMALLINT i = 1; i <= ncolumns; ++i) {
+                SQLSMALLINT type = 0, scale = 0, nullable = 0;
+                SQLULEN size = 0;
+
+                auto rc = SQLDescribeCol(stmt,
+                                         static_cast<SQLUSMALLINT>(i),
+                                         nullptr,
+                                         0,
+                                         nullptr,
+                                         &type,
+                                         &size,
+                                         &scale,
+                                         &nullable);
+                if (!SQL_SUCCEEDED(rc))
+                    return 1;
+
+                auto width = bound_width(type, size);
+                if (!width)
+                    return 1;
+
+                row_bytes += *width + sizeof(SQLLEN);
+            }
+
+            auto rows = std::min(wanted, max_rowset_bytes / row_bytes);
+            return static_cast<long>(std::max<std::size_t>(rows, 1));
+        }
+
+        // The query has no statement, because prepare() wasn't called or
+        // failed.
+        auto not_prepared() -> error
+        {
+            return make_error(std::errc::invalid_argument);
+        }
+
+    } // namespace
+
     query::query(connection &conn)
         : _connection(&conn)
-        , _statement(_connection->_connection)
+        , _rowset_size(conn._rowset_size)
     {
     }
 
-    query::~query() = default;
+    query::~query()
+    {
+        if (!_statement)
+            return;
+
+        try {
+            _connection->return_statement(std::move(_text),
+                                          std::move(_statement));
+        } catch (...) {
+            // The statement just isn't cached.
+        }
+    }
+
+    auto query::set_rowset_size(std::size_t rows) noexcept -> void
+    {
+        _rowset_size = std::max<std::size_t>(rows, 1);
+    }
+
+    auto query::rowset_size() const noexcept -> std::size_t
+    {
+        return _rowset_size;
+    }
 
     auto query::prepare(u16string const &query_string) noexcept
         -> expected<void, error>
     try {
-        auto wq = transcode<wstring>(query_string)
-                      .or_throw_with_nested("cannot transcode query string");
-        _statement.prepare(std::wstring(wq.begin(), wq.end()));
+        _text = query_string;
+
+        if (auto statement = _connection->take_statement(query_string)) {
+            _statement = std::move(statement);
+            return {};
+        }
+
+        auto statement =
+            std::make_shared<nanodbc::statement>(_connection->_connection);
+        statement->prepare(to_nanodbc(query_string));
+        _statement = std::move(statement);
         return {};
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<query_execution_error>(e.what()));
@@ -139,18 +467,299 @@ namespace ivy::db::odbc {
 
     auto query::execute() noexcept -> expected<db::query_result_handle, error>
     try {
-        return std::make_unique<query_result>(_statement.execute(1, 0));
+        IVY_SPAN("odbc.execute");
+
+        if (!_statement)
+            return make_unexpected(not_prepared());
+
+        // Every parameter bound to an array must have the same number of
+        // values, which is the number of parameter sets.
+        std::size_t paramsets = 0;
+        for (auto &&parameter : _parameters) {
+            if (parameter.size == 0)
+                continue;
+
+            if (paramsets == 0)
+                paramsets = parameter.size;
+            else if (parameter.size != paramsets)
+                return make_unexpected(make_error(std::errc::invalid_argument));
+        }
+
+        // nanodbc uses the same number for the paramset size and the
+        // rowset size, and the driver reads that many values from every
+        // bound parameter, so once anything is bound it must be the
+        // number of parameter sets, even if that is 1.  The rowset size
+        // only applies to a query without parameters.
+        auto batch = paramsets > 0
+                         ? static_cast<long>(paramsets)
+                         : choose_rowset_size(*_statement, _rowset_size);
+
+        return std::make_unique<query_result>(_statement->execute(batch, 0),
+                                              _statement);
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<query_execution_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    namespace {
+
+        auto to_odbc_date(std::chrono::sys_days d) -> nanodbc::date
+        {
+            std::chrono::year_month_day ymd(d);
+            return {static_cast<std::int16_t>(int(ymd.year())),
+                    static_cast<std::int16_t>(unsigned(ymd.month())),
+                    static_cast<std::int16_t>(unsigned(ymd.day()))};
+        }
+
+        // ODBC wants the fraction of a second in nanoseconds.
+        auto
+        to_odbc_timestamp(std::chrono::sys_time<std::chrono::microseconds> t)
+            -> nanodbc::timestamp
+        {
+            auto days = std::chrono::floor<std::chrono::days>(t);
+            auto date = to_odbc_date(days);
+            std::chrono::hh_mm_ss hms(t - days);
+
+            return {date.year,
+                    date.month,
+                    date.day,
+                    static_cast<std::int16_t>(hms.hours().count()),
+                    static_cast<std::int16_t>(hms.minutes().count()),
+                    static_cast<std::int16_t>(hms.seconds().count()),
+                    static_cast<std::int32_t>(hms.subseconds().count() * 1000)};
+        }
+
+        // Copy strings into one array of fixed-width, null-terminated
+        // values, which is how ODBC takes an array of strings.  Returns
+        // the width.
+        template <typename Char, typename String>
+        auto fill_strings(std::vector<Char> &buffer,
+                          std::vector<String> const &strings) -> std::size_t
+        {
+            std::size_t width = 0;
+            for (auto &&s : strings)
+                width = std::max(width, s.size());
+            ++width;
+
+            buffer.assign(strings.size() * width, Char());
+            for (std::size_t i = 0; i < strings.size(); ++i)
+                std::ranges::copy(strings[i], buffer.data() + i * width);
+
+            return width;
+        }
+
+    } // namespace
+
+    auto query::bind(std::size_t param, datum const &value) noexcept
+        -> expected<void, error>
+    {
+        return bind_array(param, std::span(&value, 1));
+    }
+
+    auto query::bind_array(std::size_t param,
+                           std::span<datum const> values) noexcept
+        -> expected<void, error>
+    try {
+        if (!_statement)
+            return make_unexpected(not_prepared());
+
+        if (param > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        if (values.empty())
+            return make_unexpected(make_error(std::errc::invalid_argument));
+
+        auto kind = datum::kind::null;
+        for (auto &&v : values) {
+            if (v.get_kind() == datum::kind::null)
+                continue;
+
+            if (kind == datum::kind::null)
+                kind = v.get_kind();
+            else if (v.get_kind() != kind)
+                return make_unexpected(make_error(std::errc::invalid_argument));
+        }
+
+        switch (kind) {
+        case datum::kind::null:
+        case datum::kind::boolean:
+        case datum::kind::integer:
+        case datum::kind::real:
+        case datum::kind::date:
+        case datum::kind::timestamp:
+        case datum::kind::string:
+        case datum::kind::decimal:
+        case datum::kind::bytes:
+            break;
+
+        default:
+            return make_unexpected(make_error(std::errc::not_supported));
+        }
+
+        if (param >= _parameters.size())
+            _parameters.resize(param + 1);
+
+        auto index = static_cast<short>(param);
+        auto n = values.size();
+
+        // Fill a new buffer, so the old one stays bound until nanodbc has
+        // accepted the new one.  Moving the vectors doesn't move their
+        // data, so the buffer can be moved into _parameters afterwards.
+        parameter_buffer buffer;
+
+        auto nulls = std::make_unique<bool[]>(n);
+        for (std::size_t i = 0; i < n; ++i)
+            nulls[i] = values[i].get_kind() == datum::kind::null;
+
+        // If binding fails part way through, we no longer know what the
+        // parameter is bound to, so unbind everything.
+        try {
+            switch (kind) {
+            case datum::kind::null:
+                _statement->bind_null(index, n);
+                break;
+
+            case datum::kind::boolean:
+                buffer.integers.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto b = datum_cast<bool>(&values[i]))
+                        buffer.integers[i] = *b;
+                _statement->bind(
+                    index, buffer.integers.data(), n, nulls.get());
+                break;
+
+            case datum::kind::integer:
+                buffer.integers.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v = datum_cast<std::int64_t>(&values[i]))
+                        buffer.integers[i] = *v;
+                _statement->bind(
+                    index, buffer.integers.data(), n, nulls.get());
+                break;
+
+            case datum::kind::real:
+                buffer.reals.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v = datum_cast<double>(&values[i]))
+                        buffer.reals[i] = *v;
+                _statement->bind(
+                    index, buffer.reals.data(), n, nulls.get());
+                break;
+
+            case datum::kind::date:
+                buffer.dates.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v =
+                            datum_cast<std::chrono::sys_days>(&values[i]))
+                        buffer.dates[i] = to_odbc_date(*v);
+                _statement->bind(
+                    index, buffer.dates.data(), n, nulls.get());
+                break;
+
+            case datum::kind::timestamp:
+                buffer.timestamps.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v = datum_cast<std::chrono::sys_time<
+                            std::chrono::microseconds>>(&values[i]))
+                        buffer.timestamps[i] = to_odbc_timestamp(*v);
+                _statement->bind(
+                    index, buffer.timestamps.data(), n, nulls.get());
+                break;
+
+            case datum::kind::string: {
+                std::vector<nanodbc::wide_string> strings(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v = datum_cast<string>(&values[i]))
+                        strings[i] = to_utf16(*v);
+
+                auto width = fill_strings(buffer.wide_chars, strings);
+                _statement->bind_strings(
+                    index, buffer.wide_chars.data(), width, n, nulls.get());
+                break;
+            }
+
+            case datum::kind::decimal: {
+                // Decimals are sent as text, which every driver can convert
+                // to DECIMAL or NUMERIC without knowing the precision and
+                // scale.
+                std::vector<std::string> strings(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v = datum_cast<decimal>(&values[i]))
+                        strings[i] = v->str();
+
+                auto width = fill_strings(buffer.chars, strings);
+                _statement->bind_strings(
+                    index, buffer.chars.data(), width, n, nulls.get());
+                break;
+            }
+
+            case datum::kind::bytes: {
+                std::vector<std::vector<std::uint8_t>> bytes(n);
+                for (std::size_t i = 0; i < n; ++i)
+                    if (auto v =
+                            datum_cast<std::vector<std::byte>>(&values[i])) {
+                        auto p =
+                            reinterpret_cast<std::uint8_t const *>(v->data());
+                        bytes[i].assign(p, p + v->size());
+                    }
+
+                _statement->bind(index, bytes, nulls.get());
+                break;
+            }
+
+            default:
+                break;
+            }
+        } catch (...) {
+            clear_bindings();
+            throw;
+        }
+
+        buffer.size = n;
+        _parameters[param] = std::move(buffer);
+        return {};
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<query_execution_error>(e.what()));
     } catch (...) {
         return make_unexpected(make_error(std::current_exception()));
     }
 
-    query_result::query_result(nanodbc::result &&result) noexcept
+    auto query::clear_bindings() noexcept -> void
+    {
+        if (_statement)
+            _statement->reset_parameters();
+        _parameters.clear();
+    }
+
+    query_result::query_result(
+        nanodbc::result &&result,
+        std::shared_ptr<nanodbc::statement> statement) noexcept
         : _result(std::move(result))
+        , _statement(std::move(statement))
     {
     }
 
+    query_result::~query_result()
+    {
+        // Registering the metrics can throw, which mustn't escape a
+        // destructor; losing one result's counts is harmless.
+        try {
+            static auto &rows_per_query =
+                metrics::get_global_registry()->get_histogram(
+                    "ivy_db_query_rows", "Rows fetched per ODBC query.");
+
+            static auto &rows_fetched =
+                metrics::get_global_registry()->get_counter(
+                    "ivy_db_rows_fetched_total",
+                    "Rows fetched from ODBC queries.");
+
+            rows_per_query.record(_rows);
+            rows_fetched.add(_rows);
+        } catch (...) {
+        }
+    }
+
     auto query_result::has_data() const noexcept -> bool
     {
         return _result.columns() != 0;
@@ -166,13 +775,93 @@ namespace ivy::db::odbc {
                 return make_unexpected(make_error<end_of_data>());
         }
 
-        return std::make_unique<result_set>(&_result);
+        return std::make_unique<result_set>(&_result, &_rows);
     } catch (...) {
         return make_unexpected(make_error(std::current_exception()));
     }
 
-    result_set::result_set(nanodbc::result *result) noexcept
+    namespace {
+
+        auto to_sys_days(nanodbc::date const &d) -> std::chrono::sys_days
+        {
+            return std::chrono::year_month_day(
+                std::chrono::year(d.year),
+                std::chrono::month(static_cast<unsigned>(d.month)),
+                std::chrono::day(static_cast<unsigned>(d.day)));
+        }
+
+        // ODBC gives the fraction of a second in nanoseconds; datums hold
+        // microseconds.
+        auto to_sys_time(nanodbc::timestamp const &t)
+            -> std::chrono::sys_time<std::chrono::microseconds>
+        {
+            return to_sys_days({t.year, t.month, t.day}) +
+                   std::chrono::hours(t.hour) + std::chrono::minutes(t.min) +
+                   std::chrono::seconds(t.sec) +
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::nanoseconds(t.fract));
+        }
+
+        // The batch column type a result column is exported as.  Decimals
+        // are exported as text, like value::as_datum() falls back to, so
+        // they keep their precision.
+        auto batch_type(int datatype) -> column_type
+        {
+            switch (datatype) {
+            case SQL_BIT:
+                return column_type::boolean;
+
+            case SQL_TINYINT:
+            case SQL_SMALLINT:
+            case SQL_INTEGER:
+            case SQL_BIGINT:
+                return column_type::int64;
+
+            case SQL_REAL:
+            case SQL_FLOAT:
+            case SQL_DOUBLE:
+                return column_type::float64;
+
+            case SQL_DATE:
+            case SQL_TYPE_DATE:
+                return column_type::date32;
+
+            case SQL_TIMESTAMP:
+            case SQL_TYPE_TIMESTAMP:
+                return column_type::timestamp_us;
+
+            case SQL_BINARY:
+            case SQL_VARBINARY:
+            case SQL_LONGVARBINARY:
+                return column_type::binary;
+
+            default:
+                return column_type::utf8;
+            }
+        }
+
+        auto column_name_utf8(nanodbc::result const &result, short column)
+            -> std::string
+        {
+            static_assert(sizeof(nanodbc::wide_char_t) == sizeof(char16_t));
+
+            auto name = result.column_name(column);
+            auto u8 = transcode<u8string>(
+                          u16string(reinterpret_cast<char16_t const *>(
+                                        name.data()),
+                                    name.size()))
+                          .or_throw();
+            return std::string(reinterpret_cast<char const *>(u8.data()),
+                               u8.size());
+        }
+
+    } // namespace
+
+    result_set::result_set(nanodbc::result *result,
+                           std::uint64_t *rows) noexcept
         : _result(result)
+        , _rows(rows)
+        , _row(result)
     {
     }
 
@@ -185,9 +874,12 @@ namespace ivy::db::odbc {
 
     auto result_set::get_next_row() noexcept -> expected<row_handle, error>
     try {
+        IVY_SPAN("odbc.fetch");
+
         if (!_result->next())
             return make_unexpected(make_error<end_of_data>());
 
+        ++*_rows;
         return std::make_unique<row>(_result);
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<query_execution_error>(e.what()));
@@ -195,8 +887,125 @@ namespace ivy::db::odbc {
         return make_unexpected(make_error(std::current_exception()));
     }
 
+    auto result_set::next_row() noexcept -> expected<db::row *, error>
+    try {
+        IVY_SPAN("odbc.fetch");
+
+        if (!_result->next())
+            return make_unexpected(make_error<end_of_data>());
+
+        ++*_rows;
+        return &_row;
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<query_execution_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto result_set::set_up_batch(record_batch &batch) -> void
+    {
+        auto ncolumns = _result->columns();
+
+        bool same = batch.num_columns() == static_cast<std::size_t>(ncolumns);
+        for (short i = 0; same && i < ncolumns; ++i)
+            same = batch.column(i).type() ==
+                       batch_type(_result->column_datatype(i)) &&
+                   batch.name(i) == column_name_utf8(*_result, i);
+
+        if (same) {
+            batch.clear();
+            return;
+        }
+
+        batch.reset();
+        for (short i = 0; i < ncolumns; ++i)
+            batch.add_column(column_name_utf8(*_result, i),
+                             batch_type(_result->column_datatype(i)));
+    }
+
+    auto result_set::append_cell(batch_column &column, short i) -> void
+    {
+        if (_result->is_null(i)) {
+            column.append_null();
+            return;
+        }
+
+        switch (column.type()) {
+        case column_type::boolean:
+            column.append_boolean(_result->get<int>(i) != 0);
+            break;
+
+        case column_type::int64:
+            column.append_int64(_result->get<long long>(i));
+            break;
+
+        case column_type::float64:
+            column.append_double(_result->get<double>(i));
+            break;
+
+        case column_type::date32:
+            column.append_date(to_sys_days(_result->get<nanodbc::date>(i)));
+            break;
+
+        case column_type::timestamp_us:
+            column.append_timestamp(
+                to_sys_time(_result->get<nanodbc::timestamp>(i)));
+            break;
+
+        case column_type::binary:
+            _result->get_ref(i, _bytes);
+            column.append_binary(std::as_bytes(std::span(_bytes)));
+            break;
+
+        default:
+            if (is_narrow(*_result, i)) {
+                // Copied as UTF-8, replacing anything malformed.
+                _result->get_ref(i, _narrow_text);
+                _utf8.clear();
+                decode_utf8(_narrow_text, [&](char32_t c) {
+                    encode_utf8(c, std::back_inserter(_utf8));
+                });
+                column.append_utf8(_utf8);
+                break;
+            }
+
+            // Straight from the driver's UTF-16 to UTF-8, reusing _text.
+            _result->get_ref(i, _text);
+            column.append_utf16(std::u16string_view(
+                reinterpret_cast<char16_t const *>(_text.data()),
+                _text.size()));
+            break;
+        }
+    }
+
+    auto result_set::next_batch(record_batch &batch,
+                                std::size_t max_rows) noexcept
+        -> expected<std::size_t, error>
+    try {
+        IVY_SPAN("odbc.fetch_batch");
+
+        set_up_batch(batch);
+
+        auto ncolumns = _result->columns();
+        std::size_t n = 0;
+
+        while (n < max_rows && _result->next()) {
+            for (short i = 0; i < ncolumns; ++i)
+                append_cell(batch.column(i), i);
+            ++n;
+            ++*_rows;
+        }
+
+        return n;
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<query_execution_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
     row::row(nanodbc::result *result)
         : _result(result)
+        , _value(result, 0)
     {
     }
 
@@ -218,6 +1027,89 @@ namespace ivy::db::odbc {
         return make_unexpected(make_error(std::current_exception()));
     }
 
+    auto row::value_at(std::size_t column) noexcept
+        -> expected<db::value *, error>
+    {
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        _value._column_number = static_cast<short>(column);
+        return &_value;
+    }
+
+    auto row::is_null(std::size_t column) noexcept -> expected<bool, error>
+    try {
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        return _result->is_null(static_cast<short>(column));
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<db_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto row::get_int64(std::size_t column) noexcept
+        -> expected<std::int64_t, error>
+    try {
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        return _result->get<long long>(static_cast<short>(column));
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<db_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto row::get_double(std::size_t column) noexcept -> expected<double, error>
+    try {
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        return _result->get<double>(static_cast<short>(column));
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<db_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto row::get_string_view(std::size_t column) noexcept
+        -> expected<std::u16string_view, error>
+    try {
+        static_assert(sizeof(nanodbc::wide_char_t) == sizeof(char16_t));
+
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        // get_ref() assigns to _text or _narrow_text, so once they've
+        // grown to the longest value this doesn't allocate.
+        auto c = static_cast<short>(column);
+        if (is_narrow(*_result, c)) {
+            _result->get_ref(c, _narrow_text);
+            _text.clear();
+            decode_utf8(_narrow_text, [&](char32_t ch) {
+                encode_utf16(ch, std::back_inserter(_text));
+            });
+        } else
+            _result->get_ref(c, _text);
+
+        return std::u16string_view(
+            reinterpret_cast<char16_t const *>(_text.data()), _text.size());
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<db_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto row::get_datum(std::size_t column) noexcept -> expected<datum, error>
+    {
+        if (column > std::numeric_limits<short>::max())
+            return make_unexpected(make_error(std::errc::value_too_large));
+
+        return value(_result, static_cast<short>(column)).as_datum();
+    }
+
     value::value(nanodbc::result *result, short column_number)
         : _result(result)
         , _column_number(column_number)
@@ -231,23 +1123,255 @@ namespace ivy::db::odbc {
 
         auto type = _result->column_datatype(_column_number);
 
+        // Fetch each type in its native binary form, so it's only turned
+        // into text if someone calls str() on it.
         switch (type) {
-        case SQL_INTEGER:
+        case SQL_TINYINT:
         case SQL_SMALLINT:
+        case SQL_INTEGER:
+        case SQL_BIGINT:
             return make_integer_datum(
                 _result->get<std::int64_t>(_column_number));
 
         case SQL_BIT:
             return make_boolean_datum(_result->get<int>(_column_number));
 
-        default:
+        case SQL_REAL:
+        case SQL_FLOAT:
+        case SQL_DOUBLE:
+            return make_double_datum(_result->get<double>(_column_number));
+
+        case SQL_DATE:
+        case SQL_TYPE_DATE:
+            return make_date_datum(
+                to_sys_days(_result->get<nanodbc::date>(_column_number)));
+
+        case SQL_TIMESTAMP:
+        case SQL_TYPE_TIMESTAMP:
+            return make_timestamp_datum(to_sys_time(
+                _result->get<nanodbc::timestamp>(_column_number)));
+
+        case SQL_BINARY:
+        case SQL_VARBINARY:
+        case SQL_LONGVARBINARY: {
+            auto bytes =
+                _result->get<std::vector<std::uint8_t>>(_column_number);
+            return make_bytes_datum(std::as_bytes(std::span(bytes)));
+        }
+
+        case SQL_DECIMAL:
+        case SQL_NUMERIC: {
+            // Drivers agree on the text form of a decimal far more than on
+            // SQL_C_NUMERIC, which needs the precision and scale set on the
+            // descriptor first.  The text is ASCII, so parsing it directly
+            // is still much cheaper than transcoding it.
             auto str = _result->get<std::string>(_column_number);
+            if (auto d = decimal::parse(str); d)
+                return make_decimal_datum(*d);
             return make_string_datum(transcode<string>(str).or_throw());
         }
+
+        default: {
+            if (is_narrow(*_result, _column_number))
+                return make_string_datum(
+                    from_utf8(_result->get<std::string>(_column_number)));
+
+            // Fetched as SQL_C_WCHAR, so the driver does any conversion
+            // from the column's encoding, and decoded straight to UTF-32.
+            auto str = _result->get<nanodbc::wide_string>(_column_number);
+            return make_string_datum(from_utf16(std::u16string_view(
+                reinterpret_cast<char16_t const *>(str.data()), str.size())));
+        }
+        }
+    } catch (nanodbc::database_error const &e) {
+        return make_unexpected(make_error<db_error>(e.what()));
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
+    auto value::open_stream() noexcept
+        -> expected<std::unique_ptr<pmrichannel<std::byte>>, error>
+    try {
+        auto type = _result->column_datatype(_column_number);
+        bool binary = type == SQL_BINARY || type == SQL_VARBINARY ||
+                      type == SQL_LONGVARBINARY;
+
+        if (!_result->is_bound(_column_number))
+            return std::make_unique<lob_channel>(
+                _result->native_statement_handle(),
+                static_cast<unsigned short>(_column_number + 1),
+                binary ? lob_channel::mode::binary : lob_channel::mode::text);
+
+        // A bound column is already in nanodbc's buffer, and is short.
+        std::vector<std::byte> bytes;
+
+        if (_result->is_null(_column_number)) {
+            // An empty stream.
+        } else if (binary) {
+            auto v = _result->get<std::vector<std::uint8_t>>(_column_number);
+            auto b = std::as_bytes(std::span(v));
+            bytes.assign(b.begin(), b.end());
+        } else if (is_narrow(*_result, _column_number)) {
+            auto text = _result->get<std::string>(_column_number);
+            decode_utf8(text, [&](char32_t c) {
+                encode_utf8(c, std::back_inserter(bytes));
+            });
+        } else {
+            auto text = _result->get<nanodbc::wide_string>(_column_number);
+            decode_utf16(
+                std::u16string_view(
+                    reinterpret_cast<char16_t const *>(text.data()),
+                    text.size()),
+                [&](char32_t c) { encode_utf8(c, std::back_inserter(bytes)); });
+        }
+
+        return std::make_unique<lob_channel>(std::move(bytes));
     } catch (nanodbc::database_error const &e) {
         return make_unexpected(make_error<db_error>(e.what()));
     } catch (...) {
         return make_unexpected(make_error(std::current_exception()));
     }
 
+    /*************************************************************************
+     *
+     * lob_channel
+     */
+
+    namespace {
+
+        // Characters fetched by each SQLGetData() call for text.
+        constexpr std::size_t lob_chunk_chars = 4096;
+
+        auto statement_error(void *statement) -> error
+        {
+            return make_error<db_error>(
+                nanodbc::database_error(statement, SQL_HANDLE_STMT).what());
+        }
+
+    } // namespace
+
+    lob_channel::lob_channel(void *statement,
+                             unsigned short column,
+                             mode mode)
+        : _statement(statement)
+        , _column(column)
+        , _mode(mode)
+    {
+    }
+
+    lob_channel::lob_channel(std::vector<std::byte> value)
+        : _statement(nullptr)
+        , _column(0)
+        , _mode(mode::buffered)
+        , _done(true)
+        , _pending(std::move(value))
+    {
+    }
+
+    auto lob_channel::read_binary(std::span<std::byte> buf)
+        -> expected<io_size_t, error>
+    {
+        SQLLEN indicator = 0;
+        auto rc = SQLGetData(_statement,
+                             _column,
+                             SQL_C_BINARY,
+                             buf.data(),
+                             static_cast<SQLLEN>(buf.size()),
+                             &indicator);
+
+        if (rc == SQL_NO_DATA || indicator == SQL_NULL_DATA) {
+            _done = true;
+            return make_unexpected(make_error(errc::end_of_file));
+        }
+
+        if (!SQL_SUCCEEDED(rc))
+            return make_unexpected(statement_error(_statement));
+
+        // If the value didn't fit, the buffer is full and the indicator is
+        // the length left before this call, if the driver knows it.
+        if (indicator == SQL_NO_TOTAL ||
+            static_cast<std::size_t>(indicator) > buf.size())
+            return buf.size();
+
+        _done = true;
+        if (indicator == 0)
+            return make_unexpected(make_error(errc::end_of_file));
+        return static_cast<io_size_t>(indicator);
+    }
+
+    auto lob_channel::fetch_text() -> expected<void, error>
+    {
+        static_assert(sizeof(SQLWCHAR) == sizeof(char16_t));
+
+        // One more for the terminator, which SQLGetData() always writes.
+        _chunk.resize(lob_chunk_chars + 1);
+
+        SQLLEN indicator = 0;
+        auto rc = SQLGetData(
+            _statement,
+            _column,
+            SQL_C_WCHAR,
+            _chunk.data(),
+            static_cast<SQLLEN>(_chunk.size() * sizeof(char16_t)),
+            &indicator);
+
+        std::size_t nchars = 0;
+
+        if (rc == SQL_NO_DATA || indicator == SQL_NULL_DATA)
+            _done = true;
+        else if (!SQL_SUCCEEDED(rc))
+            return make_unexpected(statement_error(_statement));
+        else if (indicator == SQL_NO_TOTAL ||
+                 static_cast<std::size_t>(indicator) >
+                     lob_chunk_chars * sizeof(char16_t))
+            nchars = lob_chunk_chars;
+        else {
+            nchars = static_cast<std::size_t>(indicator) / sizeof(char16_t);
+            _done = true;
+        }
+
+        _pending.clear();
+        _pending_pos = 0;
+
+        auto emit = [&](char32_t c) {
+            encode_utf8(c, std::back_inserter(_pending));
+        };
+
+        for (std::size_t i = 0; i < nchars; ++i)
+            _decoder.put(_chunk[i], emit);
+
+        if (_done)
+            _decoder.finish(emit);
+
+        return {};
+    }
+
+    auto lob_channel::read(std::span<std::byte> buf) noexcept
+        -> expected<io_size_t, error>
+    try {
+        if (buf.empty())
+            return 0u;
+
+        if (_mode == mode::binary) {
+            if (_done)
+                return make_unexpected(make_error(errc::end_of_file));
+            return read_binary(buf);
+        }
+
+        while (_pending_pos == _pending.size()) {
+            if (_done)
+                return make_unexpected(make_error(errc::end_of_file));
+
+            if (auto r = fetch_text(); !r)
+                return make_unexpected(r.error());
+        }
+
+        auto n = std::min(buf.size(), _pending.size() - _pending_pos);
+        std::memcpy(buf.data(), _pending.data() + _pending_pos, n);
+        _pending_pos += n;
+        return n;
+    } catch (...) {
+        return make_unexpected(make_error(std::current_exception()));
+    }
+
 } // namespace ivy::db::odbc
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/datum.hxx>
+#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/column.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/hash.hxx>
+
+// Creating and comparing 10M datums, about what a large query result
+// produces.
+TEST_CASE("ivy:datum:bench", "[ivy][datum][!benchmark]")
+{
+    constexpr std::size_t n = 10'000'000;
+
+    std::vector<ivy::datum> values;
+    values.reserve(n);
+
+    BENCHMARK("make_integer_datum")
+    {
+        values.clear();
+        for (std::size_t i = 0; i < n; ++i)
+            values.push_back(
+                ivy::make_integer_datum(static_cast<std::int64_t>(i)));
+        return values.size();
+    };
+
+    BENCHMARK("make mixed datums")
+    {
+        ivy::string s(U"value");
+
+        values.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            switch (i % 4) {
+            case 0:
+                values.push_back(
+                    ivy::make_integer_datum(static_cast<std::int64_t>(i)));
+                break;
+            case 1:
+                values.push_back(ivy::make_boolean_datum(i & 2));
+                break;
+            case 2:
+                values.push_back(ivy::make_null_datum());
+                break;
+            case 3:
+                values.push_back(ivy::make_string_datum(s));
+                break;
+            }
+        }
+        return values.size();
+    };
+
+    // 'values' holds the mixed datums from here on.
+    auto copy = values;
+
+    BENCHMARK("operator==")
+    {
+        std::size_t equal = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            equal += values[i] == copy[n - i - 1];
+        return equal;
+    };
+
+    BENCHMARK("datum_cast<std::int64_t>")
+    {
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < n; i += 4)
+            sum += ivy::datum_cast<std::int64_t>(values[i]);
+        return sum;
+    };
+}
+
+// The same filter and hash over a vector of datums and over a datum_column.
+TEST_CASE("ivy:datum_column:bench", "[ivy][datum][!benchmark]")
+{
+    constexpr std::size_t n = 10'000'000;
+
+    std::vector<ivy::datum> values;
+    values.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        values.push_back(i % 16 == 0 ? ivy::make_null_datum()
+                                     : ivy::make_integer_datum(
+                                           static_cast<std::int64_t>(i % 1000)));
+
+    auto column = *ivy::make_datum_column(values);
+    auto limit = ivy::make_integer_datum(500);
+    std::vector<std::size_t> hashes(n);
+
+    BENCHMARK("vector<datum>: count < 500")
+    {
+        std::size_t count = 0;
+        for (auto &&v : values)
+            count += v.get_kind() == ivy::datum::kind::integer &&
+                     ivy::datum_cast<std::int64_t>(v) < 500;
+        return count;
+    };
+
+    BENCHMARK("datum_column: count < 500")
+    {
+        return ivy::compare(column, ivy::compare_op::less, limit)->count();
+    };
+
+    BENCHMARK("vector<datum>: hash")
+    {
+        ivy::hash<std::int64_t> h;
+        for (std::size_t i = 0; i < n; ++i)
+            hashes[i] = values[i].get_kind() == ivy::datum::kind::integer
+                          ? h(ivy::datum_cast<std::int64_t>(values[i]))
+                          : 0;
+        return hashes[n - 1];
+    };
+
+    BENCHMARK("datum_column: hash")
+    {
+        column.hash(hashes);
+        return hashes[n - 1];
+    };
+
+    BENCHMARK("make_datum_column")
+    {
+        return ivy::make_datum_column(values)->size();
+    };
+}
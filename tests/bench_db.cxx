@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/db.hxx>
+
+// Reading 1M rows from the in-memory driver, which measures the cost of
+// the ivy::db interfaces without a database behind them.
+TEST_CASE("ivy:db:bench", "[ivy][db][!benchmark]")
+{
+    using ivy::db::column_type;
+
+    std::vector<ivy::db::memory::column_spec> columns{
+        {"i", column_type::int64},
+        {"d", column_type::float64, 0.1},
+        {"s", column_type::utf8},
+    };
+
+    auto db = std::make_shared<ivy::db::memory::database>();
+    db->add_table(u"t", ivy::db::memory::generate_table(columns, 1'000'000));
+    auto conn = ivy::db::memory::connect(db).or_throw();
+    auto query = conn->prepare_query(u"t").or_throw();
+
+    BENCHMARK("values() and as_datum()")
+    {
+        std::size_t cells = 0;
+        auto result = query->execute().or_throw();
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows())
+                for (auto &&value : row.values()) {
+                    value.as_datum().or_throw();
+                    ++cells;
+                }
+        return cells;
+    };
+
+    BENCHMARK("get_datum()")
+    {
+        std::size_t cells = 0;
+        auto result = query->execute().or_throw();
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows())
+                for (std::size_t i = 0; i < 3; ++i) {
+                    row.get_datum(i).or_throw();
+                    ++cells;
+                }
+        return cells;
+    };
+
+    BENCHMARK("typed getters")
+    {
+        std::int64_t sum = 0;
+        auto result = query->execute().or_throw();
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows()) {
+                sum += row.get_int64(0).or_throw();
+                if (!row.is_null(1).or_throw())
+                    sum += static_cast<std::int64_t>(
+                        row.get_double(1).or_throw());
+                sum += static_cast<std::int64_t>(
+                    row.get_string_view(2).or_throw().size());
+            }
+        return sum;
+    };
+
+    ivy::db::record_batch batch;
+
+    BENCHMARK("next_batch(), 1000 rows")
+    {
+        std::int64_t sum = 0;
+        auto result = query->execute().or_throw();
+        for (auto &&rs : result->result_sets())
+            while (rs.next_batch(batch, 1000).or_throw() > 0) {
+                for (auto i : batch.column(0).int64s())
+                    sum += i;
+                for (auto d : batch.column(1).doubles())
+                    sum += static_cast<std::int64_t>(d);
+                sum += static_cast<std::int64_t>(batch.column(2).data().size());
+            }
+        return sum;
+    };
+}
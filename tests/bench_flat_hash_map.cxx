@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/flat_hash_map.hxx>
+#include <ivy/hash.hxx>
+#include <ivy/string.hxx>
+
+/*
+ * flat_hash_map against std::unordered_map, with the same hash, for tables
+ * of 1K to 10M entries.  Each benchmark looks up a fixed number of keys,
+ * half of them present, in random order.  String tables stop at 1M entries
+ * since 10M strings take several gigabytes.
+ */
+
+namespace {
+
+    constexpr std::size_t lookups = 1 << 16;
+
+    template <typename Map, typename Key>
+    auto build(std::vector<Key> const &keys) -> Map
+    {
+        Map map;
+        map.reserve(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            map.emplace(keys[i], i);
+        return map;
+    }
+
+    template <typename Map, typename Key>
+    auto count_found(Map const &map, std::vector<Key> const &probes)
+        -> std::size_t
+    {
+        std::size_t found = 0;
+        for (auto &&k : probes)
+            found += map.find(k) != map.end();
+        return found;
+    }
+
+    // Keys 0..n-1 spread over the 64-bit range, and probes which are half
+    // hits, half misses.
+    auto integer_keys(std::size_t n, std::vector<std::uint64_t> &probes)
+        -> std::vector<std::uint64_t>
+    {
+        std::vector<std::uint64_t> keys(n);
+        for (std::size_t i = 0; i < n; ++i)
+            keys[i] = i * 0x9E3779B97F4A7C15ull;
+
+        std::mt19937_64 rng(1);
+        probes.resize(lookups);
+        for (auto &p : probes)
+            p = keys[rng() % n] + (rng() & 1);
+
+        return keys;
+    }
+
+    auto string_keys(std::size_t n, std::vector<ivy::u8string> &probes)
+        -> std::vector<ivy::u8string>
+    {
+        auto make = [](std::size_t i) {
+            std::u8string s(u8"column_name_");
+            for (char c : std::to_string(i))
+                s.push_back(static_cast<char8_t>(c));
+            return ivy::u8string(s.begin(), s.end());
+        };
+
+        std::vector<ivy::u8string> keys;
+        keys.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            keys.push_back(make(i));
+
+        std::mt19937_64 rng(1);
+        probes.clear();
+        for (std::size_t i = 0; i < lookups; ++i)
+            probes.push_back(make(rng() % (2 * n)));
+
+        return keys;
+    }
+
+} // namespace
+
+TEST_CASE("ivy:flat_hash_map:bench:integer", "[ivy][flat_hash_map][!benchmark]")
+{
+    using hash = ivy::hash<std::uint64_t, ivy::fast_hash_policy>;
+
+    auto n = GENERATE(std::size_t(1000),
+                      std::size_t(100000),
+                      std::size_t(1000000),
+                      std::size_t(10000000));
+
+    std::vector<std::uint64_t> probes;
+    auto keys = integer_keys(n, probes);
+
+    auto std_map =
+        build<std::unordered_map<std::uint64_t, std::size_t, hash>>(keys);
+    auto flat_map =
+        build<ivy::flat_hash_map<std::uint64_t, std::size_t, hash>>(keys);
+
+    REQUIRE(count_found(std_map, probes) == count_found(flat_map, probes));
+
+    BENCHMARK("std::unordered_map find, " + std::to_string(n))
+    {
+        return count_found(std_map, probes);
+    };
+
+    BENCHMARK("ivy::flat_hash_map find, " + std::to_string(n))
+    {
+        return count_found(flat_map, probes);
+    };
+
+    if (n <= 100000) {
+        BENCHMARK("std::unordered_map insert, " + std::to_string(n))
+        {
+            return build<std::unordered_map<std::uint64_t, std::size_t, hash>>(
+                       keys)
+                .size();
+        };
+
+        BENCHMARK("ivy::flat_hash_map insert, " + std::to_string(n))
+        {
+            return build<ivy::flat_hash_map<std::uint64_t, std::size_t, hash>>(
+                       keys)
+                .size();
+        };
+    }
+}
+
+TEST_CASE("ivy:flat_hash_map:bench:string", "[ivy][flat_hash_map][!benchmark]")
+{
+    using hash = ivy::hash<ivy::u8string, ivy::fast_hash_policy>;
+
+    auto n =
+        GENERATE(std::size_t(1000), std::size_t(100000), std::size_t(1000000));
+
+    std::vector<ivy::u8string> probes;
+    auto keys = string_keys(n, probes);
+
+    auto std_map =
+        build<std::unordered_map<ivy::u8string, std::size_t, hash>>(keys);
+    auto flat_map =
+        build<ivy::flat_hash_map<ivy::u8string, std::size_t, hash>>(keys);
+
+    REQUIRE(count_found(std_map, probes) == count_found(flat_map, probes));
+
+    BENCHMARK("std::unordered_map find, " + std::to_string(n))
+    {
+        return count_found(std_map, probes);
+    };
+
+    BENCHMARK("ivy::flat_hash_map find, " + std::to_string(n))
+    {
+        return count_found(flat_map, probes);
+    };
+
+    // Looking up by a plain character array: std::unordered_map needs a
+    // u8string, flat_hash_map doesn't.
+    std::vector<std::u8string> raw;
+    for (auto &&p : probes)
+        raw.emplace_back(p.begin(), p.end());
+
+    BENCHMARK("std::unordered_map find by char8_t *, " + std::to_string(n))
+    {
+        std::size_t found = 0;
+        for (auto &&k : raw)
+            found += std_map.find(ivy::u8string(k.c_str())) != std_map.end();
+        return found;
+    };
+
+    BENCHMARK("ivy::flat_hash_map find by char8_t *, " + std::to_string(n))
+    {
+        std::size_t found = 0;
+        for (auto &&k : raw)
+            found += flat_map.contains(k.c_str());
+        return found;
+    };
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/hash.hxx>
+#include <ivy/siphash.hxx>
+#include <ivy/string.hxx>
+
+TEST_CASE("ivy:siphash:bench", "[ivy][hash][!benchmark]")
+{
+    // Short keys, as found in hash tables.
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1024; ++i)
+        keys.push_back("column_" + std::to_string(i * 7919));
+
+    std::vector<std::span<std::byte const>> inputs;
+    for (auto &&k : keys)
+        inputs.push_back(std::as_bytes(std::span(k)));
+
+    auto const &raw_key = ivy::detail::get_sip_hash_key();
+    ivy::siphash_key key(raw_key);
+    std::vector<std::uint64_t> out(inputs.size());
+
+    BENCHMARK("siphash, key bytes")
+    {
+        std::byte hash[8];
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            ivy::siphash<>(inputs[i], raw_key, hash);
+            out[i] = ivy::detail::sip_u8u64le(hash);
+        }
+        return out[0];
+    };
+
+    BENCHMARK("siphash64, precomputed key")
+    {
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+            out[i] = ivy::siphash64(inputs[i], key);
+        return out[0];
+    };
+
+    BENCHMARK("siphash_many")
+    {
+        ivy::siphash_many(inputs, key, out);
+        return out[0];
+    };
+
+    BENCHMARK("siphash_many, 1-3")
+    {
+        ivy::siphash_many<1, 3>(inputs, key, out);
+        return out[0];
+    };
+}
+
+TEST_CASE("ivy:hash:policy:bench", "[ivy][hash][!benchmark]")
+{
+    std::vector<ivy::u8string> keys;
+    for (int i = 0; i < 1024; ++i) {
+        std::u8string key(u8"option_name_");
+        for (char c : std::to_string(i * 7919))
+            key.push_back(static_cast<char8_t>(c));
+        keys.emplace_back(key);
+    }
+
+    std::size_t total = 0;
+
+    BENCHMARK("string, sip_hash_policy")
+    {
+        ivy::hash<ivy::u8string> h;
+        for (auto &&k : keys)
+            total += h(k);
+        return total;
+    };
+
+    BENCHMARK("string, fast_hash_policy")
+    {
+        ivy::hash<ivy::u8string, ivy::fast_hash_policy> h;
+        for (auto &&k : keys)
+            total += h(k);
+        return total;
+    };
+
+    BENCHMARK("int, sip_hash_policy")
+    {
+        ivy::hash<int> h;
+        for (int i = 0; i < 1024; ++i)
+            total += h(i);
+        return total;
+    };
+
+    BENCHMARK("int, fast_hash_policy")
+    {
+        ivy::hash<int, ivy::fast_hash_policy> h;
+        for (int i = 0; i < 1024; ++i)
+            total += h(i);
+        return total;
+    };
+}
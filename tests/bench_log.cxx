@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/log.hxx>
+#include <ivy/log/mmap_segment_sink.hxx>
+
+namespace {
+
+    // A sink which discards everything, so we measure the logger and not
+    // the output.
+    struct null_sink final : ivy::log::sink {
+        auto log_message(std::chrono::system_clock::time_point,
+                         ivy::log::severity_code,
+                         std::string_view) -> void override
+        {
+        }
+    };
+
+} // namespace
+
+TEST_CASE("ivy:log:bench", "[ivy][log][!benchmark]")
+{
+    ivy::log::logger log;
+    log.add_sink(std::make_unique<null_sink>());
+    log.start_async({.overflow = ivy::log::overflow_policy::drop});
+
+    std::string user("anonymous");
+    int status = 200;
+    double elapsed = 1.25;
+
+    // The previous implementation: format on the calling thread, then queue
+    // the text.
+    BENCHMARK("eager format")
+    {
+        log.log_message(
+            ivy::log::severity_code::info,
+            std::format("request from {} done: status={} elapsed={:.3f}ms",
+                        user,
+                        status,
+                        elapsed));
+    };
+
+    BENCHMARK("deferred format")
+    {
+        log.log(ivy::log::severity_code::info,
+                "request from {} done: status={} elapsed={:.3f}ms",
+                user,
+                status,
+                elapsed);
+    };
+
+    log.stop_async();
+}
+
+TEST_CASE("ivy:log:mmap_segment_sink:bench", "[ivy][log][!benchmark]")
+{
+    auto dir = std::filesystem::temp_directory_path() / "ivy_bench_log_segment";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto sink = ivy::log::make_mmap_segment_sink(
+                    {.directory = dir, .max_segments = 2})
+                    .or_throw();
+
+    std::vector<ivy::log::record> batch(
+        512,
+        ivy::log::record{std::chrono::system_clock::now(),
+                         ivy::log::severity_code::info,
+                         "request from anonymous done: status=200"});
+
+    // One batch, as passed by the async logger; divide by 512 for the
+    // per-record cost.
+    BENCHMARK("512 records")
+    {
+        sink->log_records(batch);
+    };
+
+    sink.reset();
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/datum/double.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/db.hxx>
+#include <ivy/db/odbc/connection.hxx>
+#include <ivy/string.hxx>
+#include <ivy/string/transcode.hxx>
+
+/*
+ * These benchmarks need a database.  Set IVY_BENCH_ODBC to an ODBC
+ * connection string, e.g. for the SQLite ODBC driver:
+ *
+ *   IVY_BENCH_ODBC=Driver=SQLite3 ODBC Driver;Database=:memory:
+ *
+ * IVY_BENCH_ODBC_QUERY can replace the query, which by default generates
+ * 1M rows with a recursive CTE.
+ *
+ * The insert benchmark creates and drops a table called ivy_bench_insert.
+ */
+
+namespace {
+
+    auto get_env(char const *name) -> std::optional<std::string>
+    {
+#ifdef _WIN32
+        std::size_t size{};
+        if (getenv_s(&size, nullptr, 0, name) != 0 || size == 0)
+            return {};
+
+        std::string value(size, '\0');
+        if (getenv_s(&size, value.data(), value.size(), name) != 0)
+            return {};
+
+        value.resize(size - 1);
+        return value;
+#else
+        char const *s = std::getenv(name);
+        if (s == nullptr)
+            return {};
+        return std::string(s);
+#endif
+    }
+
+    auto to_u16(std::string const &s) -> ivy::u16string
+    {
+        return ivy::transcode<ivy::u16string>(s).or_throw();
+    }
+
+    constexpr char default_query[] =
+        "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n "
+        "WHERE i < 1000000) "
+        "SELECT i, i * 2.5, 'row ' || i FROM n";
+
+} // namespace
+
+// Fetching 1M rows with different rowset sizes.
+TEST_CASE("ivy:odbc:fetch:bench", "[ivy][odbc][!benchmark]")
+{
+    auto connstr = get_env("IVY_BENCH_ODBC");
+    if (!connstr) {
+        WARN("IVY_BENCH_ODBC is not set; skipping ODBC benchmarks");
+        return;
+    }
+
+    auto custom_query = get_env("IVY_BENCH_ODBC_QUERY");
+    auto query_text = to_u16(custom_query.value_or(default_query));
+
+    ivy::db::odbc::connection conn;
+    conn.connect(to_u16(*connstr)).or_throw();
+
+    auto fetch_all = [&](std::size_t rowset_size) {
+        conn.set_rowset_size(rowset_size);
+
+        auto query = conn.prepare_query(query_text).or_throw();
+        auto result = query->execute().or_throw();
+
+        std::size_t cells = 0;
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows())
+                for (auto &&value : row.values()) {
+                    value.as_datum().or_throw();
+                    ++cells;
+                }
+
+        return cells;
+    };
+
+    BENCHMARK("rowset size 1")
+    {
+        return fetch_all(1);
+    };
+
+    BENCHMARK("rowset size 100")
+    {
+        return fetch_all(100);
+    };
+
+    BENCHMARK("rowset size 1000")
+    {
+        return fetch_all(1000);
+    };
+
+    // The typed getters need to know the column types, so this only runs
+    // with the default query.
+    if (custom_query)
+        return;
+
+    BENCHMARK("rowset size 1000, typed getters")
+    {
+        conn.set_rowset_size(1000);
+
+        auto query = conn.prepare_query(query_text).or_throw();
+        auto result = query->execute().or_throw();
+
+        std::int64_t isum = 0;
+        double dsum = 0;
+        std::size_t chars = 0;
+
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows()) {
+                isum += row.get_int64(0).or_throw();
+                dsum += row.get_double(1).or_throw();
+                chars += row.get_string_view(2).or_throw().size();
+            }
+
+        return isum + static_cast<std::int64_t>(dsum) +
+               static_cast<std::int64_t>(chars);
+    };
+}
+
+// Reading the default query's 1M rows column by column, through rows(),
+// as record batches, and as record batches fetched ahead on a worker
+// thread.
+TEST_CASE("ivy:odbc:batch:bench", "[ivy][odbc][!benchmark]")
+{
+    auto connstr = get_env("IVY_BENCH_ODBC");
+    if (!connstr) {
+        WARN("IVY_BENCH_ODBC is not set; skipping ODBC benchmarks");
+        return;
+    }
+
+    ivy::db::odbc::connection conn;
+    conn.connect(to_u16(*connstr)).or_throw();
+    conn.set_rowset_size(1000);
+
+    auto query_text = to_u16(default_query);
+
+    BENCHMARK("rows()")
+    {
+        auto query = conn.prepare_query(query_text).or_throw();
+        auto result = query->execute().or_throw();
+
+        std::int64_t isum = 0;
+        double dsum = 0;
+        std::size_t chars = 0;
+
+        for (auto &&rs : result->result_sets())
+            for (auto &&row : rs.rows()) {
+                isum += row.get_int64(0).or_throw();
+                dsum += row.get_double(1).or_throw();
+                chars += row.get_string_view(2).or_throw().size();
+            }
+
+        return isum + static_cast<std::int64_t>(dsum) +
+               static_cast<std::int64_t>(chars);
+    };
+
+    // The driver may describe i * 2.5 as text, so don't assume the column
+    // types.
+    auto sum_batch = [](ivy::db::record_batch const &batch) {
+        std::int64_t sum = 0;
+
+        auto const &ints = batch.column(0);
+        if (ints.type() == ivy::db::column_type::int64)
+            for (auto i : ints.int64s())
+                sum += i;
+
+        auto const &reals = batch.column(1);
+        if (reals.type() == ivy::db::column_type::float64)
+            for (auto d : reals.doubles())
+                sum += static_cast<std::int64_t>(d);
+
+        return sum + static_cast<std::int64_t>(batch.column(2).data().size());
+    };
+
+    ivy::db::record_batch batch;
+
+    BENCHMARK("next_batch(), 1000 rows")
+    {
+        auto query = conn.prepare_query(query_text).or_throw();
+        auto result = query->execute().or_throw();
+
+        std::int64_t sum = 0;
+        for (auto &&rs : result->result_sets())
+            while (rs.next_batch(batch, 1000).or_throw() > 0)
+                sum += sum_batch(batch);
+
+        return sum;
+    };
+
+    ivy::db::worker_pool pool(1);
+
+    BENCHMARK("batch_reader, 1000 rows")
+    {
+        auto query = conn.prepare_query(query_text).or_throw();
+        auto result = ivy::db::execute_async(pool, *query).get().or_throw();
+
+        std::int64_t sum = 0;
+        for (auto &&rs : result->result_sets()) {
+            ivy::db::batch_reader reader(pool, rs, 1000);
+            while (auto next = reader.next().or_throw())
+                sum += sum_batch(*next);
+        }
+
+        return sum;
+    };
+}
+
+// Preparing and running a small query, with and without the statement
+// cache.
+TEST_CASE("ivy:odbc:prepare:bench", "[ivy][odbc][!benchmark]")
+{
+    auto connstr = get_env("IVY_BENCH_ODBC");
+    if (!connstr) {
+        WARN("IVY_BENCH_ODBC is not set; skipping ODBC benchmarks");
+        return;
+    }
+
+    ivy::db::odbc::connection conn;
+    conn.connect(to_u16(*connstr)).or_throw();
+
+    auto sql = to_u16("SELECT 1");
+    auto run = [&] {
+        auto query = conn.prepare_query(sql).or_throw();
+        query->execute().or_throw();
+    };
+
+    conn.set_statement_cache_size(0);
+    BENCHMARK("uncached")
+    {
+        return run();
+    };
+
+    conn.set_statement_cache_size(ivy::db::odbc::default_statement_cache_size);
+    BENCHMARK("cached")
+    {
+        return run();
+    };
+}
+
+// Inserting 100K rows, one statement per row and as arrays of parameters.
+TEST_CASE("ivy:odbc:insert:bench", "[ivy][odbc][!benchmark]")
+{
+    auto connstr = get_env("IVY_BENCH_ODBC");
+    if (!connstr) {
+        WARN("IVY_BENCH_ODBC is not set; skipping ODBC benchmarks");
+        return;
+    }
+
+    ivy::db::odbc::connection conn;
+    conn.connect(to_u16(*connstr)).or_throw();
+
+    auto run = [&](std::string const &sql) {
+        conn.prepare_query(to_u16(sql)).or_throw()->execute().or_throw();
+    };
+
+    if (auto q = conn.prepare_query(to_u16("DROP TABLE ivy_bench_insert")))
+        (void)(*q)->execute();
+    run("CREATE TABLE ivy_bench_insert "
+        "(i INTEGER, d DOUBLE PRECISION, s VARCHAR(32))");
+
+    constexpr std::size_t nrows = 100000;
+    std::vector<ivy::datum> is, ds, ss;
+    for (std::size_t i = 0; i < nrows; ++i) {
+        auto n = static_cast<std::int64_t>(i);
+        is.push_back(ivy::make_integer_datum(n));
+        ds.push_back(ivy::make_double_datum(n * 2.5));
+        ss.push_back(ivy::make_string_datum(
+            ivy::transcode<ivy::string>("row " + std::to_string(i))
+                .or_throw()));
+    }
+
+    auto insert_sql = to_u16("INSERT INTO ivy_bench_insert VALUES (?, ?, ?)");
+    auto insert = conn.prepare_query(insert_sql).or_throw();
+
+    BENCHMARK("one row at a time")
+    {
+        run("DELETE FROM ivy_bench_insert");
+        for (std::size_t i = 0; i < nrows; ++i) {
+            insert->bind(0, is[i]).or_throw();
+            insert->bind(1, ds[i]).or_throw();
+            insert->bind(2, ss[i]).or_throw();
+            insert->execute().or_throw();
+        }
+    };
+
+    BENCHMARK("array of parameters")
+    {
+        run("DELETE FROM ivy_bench_insert");
+        insert->bind_array(0, is).or_throw();
+        insert->bind_array(1, ds).or_throw();
+        insert->bind_array(2, ss).or_throw();
+        insert->execute().or_throw();
+    };
+
+    insert->clear_bindings();
+    run("DROP TABLE ivy_bench_insert");
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/trace.hxx>
+
+#ifdef IVY_ENABLE_TRACING
+
+TEST_CASE("ivy:trace:bench", "[ivy][trace][!benchmark]")
+{
+    std::string name("item");
+    int line = 42;
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+
+    BENCHMARK("disabled")
+    {
+        IVY_TRACE("config: parse_item: name=[{}] line={}", name, line);
+    };
+
+    ivy::set_trace_mode(ivy::trace_mode::buffer);
+
+    BENCHMARK("buffer")
+    {
+        IVY_TRACE("config: parse_item: name=[{}] line={}", name, line);
+    };
+
+    BENCHMARK("span")
+    {
+        IVY_SPAN("bench.span");
+    };
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+}
+
+#endif // IVY_ENABLE_TRACING
@@ -3,12 +3,17 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <cstddef>
+#include <iterator>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
 #include <ivy/algorithm/bintext.hxx>
 #include <ivy/charenc/icu/ucnv.hxx>
+#include <ivy/charenc/utf.hxx>
 #include <ivy/string.hxx>
 #include <ivy/string/transcode.hxx>
 
@@ -293,3 +298,81 @@ TEST_CASE("ivy:utf-16be invalid", "[ivy][string][charenc][utf16]")
         REQUIRE(!s);
     }
 }
+
+TEST_CASE("ivy:utf: encode and decode", "[ivy][charenc][utf]")
+{
+    std::u32string chars(U"a\u00e9\u20ac\U0001F600");
+
+    std::string utf8;
+    std::u16string utf16;
+    for (auto c : chars) {
+        ivy::encode_utf8(c, std::back_inserter(utf8));
+        ivy::encode_utf16(c, std::back_inserter(utf16));
+    }
+
+    REQUIRE(utf8 == "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+    REQUIRE(utf16 == u"a\u00e9\u20ac\U0001F600");
+
+    std::u32string from8, from16;
+    ivy::decode_utf8(utf8, [&](char32_t c) { from8.push_back(c); });
+    ivy::decode_utf16(utf16, [&](char32_t c) { from16.push_back(c); });
+    REQUIRE(from8 == chars);
+    REQUIRE(from16 == chars);
+
+    // Bytes can be written to any byte-sized type.
+    std::vector<std::byte> bytes;
+    ivy::encode_utf8(U'\u00e9', std::back_inserter(bytes));
+    REQUIRE(bytes == std::vector{std::byte{0xC3}, std::byte{0xA9}});
+}
+
+TEST_CASE("ivy:utf: malformed input", "[ivy][charenc][utf]")
+{
+    auto from8 = [](std::string_view s) {
+        std::u32string ret;
+        ivy::decode_utf8(s, [&](char32_t c) { ret.push_back(c); });
+        return ret;
+    };
+
+    auto from16 = [](std::u16string_view s) {
+        std::u32string ret;
+        ivy::decode_utf16(s, [&](char32_t c) { ret.push_back(c); });
+        return ret;
+    };
+
+    // A stray continuation byte, a truncated sequence, an overlong
+    // encoding and an encoded surrogate.
+    REQUIRE(from8("a\x80" "b") == U"a\uFFFDb");
+    REQUIRE(from8("a\xE2\x82") == U"a\uFFFD\uFFFD");
+    REQUIRE(from8("\xC0\xAF") == U"\uFFFD");
+    REQUIRE(from8("\xED\xA0\x80") == U"\uFFFD");
+
+    // Unpaired surrogates.
+    REQUIRE(from16(std::u16string{u'a', 0xD800, u'b'}) == U"a\uFFFDb");
+    REQUIRE(from16(std::u16string{0xDC00, u'b'}) == U"\uFFFDb");
+    REQUIRE(from16(std::u16string{u'a', 0xD800}) == U"a\uFFFD");
+
+    std::string utf8;
+    ivy::encode_utf8(0xD800, std::back_inserter(utf8));
+    ivy::encode_utf8(0x110000, std::back_inserter(utf8));
+    REQUIRE(utf8 == "\xEF\xBF\xBD\xEF\xBF\xBD");
+}
+
+TEST_CASE("ivy:utf: utf16_decoder", "[ivy][charenc][utf]")
+{
+    std::u16string text(u"x\U0001F600y");
+    REQUIRE(text.size() == 4);
+
+    // A surrogate pair split between two pieces is still one character.
+    ivy::utf16_decoder decoder;
+    std::u32string chars;
+    auto emit = [&](char32_t c) { chars.push_back(c); };
+
+    decoder.put(text[0], emit);
+    decoder.put(text[1], emit);
+    REQUIRE(chars == U"x");
+
+    decoder.put(text[2], emit);
+    decoder.put(text[3], emit);
+    decoder.finish(emit);
+    REQUIRE(chars == U"x\U0001F600y");
+}
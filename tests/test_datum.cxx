@@ -3,6 +3,8 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <chrono>
+
 #include <catch2/catch.hpp>
 
 #include <ivy/datum.hxx>
@@ -10,6 +12,11 @@
 #include <ivy/datum/string.hxx>
 #include <ivy/datum/null.hxx>
 #include <ivy/datum/boolean.hxx>
+#include <ivy/datum/bytes.hxx>
+#include <ivy/datum/date.hxx>
+#include <ivy/datum/decimal.hxx>
+#include <ivy/datum/double.hxx>
+#include <ivy/datum/timestamp.hxx>
 #include <ivy/string/transcode.hxx>
 
 TEST_CASE("ivy:datum:str", "[ivy][datum]") {
@@ -72,3 +79,192 @@ TEST_CASE("ivy:datum:datum_cast", "[ivy][datum]")
     REQUIRE(is<ivy::boolean_type>(b));
     REQUIRE(ivy::datum_cast<bool>(b) == true);
 }
+
+namespace {
+
+    // A type which isn't built in, to check that custom types still work.
+    class point_type final : public ivy::datum_type {
+    public:
+        struct point {
+            int x, y;
+        };
+
+        auto get() const noexcept -> ivy::datum_type const * final
+        {
+            static point_type type;
+            return &type;
+        }
+
+        auto name() const noexcept -> char const * final
+        {
+            return "point";
+        }
+
+        auto str(std::any const &v) const -> ivy::string final
+        {
+            auto p = std::any_cast<point>(v);
+            return ivy::string(p.x == p.y ? U"diagonal" : U"point");
+        }
+
+        auto equal(std::any const &a, std::any const &b) const -> bool final
+        {
+            auto pa = std::any_cast<point>(a), pb = std::any_cast<point>(b);
+            return pa.x == pb.x && pa.y == pb.y;
+        }
+    };
+
+} // namespace
+
+TEST_CASE("ivy:datum:representation", "[ivy][datum]")
+{
+    if constexpr (sizeof(void *) == 8)
+        REQUIRE(sizeof(ivy::datum) == 16);
+
+    ivy::datum d;
+    REQUIRE(is<ivy::null_type>(d));
+    REQUIRE(d == ivy::make_null_datum());
+
+    // Built-in types given as std::any are stored inline.
+    ivy::datum i(ivy::get_integer_type(), std::int64_t(7));
+    REQUIRE(i.get_kind() == ivy::datum::kind::integer);
+    REQUIRE(i == ivy::make_integer_datum(7));
+    REQUIRE_THROWS_AS(ivy::datum(ivy::get_integer_type(), 7),
+                      ivy::bad_datum_cast);
+
+    // Copies of a string share it.
+    ivy::datum s = ivy::make_string_datum(U"shared");
+    ivy::datum s2 = s;
+    REQUIRE(ivy::datum_cast<ivy::string>(&s) ==
+            ivy::datum_cast<ivy::string>(&s2));
+
+    s = i;
+    REQUIRE(s == i);
+    REQUIRE(str(s2) == U"shared");
+
+    ivy::datum moved = std::move(s2);
+    REQUIRE(str(moved) == U"shared");
+    REQUIRE(ivy::datum_cast<std::int64_t>(&moved) == nullptr);
+    REQUIRE_THROWS_AS(ivy::datum_cast<bool>(moved), ivy::bad_datum_cast);
+}
+
+TEST_CASE("ivy:datum:custom type", "[ivy][datum]")
+{
+    point_type pt;
+    auto const *type = pt.get();
+
+    ivy::datum a(type, point_type::point{1, 1});
+    ivy::datum b(type, point_type::point{1, 1});
+    ivy::datum c(type, point_type::point{1, 2});
+
+    REQUIRE(a.get_kind() == ivy::datum::kind::other);
+    REQUIRE(a.type() == type);
+    REQUIRE(is<point_type>(a));
+    REQUIRE(str(a) == U"diagonal");
+    REQUIRE(a == b);
+    REQUIRE(a != c);
+    REQUIRE(a != ivy::make_integer_datum(1));
+    REQUIRE(std::any_cast<point_type::point>(c.storage()).y == 2);
+
+    auto copy = c;
+    REQUIRE(copy == c);
+}
+
+TEST_CASE("ivy:datum:double", "[ivy][datum]")
+{
+    auto d = ivy::make_double_datum(1.25);
+    REQUIRE(d.get_kind() == ivy::datum::kind::real);
+    REQUIRE(is<ivy::double_type>(d));
+    REQUIRE(ivy::datum_cast<double>(d) == 1.25);
+    REQUIRE(str(d) == U"1.25");
+    REQUIRE(str(ivy::make_double_datum(0.1)) == U"0.1");
+    REQUIRE(d == ivy::make_double_datum(1.25));
+    REQUIRE(d != ivy::make_double_datum(1.5));
+    REQUIRE(d != ivy::make_integer_datum(1));
+
+    REQUIRE(ivy::datum(ivy::get_double_type(), 2.0) ==
+            ivy::make_double_datum(2.0));
+}
+
+TEST_CASE("ivy:datum:date and timestamp", "[ivy][datum]")
+{
+    using namespace std::chrono;
+
+    sys_days day = year(2021) / 3 / 7;
+    auto d = ivy::make_date_datum(day);
+    REQUIRE(d.get_kind() == ivy::datum::kind::date);
+    REQUIRE(is<ivy::date_type>(d));
+    REQUIRE(ivy::datum_cast<sys_days>(d) == day);
+    REQUIRE(str(d) == U"2021-03-07");
+    REQUIRE(d == ivy::make_date_datum(year(2021) / 3 / 7));
+    REQUIRE(d != ivy::make_date_datum(year(2021) / 3 / 8));
+
+    auto t = ivy::make_timestamp_datum(day + 13h + 5min + 9s);
+    REQUIRE(is<ivy::timestamp_type>(t));
+    REQUIRE(str(t) == U"2021-03-07 13:05:09");
+    REQUIRE(ivy::datum_cast<sys_time<microseconds>>(t) ==
+            day + 13h + 5min + 9s);
+
+    auto tf = ivy::make_timestamp_datum(day + 1s + 2500us);
+    REQUIRE(str(tf) == U"2021-03-07 00:00:01.002500");
+    REQUIRE(tf != t);
+    REQUIRE(tf != d);
+}
+
+TEST_CASE("ivy:datum:bytes", "[ivy][datum]")
+{
+    std::vector<std::byte> v{std::byte{0x00}, std::byte{0x7f}, std::byte{0xab}};
+
+    auto b = ivy::make_bytes_datum(v);
+    REQUIRE(b.get_kind() == ivy::datum::kind::bytes);
+    REQUIRE(is<ivy::bytes_type>(b));
+    REQUIRE(ivy::datum_cast<std::vector<std::byte>>(b) == v);
+    REQUIRE(str(b) == U"007fab");
+
+    auto copy = b;
+    REQUIRE(ivy::datum_cast<std::vector<std::byte>>(&copy) ==
+            ivy::datum_cast<std::vector<std::byte>>(&b));
+    REQUIRE(b == ivy::make_bytes_datum(std::vector<std::byte>(v)));
+    REQUIRE(b != ivy::make_bytes_datum(std::span(v).first(2)));
+    REQUIRE(str(ivy::make_bytes_datum(std::vector<std::byte>())) == U"");
+}
+
+TEST_CASE("ivy:decimal", "[ivy][datum]")
+{
+    auto parse = [](std::string_view s) {
+        return ivy::decimal::parse(s).or_throw();
+    };
+
+    REQUIRE(parse("123.450").str() == "123.450");
+    REQUIRE(parse("-0.05").str() == "-0.05");
+    REQUIRE(parse("+7").str() == "7");
+    REQUIRE(parse(".5").str() == "0.5");
+    REQUIRE(parse("-0.00").str() == "0.00");
+    REQUIRE(ivy::decimal(-12345, 2).str() == "-123.45");
+    REQUIRE(ivy::decimal(5, 3).str() == "0.005");
+
+    // 38 digits is the most SQL allows, and needs all 128 bits.
+    auto big = parse("99999999999999999999999999999999999999");
+    REQUIRE(big.str() == "99999999999999999999999999999999999999");
+    REQUIRE(big.high() == 0x4b3b4ca85a86c47a);
+    REQUIRE(big.low() == 0x098a223fffffffff);
+    REQUIRE(!ivy::decimal::parse("999999999999999999999999999999999999999"));
+    REQUIRE(parse("0000000000000000000000000000000000000001").str() == "1");
+
+    REQUIRE(!ivy::decimal::parse(""));
+    REQUIRE(!ivy::decimal::parse("-"));
+    REQUIRE(!ivy::decimal::parse("1.2.3"));
+    REQUIRE(!ivy::decimal::parse("1e5"));
+
+    REQUIRE(parse("1.5") == parse("1.500"));
+    REQUIRE(parse("1.5") != parse("-1.5"));
+    REQUIRE(parse("0") == parse("-0.000"));
+    REQUIRE(parse("10") != parse("1"));
+    REQUIRE(parse("12.25").to_double() == 12.25);
+
+    auto d = ivy::make_decimal_datum(parse("-3.10"));
+    REQUIRE(d.get_kind() == ivy::datum::kind::decimal);
+    REQUIRE(is<ivy::decimal_type>(d));
+    REQUIRE(str(d) == U"-3.10");
+    REQUIRE(d == ivy::make_decimal_datum(parse("-3.1")));
+    REQUIRE(ivy::datum_cast<ivy::decimal>(d).scale() == 2);
+}
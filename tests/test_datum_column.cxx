@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/datum/boolean.hxx>
+#include <ivy/datum/column.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/hash.hxx>
+
+TEST_CASE("ivy:column_bitmap", "[ivy][datum][column]")
+{
+    ivy::column_bitmap b(70, true);
+    REQUIRE(b.size() == 70);
+    REQUIRE(b.count() == 70);
+    REQUIRE(b.words()[1] == (std::uint64_t(1) << 6) - 1);
+
+    b.set(3, false);
+    REQUIRE(!b.test(3));
+    REQUIRE(b.count() == 69);
+
+    b.flip();
+    REQUIRE(b.count() == 1);
+    REQUIRE(b.test(3));
+
+    b.resize(130, true);
+    REQUIRE(b.count() == 61);
+    REQUIRE(!b.test(69));
+    REQUIRE(b.test(70));
+    REQUIRE(b.test(129));
+
+    ivy::column_bitmap c(130);
+    c.set(70);
+    c.set(3);
+    REQUIRE((b & c).count() == 2);
+    REQUIRE((b | c).count() == 61);
+}
+
+TEST_CASE("ivy:datum_column: integers", "[ivy][datum][column]")
+{
+    std::vector<ivy::datum> values;
+    for (std::int64_t i = 0; i < 100; ++i)
+        values.push_back(i % 10 == 0 ? ivy::make_null_datum()
+                                     : ivy::make_integer_datum(i));
+
+    auto column = ivy::make_datum_column(values);
+    REQUIRE(column);
+    REQUIRE(column->type() == ivy::datum::kind::integer);
+    REQUIRE(column->size() == 100);
+    REQUIRE(column->null_count() == 10);
+    REQUIRE(column->is_null(50));
+    REQUIRE(column->integers()[51] == 51);
+    REQUIRE(column->to_datums() == values);
+
+    auto lt = ivy::compare(
+        *column, ivy::compare_op::less, ivy::make_integer_datum(25));
+    REQUIRE(lt);
+    // 0..24 less the nulls at 0, 10 and 20.
+    REQUIRE(lt->count() == 22);
+    REQUIRE(!lt->test(10));
+
+    auto ne = ivy::compare(
+        *column, ivy::compare_op::not_equal, ivy::make_integer_datum(5));
+    REQUIRE(ne->count() == 89);
+
+    // Comparing with null matches nothing.
+    auto eqnull =
+        ivy::compare(*column, ivy::compare_op::equal, ivy::make_null_datum());
+    REQUIRE(eqnull->count() == 0);
+
+    auto filtered = column->filter(*lt);
+    REQUIRE(filtered.size() == 22);
+    REQUIRE(filtered.null_count() == 0);
+    REQUIRE(filtered.integers()[0] == 1);
+    REQUIRE(filtered.integers()[21] == 24);
+
+    // Column against column.
+    auto doubled = ivy::datum_column(ivy::datum::kind::integer);
+    for (std::int64_t i = 0; i < 100; ++i)
+        doubled.append_integer(i * 2 - 50);
+
+    auto gt = ivy::compare(*column, ivy::compare_op::greater, doubled);
+    REQUIRE(gt);
+    // i > 2i - 50 for i < 50, less the nulls.
+    REQUIRE(gt->count() == 45);
+
+    // Mismatched types are an error.
+    REQUIRE(!ivy::compare(
+        *column, ivy::compare_op::equal, ivy::make_boolean_datum(true)));
+}
+
+TEST_CASE("ivy:datum_column: strings", "[ivy][datum][column]")
+{
+    std::vector<ivy::datum> values{
+        ivy::make_string_datum(U"apple"),
+        ivy::make_null_datum(),
+        ivy::make_string_datum(U"banana"),
+        ivy::make_string_datum(U""),
+        ivy::make_string_datum(U"cherry"),
+    };
+
+    auto column = ivy::make_datum_column(values);
+    REQUIRE(column);
+    REQUIRE(column->type() == ivy::datum::kind::string);
+    REQUIRE(column->to_datums() == values);
+
+    auto s = column->string_at(2);
+    REQUIRE(ivy::string(s.data(), s.size()) == U"banana");
+
+    auto ge = ivy::compare(
+        *column, ivy::compare_op::greater_equal, ivy::make_string_datum(U"b"));
+    REQUIRE(ge);
+    REQUIRE(ge->count() == 2);
+    REQUIRE(ge->test(2));
+    REQUIRE(ge->test(4));
+
+    auto eq = ivy::compare(
+        *column, ivy::compare_op::equal, ivy::make_string_datum(U""));
+    REQUIRE(eq->count() == 1);
+    REQUIRE(eq->test(3));
+
+    auto filtered = column->filter(*ge);
+    REQUIRE(filtered.value(1) == ivy::make_string_datum(U"cherry"));
+}
+
+TEST_CASE("ivy:datum_column: mixed types", "[ivy][datum][column]")
+{
+    std::vector<ivy::datum> values{
+        ivy::make_null_datum(),
+        ivy::make_integer_datum(1),
+        ivy::make_string_datum(U"x"),
+    };
+
+    REQUIRE(!ivy::make_datum_column(values));
+
+    std::vector<ivy::datum> nulls(3);
+    auto column = ivy::make_datum_column(nulls);
+    REQUIRE(column);
+    REQUIRE(column->type() == ivy::datum::kind::null);
+    REQUIRE(column->null_count() == 3);
+}
+
+TEST_CASE("ivy:datum_column: hash", "[ivy][datum][column]")
+{
+    ivy::datum_column ints(ivy::datum::kind::integer);
+    ivy::datum_column strings(ivy::datum::kind::string);
+    ivy::datum_column bools(ivy::datum::kind::boolean);
+
+    for (std::int64_t i = 0; i < 37; ++i) {
+        ints.append_integer(i * 1000);
+        auto s = ivy::string(U"row") + ivy::string(i % 2 ? U"odd" : U"even");
+        strings.append_string(std::span(s.data(), s.size()));
+        bools.append_boolean(i % 3 == 0);
+    }
+    ints.append_null();
+
+    std::vector<std::size_t> h(ints.size());
+
+    ints.hash(h);
+    for (std::int64_t i = 0; i < 37; ++i)
+        REQUIRE(h[i] == ivy::hash<std::int64_t>{}(i * 1000));
+    REQUIRE(h[37] == 0);
+
+    strings.hash(h);
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        auto s = strings.string_at(i);
+        REQUIRE(h[i] == ivy::hash<ivy::string>{}(ivy::string(s.data(), s.size())));
+    }
+
+    bools.hash(h);
+    for (std::size_t i = 0; i < bools.size(); ++i)
+        REQUIRE(h[i] == ivy::hash<bool>{}(i % 3 == 0));
+}
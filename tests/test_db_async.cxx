@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/db/async.hxx>
+
+namespace {
+
+    // A result set of 'nrows' integers, 0 to nrows-1, which only supports
+    // next_batch().
+    class test_result_set final : public ivy::db::result_set {
+        std::int64_t _next = 0;
+        std::int64_t _nrows;
+
+    public:
+        std::atomic<int> fetches{0};
+        std::thread::id fetched_on;
+        // If set, this fetch (counting from 1) fails.
+        int fail_on = 0;
+
+        explicit test_result_set(std::int64_t nrows)
+            : _nrows(nrows)
+        {
+        }
+
+        auto column_count() -> std::size_t override
+        {
+            return 1;
+        }
+
+        auto get_next_row() noexcept
+            -> ivy::expected<ivy::db::row_handle, ivy::error> override
+        {
+            return ivy::make_unexpected(
+                ivy::make_error(std::errc::not_supported));
+        }
+
+        auto next_row() noexcept
+            -> ivy::expected<ivy::db::row *, ivy::error> override
+        {
+            return ivy::make_unexpected(
+                ivy::make_error(std::errc::not_supported));
+        }
+
+        auto next_batch(ivy::db::record_batch &batch,
+                        std::size_t max_rows) noexcept
+            -> ivy::expected<std::size_t, ivy::error> override
+        {
+            fetched_on = std::this_thread::get_id();
+            if (++fetches == fail_on)
+                return ivy::make_unexpected(
+                    ivy::make_error(std::errc::io_error));
+
+            if (batch.num_columns() == 1)
+                batch.clear();
+            else {
+                batch.reset();
+                batch.add_column("n", ivy::db::column_type::int64);
+            }
+
+            std::size_t n = 0;
+            for (; n < max_rows && _next < _nrows; ++n)
+                batch.column(0).append_int64(_next++);
+            return n;
+        }
+    };
+
+} // namespace
+
+TEST_CASE("ivy:db:worker_pool: submit", "[ivy][db]")
+{
+    ivy::db::worker_pool pool(2);
+    REQUIRE(pool.size() == 2);
+
+    auto a = pool.submit([] { return 42; });
+    auto b = pool.submit([] { return std::this_thread::get_id(); });
+    auto c = pool.submit([]() -> int { throw std::runtime_error("x"); });
+
+    REQUIRE(a.get() == 42);
+    REQUIRE(b.get() != std::this_thread::get_id());
+    REQUIRE_THROWS_AS(c.get(), std::runtime_error);
+}
+
+TEST_CASE("ivy:db:worker_pool: next_batch_async", "[ivy][db]")
+{
+    ivy::db::worker_pool pool(1);
+    test_result_set rs(10);
+    ivy::db::record_batch batch;
+
+    auto n = ivy::db::next_batch_async(pool, rs, batch, 4).get();
+    REQUIRE(n);
+    REQUIRE(*n == 4);
+    REQUIRE(batch.num_rows() == 4);
+    REQUIRE(rs.fetched_on != std::this_thread::get_id());
+}
+
+TEST_CASE("ivy:db:batch_reader: read ahead", "[ivy][db]")
+{
+    ivy::db::worker_pool pool(1);
+    test_result_set rs(2500);
+    ivy::db::batch_reader reader(pool, rs, 1000);
+
+    std::int64_t expected = 0;
+    std::size_t nbatches = 0;
+    for (;;) {
+        auto batch = reader.next();
+        REQUIRE(batch);
+        if (*batch == nullptr)
+            break;
+
+        ++nbatches;
+        for (auto i : (*batch)->column(0).int64s())
+            REQUIRE(i == expected++);
+    }
+
+    REQUIRE(expected == 2500);
+    REQUIRE(nbatches == 3);
+    // The last batch was short, so the reader didn't ask for another.
+    REQUIRE(rs.fetches == 3);
+
+    // Once it's finished, it stays finished.
+    auto end = reader.next();
+    REQUIRE(end);
+    REQUIRE(*end == nullptr);
+}
+
+TEST_CASE("ivy:db:batch_reader: failed fetch", "[ivy][db]")
+{
+    ivy::db::worker_pool pool(1);
+    test_result_set rs(2500);
+    rs.fail_on = 2;
+    ivy::db::batch_reader reader(pool, rs, 1000);
+
+    auto first = reader.next();
+    REQUIRE(first);
+    REQUIRE(*first != nullptr);
+    REQUIRE((*first)->num_rows() == 1000);
+
+    // The error is reported every time, rather than looking like the end
+    // of the result set.
+    for (int i = 0; i < 2; ++i) {
+        auto failed = reader.next();
+        REQUIRE(!failed);
+        REQUIRE(failed.error() == std::errc::io_error);
+    }
+}
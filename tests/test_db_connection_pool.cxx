@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/db/connection_pool.hxx>
+
+namespace {
+
+    // A connection which counts how many of its kind are open.
+    class test_connection final : public ivy::db::connection {
+        std::atomic<int> *_open;
+
+    public:
+        bool alive = true;
+
+        explicit test_connection(std::atomic<int> *open)
+            : _open(open)
+        {
+            ++*_open;
+        }
+
+        ~test_connection()
+        {
+            --*_open;
+        }
+
+        auto prepare_query(ivy::u16string const &) noexcept
+            -> ivy::expected<ivy::db::query_handle, ivy::error> override
+        {
+            return ivy::make_unexpected(
+                ivy::make_error(std::errc::not_supported));
+        }
+
+        auto disconnect() -> void override {}
+
+        auto is_alive() noexcept -> bool override
+        {
+            return alive;
+        }
+    };
+
+    // A pool of test_connections, with its own metrics registry.
+    struct test_pool {
+        std::atomic<int> open{0};
+        std::atomic<int> connects{0};
+        std::atomic<bool> refuse{false};
+        ivy::metrics::registry registry;
+        ivy::db::connection_pool pool;
+
+        static auto with_registry(ivy::db::connection_pool_config config,
+                                  ivy::metrics::registry *registry)
+            -> ivy::db::connection_pool_config
+        {
+            config.registry = registry;
+            return config;
+        }
+
+        explicit test_pool(ivy::db::connection_pool_config config)
+            : pool(
+                  [this]() -> ivy::expected<ivy::db::connection_handle,
+                                            ivy::error> {
+                      ++connects;
+                      if (refuse)
+                          return ivy::make_unexpected(ivy::make_error(
+                              std::errc::connection_refused));
+                      return std::make_unique<test_connection>(&open);
+                  },
+                  with_registry(std::move(config), &registry))
+        {
+        }
+    };
+
+} // namespace
+
+TEST_CASE("ivy:db:connection_pool: lease and return", "[ivy][db]")
+{
+    test_pool t({.min_size = 2, .max_size = 4});
+
+    REQUIRE(t.pool.fill());
+    REQUIRE(t.open == 2);
+    REQUIRE(t.pool.idle() == 2);
+
+    {
+        auto a = t.pool.lease();
+        REQUIRE(a);
+        REQUIRE(*a);
+        REQUIRE(t.pool.in_use() == 1);
+        REQUIRE(t.registry.get_gauge("ivy_db_pool_leases_in_use").value() ==
+                1);
+
+        auto b = t.pool.lease();
+        auto c = t.pool.lease();
+        REQUIRE(c);
+        // Two idle connections were reused, and one more opened.
+        REQUIRE(t.connects == 3);
+        REQUIRE(t.pool.size() == 3);
+    }
+
+    REQUIRE(t.pool.in_use() == 0);
+    REQUIRE(t.pool.idle() == 3);
+    REQUIRE(t.registry.get_gauge("ivy_db_pool_connections").value() == 3);
+    REQUIRE(t.registry.get_histogram("ivy_db_pool_wait_nanoseconds")
+                .snapshot()
+                .count() == 3);
+
+    // The most recently returned connection is reused.
+    ivy::db::connection *last;
+    {
+        auto a = t.pool.lease();
+        last = a->get();
+    }
+    {
+        auto a = t.pool.lease();
+        REQUIRE(a->get() == last);
+    }
+}
+
+TEST_CASE("ivy:db:connection_pool: lease timeout", "[ivy][db]")
+{
+    test_pool t(
+        {.max_size = 1, .lease_timeout = std::chrono::milliseconds(20)});
+
+    auto a = t.pool.lease();
+    REQUIRE(a);
+
+    auto b = t.pool.lease();
+    REQUIRE(!b);
+    REQUIRE(b.error() == std::errc::timed_out);
+    REQUIRE(t.registry.get_counter("ivy_db_pool_lease_timeouts_total")
+                .value() == 1);
+
+    a->release();
+    REQUIRE(t.pool.lease());
+}
+
+TEST_CASE("ivy:db:connection_pool: connect failure", "[ivy][db]")
+{
+    test_pool t({.max_size = 1});
+
+    t.refuse = true;
+    auto a = t.pool.lease();
+    REQUIRE(!a);
+    REQUIRE(a.error() == std::errc::connection_refused);
+
+    // The slot reserved for the connection is free again.
+    REQUIRE(t.pool.size() == 0);
+    REQUIRE(t.pool.in_use() == 0);
+    REQUIRE(t.registry.get_gauge("ivy_db_pool_connections").value() == 0);
+
+    t.refuse = false;
+    auto b = t.pool.lease();
+    REQUIRE(b);
+    REQUIRE(t.pool.size() == 1);
+}
+
+TEST_CASE("ivy:db:connection_pool: health check", "[ivy][db]")
+{
+    test_pool t({.max_size = 2});
+
+    {
+        auto a = t.pool.lease();
+        static_cast<test_connection *>(a->get())->alive = false;
+    }
+
+    REQUIRE(t.pool.idle() == 1);
+
+    // The dead connection is dropped and a new one opened.
+    auto b = t.pool.lease();
+    REQUIRE(b);
+    REQUIRE(static_cast<test_connection *>(b->get())->alive);
+    REQUIRE(t.connects == 2);
+    REQUIRE(t.open == 1);
+
+    // A discarded connection isn't returned to the pool.
+    b->discard();
+    REQUIRE(t.open == 0);
+    REQUIRE(t.pool.size() == 0);
+}
+
+TEST_CASE("ivy:db:connection_pool: idle eviction", "[ivy][db]")
+{
+    test_pool t({.min_size = 1,
+                 .max_size = 4,
+                 .idle_timeout = std::chrono::milliseconds(0)});
+
+    {
+        auto a = t.pool.lease();
+        auto b = t.pool.lease();
+        auto c = t.pool.lease();
+        REQUIRE(t.open == 3);
+    }
+
+    // Connections are evicted as they're returned, down to min_size.
+    REQUIRE(t.open == 1);
+    REQUIRE(t.pool.idle() == 1);
+    REQUIRE(t.pool.evict_idle() == 0);
+}
+
+TEST_CASE("ivy:db:connection_pool: threads", "[ivy][db]")
+{
+    test_pool t({.max_size = 3});
+
+    std::atomic<int> concurrent{0}, most{0}, failures{0};
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 200; ++j) {
+                auto conn = t.pool.lease();
+                if (!conn) {
+                    ++failures;
+                    continue;
+                }
+
+                auto n = ++concurrent;
+                int m = most;
+                while (n > m && !most.compare_exchange_weak(m, n))
+                    ;
+                std::this_thread::yield();
+                --concurrent;
+            }
+        });
+    }
+
+    for (auto &&thread : threads)
+        thread.join();
+
+    REQUIRE(failures == 0);
+    REQUIRE(most <= 3);
+    REQUIRE(t.open <= 3);
+    REQUIRE(t.pool.in_use() == 0);
+}
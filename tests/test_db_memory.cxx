@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/datum/double.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/db.hxx>
+
+namespace {
+
+    using ivy::db::column_type;
+    using ivy::db::memory::column_spec;
+
+    // A database with one table, "t", of three columns and no nulls.
+    auto make_database(std::size_t nrows)
+        -> std::shared_ptr<ivy::db::memory::database const>
+    {
+        std::vector<column_spec> columns{
+            {"i", column_type::int64},
+            {"d", column_type::float64},
+            {"s", column_type::utf8},
+        };
+
+        auto db = std::make_shared<ivy::db::memory::database>();
+        db->add_table(u"t", ivy::db::memory::generate_table(columns, nrows));
+        return db;
+    }
+
+} // namespace
+
+TEST_CASE("ivy:db:memory: generate_table", "[ivy][db]")
+{
+    std::vector<column_spec> columns{
+        {"i", column_type::int64, 0.5},
+        {"b", column_type::boolean},
+        {"s", column_type::utf8},
+        {"n", column_type::null},
+    };
+
+    auto t = ivy::db::memory::generate_table(columns, 1000, 42);
+    REQUIRE(t.num_columns() == 4);
+    REQUIRE(t.num_rows() == 1000);
+    REQUIRE(t.name(0) == "i");
+
+    // Roughly half of "i" is null, and the rest are the row number.
+    auto nulls = t.column(0).null_count();
+    REQUIRE(nulls > 400);
+    REQUIRE(nulls < 600);
+    for (std::size_t i = 0; i < 1000; ++i)
+        if (!t.column(0).is_null(i))
+            REQUIRE(t.column(0).int64s()[i] == static_cast<std::int64_t>(i));
+
+    REQUIRE(t.column(1).null_count() == 0);
+    REQUIRE(t.column(2).string_at(12) == "row 12");
+    REQUIRE(t.column(3).null_count() == 1000);
+
+    // The same seed makes the same table.
+    auto again = ivy::db::memory::generate_table(columns, 1000, 42);
+    REQUIRE(again.column(0).validity() == t.column(0).validity());
+}
+
+TEST_CASE("ivy:db:memory: rows and values", "[ivy][db]")
+{
+    auto conn = ivy::db::memory::connect(make_database(10)).or_throw();
+    REQUIRE(conn->is_alive());
+
+    auto query = conn->prepare_query(u"t").or_throw();
+    auto result = query->execute().or_throw();
+
+    std::size_t nrows = 0, nsets = 0;
+    for (auto &&rs : result->result_sets()) {
+        ++nsets;
+        REQUIRE(rs.column_count() == 3);
+
+        for (auto &&row : rs.rows()) {
+            auto i = static_cast<std::int64_t>(nrows);
+
+            REQUIRE(row.get_int64(0).or_throw() == i);
+            REQUIRE(row.get_double(1).or_throw() == i / 2.0);
+            REQUIRE(row.get_string_view(2).or_throw() ==
+                    u"row " + std::u16string(1, u'0' + char16_t(i)));
+            REQUIRE(!row.is_null(2).or_throw());
+
+            std::vector<ivy::datum> values;
+            for (auto &&value : row.values())
+                values.push_back(value.as_datum().or_throw());
+
+            REQUIRE(values.size() == 3);
+            REQUIRE(values[0] == ivy::make_integer_datum(i));
+            REQUIRE(values[1] == ivy::make_double_datum(i / 2.0));
+            REQUIRE(values[2] == row.get_datum(2).or_throw());
+
+            // Wrong types and columns are errors.
+            REQUIRE(!row.get_int64(2));
+            REQUIRE(!row.get_datum(3));
+
+            ++nrows;
+        }
+    }
+
+    REQUIRE(nsets == 1);
+    REQUIRE(nrows == 10);
+
+    // Parameters aren't supported.
+    REQUIRE(query->bind(0, ivy::make_integer_datum(1)).error() ==
+            std::errc::not_supported);
+
+    REQUIRE(!conn->prepare_query(u"no_such_table"));
+
+    conn->disconnect();
+    REQUIRE(!conn->is_alive());
+    REQUIRE(!conn->prepare_query(u"t"));
+}
+
+TEST_CASE("ivy:db:memory: next_batch", "[ivy][db]")
+{
+    auto conn = ivy::db::memory::connect(make_database(2500)).or_throw();
+    auto result = conn->prepare_query(u"t").or_throw()->execute().or_throw();
+    auto rs = result->get_next_result_set().or_throw();
+
+    ivy::db::record_batch batch;
+    std::int64_t next = 0;
+    std::size_t n;
+
+    while ((n = rs->next_batch(batch, 1000).or_throw()) > 0) {
+        REQUIRE(batch.num_rows() == n);
+        REQUIRE(batch.name(2) == "s");
+
+        for (std::size_t i = 0; i < n; ++i, ++next) {
+            REQUIRE(batch.column(0).int64s()[i] == next);
+            REQUIRE(batch.column(2).string_at(i) ==
+                    "row " + std::to_string(next));
+        }
+    }
+
+    REQUIRE(next == 2500);
+
+    // Batches and rows share the cursor.
+    auto rs2 = conn->prepare_query(u"t")
+                   .or_throw()
+                   ->execute()
+                   .or_throw()
+                   ->get_next_result_set()
+                   .or_throw();
+    REQUIRE(rs2->next_batch(batch, 5).or_throw() == 5);
+    REQUIRE(rs2->next_row().or_throw()->get_int64(0).or_throw() == 5);
+}
+
+TEST_CASE("ivy:db:memory: open_stream", "[ivy][db]")
+{
+    ivy::db::record_batch table;
+    table.add_column("text", column_type::utf8);
+    table.add_column("blob", column_type::binary);
+    table.add_column("n", column_type::int64);
+
+    auto &text = table.column(0);
+    auto &blob = table.column(1);
+    auto &n = table.column(2);
+
+    std::string long_text(1000, 'x');
+    std::vector<std::byte> bytes;
+    for (int i = 0; i < 700; ++i)
+        bytes.push_back(static_cast<std::byte>(i));
+
+    text.append_utf8(long_text);
+    blob.append_binary(bytes);
+    n.append_int64(1);
+    text.append_null();
+    blob.append_null();
+    n.append_null();
+
+    auto db = std::make_shared<ivy::db::memory::database>();
+    db->add_table(u"t", std::move(table));
+
+    auto conn = ivy::db::memory::connect(db).or_throw();
+    auto result = conn->prepare_query(u"t").or_throw()->execute().or_throw();
+    auto rs = result->get_next_result_set().or_throw();
+
+    // Read a whole stream in small pieces.
+    auto drain = [](ivy::db::value &value) {
+        auto stream = value.open_stream().or_throw();
+        std::vector<std::byte> data;
+        std::byte buf[64];
+
+        for (;;) {
+            auto r = stream->read(buf);
+            if (!r) {
+                REQUIRE(r.error() == ivy::errc::end_of_file);
+                return data;
+            }
+            data.insert(data.end(), buf, buf + *r);
+        }
+    };
+
+    auto row = rs->next_row().or_throw();
+    REQUIRE(row);
+
+    auto text_bytes = drain(*row->value_at(0).or_throw());
+    REQUIRE(std::string(reinterpret_cast<char const *>(text_bytes.data()),
+                        text_bytes.size()) == long_text);
+    REQUIRE(drain(*row->value_at(1).or_throw()) == bytes);
+
+    // Only strings and binary values can be streamed.
+    REQUIRE(row->value_at(2).or_throw()->open_stream().error() ==
+            std::errc::invalid_argument);
+
+    // A null is an empty stream.
+    row = rs->next_row().or_throw();
+    REQUIRE(row);
+    REQUIRE(drain(*row->value_at(0).or_throw()).empty());
+    REQUIRE(drain(*row->value_at(1).or_throw()).empty());
+}
+
+TEST_CASE("ivy:db:memory: pool and async", "[ivy][db]")
+{
+    auto db = make_database(3000);
+    ivy::metrics::registry registry;
+    ivy::db::connection_pool pool(
+        [db] { return ivy::db::memory::connect(db); },
+        {.max_size = 2, .registry = &registry});
+
+    auto conn = pool.lease().or_throw();
+    auto query = conn->prepare_query(u"t").or_throw();
+
+    ivy::db::worker_pool workers(1);
+    auto result = ivy::db::execute_async(workers, *query).get().or_throw();
+
+    std::int64_t sum = 0;
+    for (auto &&rs : result->result_sets()) {
+        ivy::db::batch_reader reader(workers, rs, 1000);
+        while (auto batch = reader.next().or_throw())
+            for (auto i : batch->column(0).int64s())
+                sum += i;
+    }
+
+    REQUIRE(sum == 3000 * 2999 / 2);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/datum/bytes.hxx>
+#include <ivy/datum/date.hxx>
+#include <ivy/datum/integer.hxx>
+#include <ivy/datum/null.hxx>
+#include <ivy/datum/string.hxx>
+#include <ivy/db/record_batch.hxx>
+
+using ivy::db::batch_column;
+using ivy::db::column_type;
+using ivy::db::record_batch;
+
+TEST_CASE("ivy:db:record_batch: fixed-width columns", "[ivy][db]")
+{
+    batch_column c(column_type::int64);
+    c.append_int64(1);
+    c.append_null();
+    c.append_int64(3);
+
+    REQUIRE(c.size() == 3);
+    REQUIRE(c.null_count() == 1);
+    REQUIRE(c.int64s().size() == 3);
+    REQUIRE(c.int64s()[0] == 1);
+    REQUIRE(c.int64s()[1] == 0);
+    REQUIRE(c.int64s()[2] == 3);
+    // Arrow's bit order: row 0 is the least significant bit.
+    REQUIRE(c.validity().words()[0] == 0b101);
+
+    REQUIRE(c.value(1) == ivy::make_null_datum());
+    REQUIRE(c.value(2) == ivy::make_integer_datum(3));
+
+    REQUIRE_THROWS_AS(c.append_double(1.0), ivy::bad_datum_cast);
+
+    batch_column b(column_type::boolean);
+    for (int i = 0; i < 70; ++i)
+        b.append_boolean(i % 3 == 0);
+    REQUIRE(b.booleans().size() == 70);
+    REQUIRE(b.booleans().test(69));
+    REQUIRE(!b.booleans().test(68));
+    REQUIRE(b.null_count() == 0);
+
+    using namespace std::chrono;
+    batch_column d(column_type::date32);
+    d.append(ivy::make_date_datum(sys_days(year(1970) / 1 / 11)));
+    REQUIRE(d.int32s()[0] == 10);
+
+    batch_column t(column_type::timestamp_us);
+    t.append_timestamp(sys_days(year(1970) / 1 / 2) + microseconds(5));
+    REQUIRE(t.int64s()[0] == 86'400'000'005);
+}
+
+TEST_CASE("ivy:db:record_batch: string columns", "[ivy][db]")
+{
+    batch_column c(column_type::utf8);
+    c.append_utf8("abc");
+    c.append_null();
+    c.append_utf16(u"é\U0001F600");
+    c.append(ivy::make_string_datum(U"xy"));
+
+    REQUIRE(c.size() == 4);
+    REQUIRE(std::vector<std::int32_t>(c.offsets().begin(),
+                                      c.offsets().end()) ==
+            std::vector<std::int32_t>{0, 3, 3, 9, 11});
+    REQUIRE(c.string_at(0) == "abc");
+    REQUIRE(c.string_at(1).empty());
+    REQUIRE(c.string_at(2) == "\xc3\xa9\xf0\x9f\x98\x80");
+    REQUIRE(c.value(2) == ivy::make_string_datum(U"é\U0001F600"));
+    REQUIRE(c.value(3) == ivy::make_string_datum(U"xy"));
+
+    // An unpaired surrogate becomes U+FFFD.
+    c.append_utf16(std::u16string_view(u"a\xd800", 2));
+    REQUIRE(c.string_at(4) == "a\xef\xbf\xbd");
+
+    batch_column b(column_type::binary);
+    std::vector<std::byte> bytes{std::byte{1}, std::byte{2}};
+    b.append_binary(bytes);
+    auto datum = ivy::make_bytes_datum(std::span<std::byte const>(bytes));
+    b.append(datum);
+    REQUIRE(b.data().size() == 4);
+    REQUIRE(b.value(1) == datum);
+}
+
+TEST_CASE("ivy:db:record_batch: clear keeps columns", "[ivy][db]")
+{
+    record_batch batch;
+    batch.add_column("id", column_type::int64);
+    batch.add_column("name", column_type::utf8);
+
+    for (int i = 0; i < 100; ++i) {
+        batch.column(0).append_int64(i);
+        batch.column(1).append_utf8("some text");
+    }
+
+    REQUIRE(batch.num_rows() == 100);
+    auto const *ints = batch.column(0).int64s().data();
+    auto const *chars = batch.column(1).data().data();
+
+    batch.clear();
+    REQUIRE(batch.num_columns() == 2);
+    REQUIRE(batch.num_rows() == 0);
+    REQUIRE(batch.column(1).offsets().size() == 1);
+
+    batch.column(0).append_int64(1);
+    batch.column(1).append_utf8("more");
+    REQUIRE(batch.column(0).int64s().data() == ints);
+    REQUIRE(batch.column(1).data().data() == chars);
+    REQUIRE(batch.name(1) == "name");
+
+    batch.reset();
+    REQUIRE(batch.num_columns() == 0);
+    REQUIRE(ivy::db::column_type_name(column_type::timestamp_us) ==
+            std::string_view("timestamp[us]"));
+}
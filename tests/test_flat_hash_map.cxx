@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/flat_hash_map.hxx>
+#include <ivy/string.hxx>
+
+namespace {
+
+    auto make_key(int i) -> ivy::u8string
+    {
+        std::u8string s(u8"key_");
+        for (char c : std::to_string(i))
+            s.push_back(static_cast<char8_t>(c));
+        return ivy::u8string(s.begin(), s.end());
+    }
+
+} // namespace
+
+TEST_CASE("ivy:flat_hash_map: basic operations", "[ivy][flat_hash_map]")
+{
+    ivy::flat_hash_map<int, int> map;
+
+    REQUIRE(map.empty());
+    REQUIRE(map.find(1) == map.end());
+    REQUIRE(map.begin() == map.end());
+
+    for (int i = 0; i < 1000; ++i) {
+        auto [it, inserted] = map.insert({i, i * 2});
+        REQUIRE(inserted);
+        REQUIRE(it->first == i);
+        REQUIRE(it->second == i * 2);
+    }
+
+    REQUIRE(map.size() == 1000);
+    REQUIRE(map.load_factor() <= 0.875f);
+
+    auto [it, inserted] = map.insert({5, 0});
+    REQUIRE(!inserted);
+    REQUIRE(it->second == 10);
+
+    for (int i = 0; i < 1000; ++i) {
+        INFO(i);
+        REQUIRE(map.contains(i));
+        REQUIRE(map.at(i) == i * 2);
+    }
+
+    REQUIRE(!map.contains(1000));
+    REQUIRE_THROWS_AS(map.at(1000), std::out_of_range);
+
+    map[2000] = 1;
+    REQUIRE(map.size() == 1001);
+    REQUIRE(map[2000] == 1);
+
+    std::size_t n = 0;
+    for (auto &&[k, v] : map) {
+        REQUIRE((k == 2000 ? v == 1 : v == k * 2));
+        ++n;
+    }
+    REQUIRE(n == map.size());
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+    REQUIRE(!map.contains(1));
+}
+
+TEST_CASE("ivy:flat_hash_map: erase", "[ivy][flat_hash_map]")
+{
+    // Compare against std::map through a random series of inserts and
+    // erases, which leaves plenty of deleted slots to probe past.
+    ivy::flat_hash_map<std::uint64_t, std::uint64_t> map;
+    std::map<std::uint64_t, std::uint64_t> ref;
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 20000; ++i) {
+        auto k = rng() % 2000;
+
+        if (rng() % 3 == 0) {
+            REQUIRE(map.erase(k) == ref.erase(k));
+        } else {
+            map[k] = static_cast<std::uint64_t>(i);
+            ref[k] = static_cast<std::uint64_t>(i);
+        }
+    }
+
+    REQUIRE(map.size() == ref.size());
+
+    for (auto &&[k, v] : ref) {
+        auto it = map.find(k);
+        REQUIRE(it != map.end());
+        REQUIRE(it->second == v);
+    }
+
+    // Erase through iterators.
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->first % 2)
+            it = map.erase(it);
+        else
+            ++it;
+    }
+
+    for (auto &&[k, v] : map)
+        REQUIRE(k % 2 == 0);
+
+    std::size_t even = 0;
+    for (auto &&[k, v] : ref)
+        even += (k % 2 == 0);
+    REQUIRE(map.size() == even);
+}
+
+TEST_CASE("ivy:flat_hash_map: string keys", "[ivy][flat_hash_map]")
+{
+    ivy::flat_hash_map<ivy::u8string, int> map;
+
+    for (int i = 0; i < 500; ++i)
+        map.try_emplace(make_key(i), i);
+
+    REQUIRE(map.size() == 500);
+
+    auto it = map.find(make_key(42));
+    REQUIRE(it != map.end());
+    REQUIRE(it->second == 42);
+
+    // Heterogeneous lookup, without constructing a u8string.
+    REQUIRE(map.contains(u8"key_7"));
+    REQUIRE(!map.contains(u8"key_500"));
+
+    std::u8string s(u8"key_123");
+    REQUIRE(map.find(std::span<char8_t const>(s))->second == 123);
+
+    REQUIRE(map.erase(u8"key_7") == 1);
+    REQUIRE(!map.contains(make_key(7)));
+
+    // try_emplace doesn't overwrite.
+    auto [pos, inserted] = map.try_emplace(u8"key_1", 1000);
+    REQUIRE(!inserted);
+    REQUIRE(pos->second == 1);
+
+    map[u8"new"] = 5;
+    REQUIRE(map.at(u8"new") == 5);
+}
+
+TEST_CASE("ivy:flat_hash_map: copy and move", "[ivy][flat_hash_map]")
+{
+    ivy::flat_hash_map<ivy::u8string, std::unique_ptr<int>> map;
+
+    for (int i = 0; i < 100; ++i)
+        map.try_emplace(make_key(i), std::make_unique<int>(i));
+
+    auto moved = std::move(map);
+    REQUIRE(moved.size() == 100);
+    REQUIRE(*moved.at(make_key(50)) == 50);
+
+    // Growing moves the elements, so a move-only value must survive it.
+    moved.reserve(10000);
+    REQUIRE(*moved.at(make_key(99)) == 99);
+
+    ivy::flat_hash_map<int, ivy::u8string> a{{1, make_key(1)},
+                                             {2, make_key(2)}};
+    auto b = a;
+    b[3] = make_key(3);
+
+    REQUIRE(a.size() == 2);
+    REQUIRE(b.size() == 3);
+    REQUIRE(b.at(1) == make_key(1));
+}
+
+TEST_CASE("ivy:flat_hash_set", "[ivy][flat_hash_map]")
+{
+    ivy::flat_hash_set<ivy::u8string> set;
+
+    for (int i = 0; i < 300; ++i)
+        REQUIRE(set.insert(make_key(i)).second);
+
+    REQUIRE(!set.insert(make_key(0)).second);
+    REQUIRE(set.size() == 300);
+    REQUIRE(set.contains(u8"key_299"));
+    REQUIRE(set.count(u8"key_300") == 0);
+
+    for (int i = 0; i < 300; i += 2)
+        REQUIRE(set.erase(make_key(i)) == 1);
+
+    REQUIRE(set.size() == 150);
+
+    for (auto &&k : set)
+        REQUIRE(set.contains(k));
+
+    ivy::flat_hash_set<int, ivy::hash<int, ivy::fast_hash_policy>> ints{1, 2,
+                                                                        3};
+    REQUIRE(ints.size() == 3);
+    REQUIRE(ints.contains(2));
+}
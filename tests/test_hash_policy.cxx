@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/hash.hxx>
+#include <ivy/string.hxx>
+
+TEMPLATE_TEST_CASE("ivy:hash:policy",
+                   "[ivy][hash]",
+                   ivy::sip_hash_policy,
+                   ivy::fast_hash_policy)
+{
+    using policy = TestType;
+
+    SECTION("integers")
+    {
+        ivy::hash<int, policy> hi;
+        ivy::hash<std::uint64_t, policy> hu;
+
+        REQUIRE(hi(42) == hi(42));
+        REQUIRE(hi(42) == hu(42));
+        REQUIRE(hi(42) != hi(43));
+
+        std::set<std::size_t> hashes;
+        for (int i = 0; i < 10000; ++i)
+            hashes.insert(hi(i));
+        REQUIRE(hashes.size() == 10000);
+    }
+
+    SECTION("strings")
+    {
+        ivy::hash<ivy::u8string, policy> h;
+
+        REQUIRE(h(ivy::u8string(u8"name")) == h(ivy::u8string(u8"name")));
+        REQUIRE(h(ivy::u8string(u8"name")) != h(ivy::u8string(u8"nam")));
+        REQUIRE(h(ivy::u8string(u8"")) != h(ivy::u8string(u8"x")));
+
+        // Every length up to and past the block sizes.
+        std::set<std::size_t> hashes;
+        std::u8string s;
+        for (int i = 0; i < 200; ++i) {
+            hashes.insert(h(ivy::u8string(s)));
+            s.push_back(static_cast<char8_t>('a' + i % 26));
+        }
+        REQUIRE(hashes.size() == 200);
+    }
+
+    SECTION("unordered_map")
+    {
+        std::unordered_map<ivy::u8string, int, ivy::hash<ivy::u8string, policy>>
+            map;
+
+        for (int i = 0; i < 1000; ++i) {
+            std::u8string key;
+            for (char c : std::to_string(i))
+                key.push_back(static_cast<char8_t>(c));
+            map[ivy::u8string(key)] = i;
+        }
+
+        REQUIRE(map.size() == 1000);
+        REQUIRE(map.at(ivy::u8string(u8"123")) == 123);
+    }
+}
@@ -3,13 +3,50 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <atomic>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
 #include <ivy/log.hxx>
+#include <ivy/log/json_sink.hxx>
+#include <ivy/log/logfmt_sink.hxx>
 #include <ivy/log/ostream_sink.hxx>
 
+namespace {
+
+    // A sink which stores messages, and can be told to block so the
+    // async queue fills up.
+    struct gated_sink final : ivy::log::sink {
+        std::mutex &gate;
+        std::atomic<bool> &entered;
+        std::vector<std::string> &messages;
+
+        gated_sink(std::mutex &gate_,
+                   std::atomic<bool> &entered_,
+                   std::vector<std::string> &messages_)
+            : gate(gate_)
+            , entered(entered_)
+            , messages(messages_)
+        {
+        }
+
+        auto log_message(std::chrono::system_clock::time_point,
+                         ivy::log::severity_code,
+                         std::string_view message) -> void override
+        {
+            entered = true;
+            std::lock_guard lock(gate);
+            messages.emplace_back(message);
+        }
+    };
+
+} // namespace
+
 TEST_CASE("ivy:log:ostream_sink", "[ivy][log][ostream_sink]") {
     using Catch::Matchers::EndsWith;
 
@@ -23,3 +60,284 @@ TEST_CASE("ivy:log:ostream_sink", "[ivy][log][ostream_sink]") {
     auto str = strm.str();
     REQUIRE_THAT(str, EndsWith("this is a test log message\n"));
 }
+
+TEST_CASE("ivy:log:async", "[ivy][log][async]")
+{
+    using Catch::Matchers::EndsWith;
+
+    ivy::log::logger log;
+    std::ostringstream strm;
+
+    log.add_sink(ivy::log::make_ostream_sink(strm));
+    log.start_async({.queue_size = 64});
+
+    std::string long_message(1000, 'x');
+
+    for (int i = 0; i < 1000; ++i)
+        log.log_message(ivy::log::severity_code::info, std::to_string(i));
+    log.log_message(ivy::log::severity_code::info, long_message);
+
+    log.flush();
+
+    std::istringstream lines(strm.str());
+    std::string line;
+    int n = 0;
+
+    while (std::getline(lines, line)) {
+        if (n < 1000)
+            REQUIRE_THAT(line, EndsWith(" | " + std::to_string(n)));
+        else
+            REQUIRE_THAT(line, EndsWith(long_message));
+        ++n;
+    }
+
+    REQUIRE(n == 1001);
+    REQUIRE(log.dropped_records() == 0);
+}
+
+TEST_CASE("ivy:log:async:multiple threads", "[ivy][log][async]")
+{
+    ivy::log::logger log;
+    std::mutex gate;
+    std::atomic<bool> entered = false;
+    std::vector<std::string> messages;
+
+    log.add_sink(std::make_unique<gated_sink>(gate, entered, messages));
+    log.start_async({.queue_size = 16});
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i)
+                log.log_message(ivy::log::severity_code::info, "message");
+        });
+
+    for (auto &&thread : threads)
+        thread.join();
+
+    log.stop_async();
+    REQUIRE(messages.size() == 4000);
+}
+
+TEST_CASE("ivy:log:async:overflow", "[ivy][log][async]")
+{
+    using ivy::log::overflow_policy;
+
+    auto policy = GENERATE(overflow_policy::drop, overflow_policy::drop_oldest);
+
+    ivy::log::logger log;
+    std::mutex gate;
+    std::atomic<bool> entered = false;
+    std::vector<std::string> messages;
+
+    log.add_sink(std::make_unique<gated_sink>(gate, entered, messages));
+
+    {
+        std::unique_lock lock(gate);
+        log.start_async({.queue_size = 4, .overflow = policy});
+
+        // Wait for the logging thread to pick up the first message and block
+        // in the sink, then overfill the queue.
+        log.log_message(ivy::log::severity_code::info, "first");
+        while (!entered)
+            std::this_thread::yield();
+
+        for (int i = 0; i < 10; ++i)
+            log.log_message(ivy::log::severity_code::info, std::to_string(i));
+    }
+
+    log.flush();
+
+    REQUIRE(log.dropped_records() == 6);
+    REQUIRE(messages.size() == 5);
+    REQUIRE(messages[0] == "first");
+
+    if (policy == overflow_policy::drop) {
+        REQUIRE(messages[1] == "0");
+        REQUIRE(messages[4] == "3");
+    } else {
+        REQUIRE(messages[1] == "6");
+        REQUIRE(messages[4] == "9");
+    }
+}
+
+TEST_CASE("ivy:log:deferred", "[ivy][log][async]")
+{
+    bool async = GENERATE(false, true);
+
+    ivy::log::logger log;
+    std::mutex gate;
+    std::atomic<bool> entered = false;
+    std::vector<std::string> messages;
+
+    log.add_sink(std::make_unique<gated_sink>(gate, entered, messages));
+    if (async)
+        log.start_async();
+
+    std::string s("string");
+    std::string long_string(1000, 'x');
+    std::string_view sv("view");
+    char const *p = "pointer";
+
+    log.log(ivy::log::severity_code::info, "no arguments");
+    log.log(ivy::log::severity_code::info, "{} {} {}", 42, -1, true);
+    log.log(ivy::log::severity_code::info, "{:.2f} {:#x}", 1.5, 255u);
+    log.log(ivy::log::severity_code::info, "[{}] [{}] [{}]", s, sv, p);
+    log.log(ivy::log::severity_code::info, "[{:>8}]", std::string("right"));
+    log.log(ivy::log::severity_code::info, "[{}]", "literal");
+    log.log(ivy::log::severity_code::info, "{}{}", long_string, 1);
+
+    // Temporaries must be captured by value, not by reference.
+    for (int i = 0; i < 3; ++i)
+        log.log(ivy::log::severity_code::info, "{}", std::to_string(i));
+
+    log.flush();
+
+    REQUIRE(messages.size() == 10);
+    REQUIRE(messages[0] == "no arguments");
+    REQUIRE(messages[1] == "42 -1 true");
+    REQUIRE(messages[2] == "1.50 0xff");
+    REQUIRE(messages[3] == "[string] [view] [pointer]");
+    REQUIRE(messages[4] == "[   right]");
+    REQUIRE(messages[5] == "[literal]");
+    REQUIRE(messages[6] == long_string + "1");
+    REQUIRE(messages[7] == "0");
+    REQUIRE(messages[9] == "2");
+}
+
+TEST_CASE("ivy:log:min_severity", "[ivy][log]")
+{
+    using ivy::log::severity_code;
+
+    ivy::log::logger log;
+    std::mutex gate;
+    std::atomic<bool> entered = false;
+    std::vector<std::string> all, warnings;
+
+    log.add_sink(std::make_unique<gated_sink>(gate, entered, all));
+
+    auto sink = std::make_unique<gated_sink>(gate, entered, warnings);
+    auto *warning_sink = sink.get();
+    log.add_sink(std::move(sink));
+
+    REQUIRE(log.is_enabled(severity_code::trace));
+
+    warning_sink->set_min_severity(severity_code::warning);
+    REQUIRE(log.is_enabled(severity_code::trace));
+
+    log.log(severity_code::trace, "trace");
+    log.log(severity_code::warning, "warning");
+
+    REQUIRE(all == std::vector<std::string>{"trace", "warning"});
+    REQUIRE(warnings == std::vector<std::string>{"warning"});
+
+    log.set_min_severity(severity_code::notice);
+    REQUIRE(!log.is_enabled(severity_code::info));
+    REQUIRE(log.is_enabled(severity_code::notice));
+
+    log.log(severity_code::info, "info {}", 1);
+    log.log_message(severity_code::info, "info");
+    log.log(severity_code::error, "error {}", 1);
+
+    REQUIRE(all.size() == 3);
+    REQUIRE(all[2] == "error 1");
+    REQUIRE(warnings.size() == 2);
+}
+
+TEST_CASE("ivy:log:min_severity from a sink", "[ivy][log]")
+{
+    using ivy::log::severity_code;
+
+    // A sink which only wants the first message below an error.
+    struct once_sink final : ivy::log::sink {
+        std::vector<std::string> &messages;
+
+        explicit once_sink(std::vector<std::string> &messages_)
+            : messages(messages_)
+        {
+        }
+
+        auto log_message(std::chrono::system_clock::time_point,
+                         severity_code,
+                         std::string_view message) -> void override
+        {
+            messages.emplace_back(message);
+            set_min_severity(severity_code::error);
+        }
+    };
+
+    ivy::log::logger log;
+    std::vector<std::string> messages;
+    log.add_sink(std::make_unique<once_sink>(messages));
+
+    log.log(severity_code::info, "first");
+    REQUIRE(!log.is_enabled(severity_code::info));
+
+    log.log(severity_code::info, "second");
+    log.log(severity_code::error, "error");
+
+    REQUIRE(messages == std::vector<std::string>{"first", "error"});
+}
+
+TEST_CASE("ivy:log:fields", "[ivy][log][fields]")
+{
+    using namespace std::chrono_literals;
+    using ivy::log::kv;
+    using Catch::Matchers::EndsWith;
+
+    bool async = GENERATE(false, true);
+
+    ivy::log::logger log;
+    std::ostringstream logfmt, json;
+
+    log.add_sink(ivy::log::make_logfmt_sink(logfmt));
+    log.add_sink(ivy::log::make_json_sink(json));
+    if (async)
+        log.start_async();
+
+    std::string user("bob \"the user\"");
+
+    log.log(ivy::log::severity_code::info,
+            "request {} done",
+            42,
+            kv("status", 200),
+            kv("user", user),
+            kv("elapsed", 1500us),
+            kv("ok", true),
+            kv("ratio", 0.5));
+
+    log.log(ivy::log::severity_code::warning,
+            "no fields, two args: {} {}",
+            kv("size", 10u),
+            "a",
+            'b');
+
+    log.flush();
+
+    std::istringstream logfmt_lines(logfmt.str());
+    std::string line;
+
+    REQUIRE(std::getline(logfmt_lines, line));
+    REQUIRE(line.starts_with("time="));
+    REQUIRE_THAT(line,
+                 EndsWith(R"( level=info msg="request 42 done" status=200 )"
+                          R"(user="bob \"the user\"" elapsed=1500000ns )"
+                          R"(ok=true ratio=0.5)"));
+
+    REQUIRE(std::getline(logfmt_lines, line));
+    REQUIRE_THAT(
+        line,
+        EndsWith(R"( level=warning msg="no fields, two args: a b" size=10)"));
+
+    std::istringstream json_lines(json.str());
+
+    REQUIRE(std::getline(json_lines, line));
+    REQUIRE(line.starts_with(R"({"time":")"));
+    REQUIRE_THAT(line,
+                 EndsWith(R"("level":"info","msg":"request 42 done",)"
+                          R"("status":200,"user":"bob \"the user\"",)"
+                          R"("elapsed":1500000,"ok":true,"ratio":0.5})"));
+
+    REQUIRE(std::getline(json_lines, line));
+    REQUIRE_THAT(line, EndsWith(R"("size":10})"));
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/io/mapped_file.hxx>
+#include <ivy/log/mmap_segment_sink.hxx>
+#include <ivy/log/segment.hxx>
+
+namespace {
+
+    auto make_test_directory() -> std::filesystem::path
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        auto dir = std::filesystem::temp_directory_path() /
+                   ("ivy_test_log_segment_" + std::to_string(now.count()));
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    auto read_segment(std::filesystem::path const &path)
+        -> std::vector<std::string>
+    {
+        auto file = ivy::open_mapped_file(path);
+        REQUIRE(file);
+
+        ivy::log::segment_reader reader(file->data());
+        REQUIRE(reader.open());
+
+        std::vector<std::string> messages;
+
+        for (;;) {
+            auto r = reader.next();
+            if (!r) {
+                REQUIRE(r.error() == ivy::errc::end_of_file);
+                break;
+            }
+
+            REQUIRE(r->severity == ivy::log::severity_code::info);
+            messages.emplace_back(r->message);
+        }
+
+        return messages;
+    }
+
+} // namespace
+
+TEST_CASE("ivy:log:mmap_segment_sink", "[ivy][log][mmap_segment_sink]")
+{
+    auto dir = make_test_directory();
+
+    {
+        auto sink = ivy::log::make_mmap_segment_sink({.directory = dir});
+        REQUIRE(sink);
+
+        auto now = std::chrono::system_clock::now();
+        for (int i = 0; i < 100; ++i)
+            (*sink)->log_message(
+                now, ivy::log::severity_code::info, std::to_string(i));
+    }
+
+    auto messages = read_segment(dir / "ivy.00000001.ivylog");
+    REQUIRE(messages.size() == 100);
+    REQUIRE(messages[0] == "0");
+    REQUIRE(messages[99] == "99");
+
+    // A second sink continues with the next segment.
+    {
+        auto sink = ivy::log::make_mmap_segment_sink({.directory = dir});
+        REQUIRE(sink);
+        (*sink)->log_message(std::chrono::system_clock::now(),
+                             ivy::log::severity_code::info,
+                             "second");
+    }
+
+    REQUIRE(read_segment(dir / "ivy.00000002.ivylog") ==
+            std::vector<std::string>{"second"});
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("ivy:log:mmap_segment_sink:rotation",
+          "[ivy][log][mmap_segment_sink]")
+{
+    auto dir = make_test_directory();
+
+    {
+        auto sink = ivy::log::make_mmap_segment_sink(
+            {.directory = dir, .segment_size = 4096, .max_segments = 3});
+        REQUIRE(sink);
+
+        // Each record is 24 + 1000 bytes, so three fit in a segment.
+        std::string message(1000, 'x');
+        auto now = std::chrono::system_clock::now();
+
+        for (int i = 0; i < 15; ++i)
+            (*sink)->log_message(now, ivy::log::severity_code::info, message);
+
+        // A record larger than a segment is truncated.
+        (*sink)->log_message(
+            now, ivy::log::severity_code::info, std::string(10000, 'y'));
+
+        REQUIRE((*sink)->lost_records() == 0);
+    }
+
+    std::vector<std::string> segments;
+    for (auto &&entry : std::filesystem::directory_iterator(dir))
+        segments.push_back(entry.path().filename().string());
+    std::ranges::sort(segments);
+
+    REQUIRE(segments == std::vector<std::string>{"ivy.00000004.ivylog",
+                                                 "ivy.00000005.ivylog",
+                                                 "ivy.00000006.ivylog"});
+
+    REQUIRE(read_segment(dir / segments[1]).size() == 3);
+
+    auto last = read_segment(dir / segments[2]);
+    REQUIRE(last.size() == 1);
+    REQUIRE(last[0].size() == 4096 - 24 - 24);
+    REQUIRE(last[0].starts_with("yyy"));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("ivy:log:mmap_segment_sink:existing segment",
+          "[ivy][log][mmap_segment_sink]")
+{
+    auto dir = make_test_directory();
+
+    {
+        auto sink = ivy::log::make_mmap_segment_sink(
+            {.directory = dir, .segment_size = 4096});
+        REQUIRE(sink);
+
+        // Something else takes the next segment's name.
+        {
+            auto other = ivy::create_mapped_file(
+                dir / "ivy.00000002.ivylog", 4096);
+            REQUIRE(other);
+            REQUIRE(ivy::create_mapped_file(dir / "ivy.00000002.ivylog", 4096)
+                        .error() == std::errc::file_exists);
+        }
+
+        // Fill the first segment, so the sink has to skip the taken name.
+        std::string message(1000, 'x');
+        auto now = std::chrono::system_clock::now();
+        for (int i = 0; i < 6; ++i)
+            (*sink)->log_message(now, ivy::log::severity_code::info, message);
+
+        REQUIRE((*sink)->lost_records() == 0);
+    }
+
+    REQUIRE(read_segment(dir / "ivy.00000003.ivylog").size() == 3);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("ivy:log:mmap_segment_sink:fields", "[ivy][log][mmap_segment_sink]")
+{
+    using namespace std::chrono_literals;
+    using ivy::log::kv;
+
+    auto dir = make_test_directory();
+
+    {
+        auto sink = ivy::log::make_mmap_segment_sink({.directory = dir});
+        REQUIRE(sink);
+
+        std::array fields{kv("status", 200),
+                          kv("user", "bob"),
+                          kv("elapsed", 15ms),
+                          kv("ok", false)};
+
+        ivy::log::record r{std::chrono::system_clock::now(),
+                           ivy::log::severity_code::info,
+                           "request done",
+                           fields};
+        (*sink)->log_records(std::span(&r, 1));
+    }
+
+    auto file = ivy::open_mapped_file(dir / "ivy.00000001.ivylog");
+    REQUIRE(file);
+
+    ivy::log::segment_reader reader(file->data());
+    REQUIRE(reader.open());
+
+    auto r = reader.next();
+    REQUIRE(r);
+    REQUIRE(r->message == "request done");
+    REQUIRE(r->fields.size() == 4);
+    REQUIRE(r->fields[0].key == "status");
+    REQUIRE(std::get<std::int64_t>(r->fields[0].value) == 200);
+    REQUIRE(std::get<std::string_view>(r->fields[1].value) == "bob");
+    REQUIRE(std::get<std::chrono::nanoseconds>(r->fields[2].value) == 15ms);
+    REQUIRE(std::get<bool>(r->fields[3].value) == false);
+
+    REQUIRE(reader.next().error() == ivy::errc::end_of_file);
+
+    file->close();
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/metrics.hxx>
+
+TEST_CASE("ivy:metrics:counter", "[ivy][metrics]")
+{
+    ivy::metrics::counter c;
+    REQUIRE(c.value() == 0);
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; ++i)
+        threads.emplace_back([&] {
+            for (int j = 0; j < 10000; ++j)
+                c.add();
+        });
+
+    for (auto &&t : threads)
+        t.join();
+
+    c.add(5);
+    REQUIRE(c.value() == 80005);
+}
+
+TEST_CASE("ivy:metrics:gauge", "[ivy][metrics]")
+{
+    ivy::metrics::gauge g;
+
+    g.set(10);
+    g.add(5);
+    g.sub(20);
+    REQUIRE(g.value() == -5);
+}
+
+TEST_CASE("ivy:metrics:histogram_buckets", "[ivy][metrics]")
+{
+    using namespace ivy::metrics::detail;
+
+    // Small values have a bucket each.
+    for (std::uint64_t v = 0; v < 16; ++v) {
+        REQUIRE(histogram_bucket(v) == v);
+        REQUIRE(histogram_bucket_lower(v) == v);
+        REQUIRE(histogram_bucket_upper(v) == v);
+    }
+
+    // Buckets are contiguous and every value falls in its own bucket.
+    for (std::size_t b = 1; b < histogram_bucket_count; ++b)
+        REQUIRE(histogram_bucket_lower(b) ==
+                histogram_bucket_upper(b - 1) + 1);
+
+    for (std::uint64_t v : {16ull, 17ull, 31ull, 32ull, 33ull, 1000ull,
+                            123456789ull, (1ull << 63) - 1, 1ull << 63}) {
+        auto b = histogram_bucket(v);
+        REQUIRE(histogram_bucket_lower(b) <= v);
+        REQUIRE(histogram_bucket_upper(b) >= v);
+    }
+
+    auto max = std::numeric_limits<std::uint64_t>::max();
+    REQUIRE(histogram_bucket(max) == histogram_bucket_count - 1);
+    REQUIRE(histogram_bucket_upper(histogram_bucket_count - 1) == max);
+}
+
+TEST_CASE("ivy:metrics:histogram", "[ivy][metrics]")
+{
+    ivy::metrics::histogram h;
+
+    REQUIRE(h.snapshot().quantile(0.5) == 0);
+
+    std::vector<std::thread> threads;
+
+    for (std::uint64_t t = 0; t < 4; ++t)
+        threads.emplace_back([&, t] {
+            for (std::uint64_t v = 1; v <= 2500; ++v)
+                h.record(t * 2500 + v);
+        });
+
+    for (auto &&t : threads)
+        t.join();
+
+    auto snap = h.snapshot();
+    REQUIRE(snap.count() == 10000);
+    REQUIRE(snap.sum() == 10000ull * 10001 / 2);
+
+    // Quantiles are accurate to within a bucket (1/16th).
+    auto within = [](std::uint64_t actual, std::uint64_t expected) {
+        return actual >= expected && actual <= expected + expected / 16;
+    };
+
+    REQUIRE(within(snap.quantile(0.5), 5000));
+    REQUIRE(within(snap.quantile(0.99), 9900));
+    REQUIRE(within(snap.quantile(1.0), 10000));
+    REQUIRE(snap.quantile(0.0) == 1);
+
+    ivy::metrics::histogram h2;
+    h2.record(1000000);
+
+    auto merged = h2.snapshot();
+    merged.merge(snap);
+    REQUIRE(merged.count() == 10001);
+    REQUIRE(within(merged.quantile(1.0), 1000000));
+    REQUIRE(within(merged.quantile(0.5), 5001));
+}
+
+TEST_CASE("ivy:metrics:registry", "[ivy][metrics]")
+{
+    ivy::metrics::registry r;
+
+    auto &c = r.get_counter("test_requests_total", "Requests handled.");
+    REQUIRE(&r.get_counter("test_requests_total") == &c);
+    c.add(3);
+
+    r.get_gauge("test_connections").set(-2);
+
+    auto &h = r.get_histogram("test_latency_nanoseconds", "Latency.");
+    for (std::uint64_t i = 1; i <= 100; ++i)
+        h.record(i);
+
+    // Metrics are written in name order.
+    std::string expected =
+        "# TYPE test_connections gauge\n"
+        "test_connections -2\n"
+        "# HELP test_latency_nanoseconds Latency.\n"
+        "# TYPE test_latency_nanoseconds summary\n"
+        "test_latency_nanoseconds{quantile=\"0.5\"} 51\n"
+        "test_latency_nanoseconds{quantile=\"0.9\"} 91\n"
+        "test_latency_nanoseconds{quantile=\"0.99\"} 99\n"
+        "test_latency_nanoseconds{quantile=\"0.999\"} 103\n"
+        "test_latency_nanoseconds_sum 5050\n"
+        "test_latency_nanoseconds_count 100\n"
+        "# HELP test_requests_total Requests handled.\n"
+        "# TYPE test_requests_total counter\n"
+        "test_requests_total 3\n";
+
+    REQUIRE(r.text() == expected);
+}
@@ -3,8 +3,16 @@
  * Distributed under the Boost Software License, Version 1.0.
  */
 
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
+#include <ivy/buffer/dynamic_buffer.hxx>
+#include <ivy/io/hashchannel.hxx>
+#include <ivy/io/stringchannel.hxx>
 #include <ivy/siphash.hxx>
 
 const uint8_t vectors_sip64[64][8] = {
@@ -667,4 +675,172 @@ TEST_CASE("ivy:siphash")
         INFO(i);
         REQUIRE(std::memcmp(out, vectors_sip64[i], len) == 0);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("ivy:siphash64")
+{
+    std::byte in[64], k[16];
+
+    for (unsigned i = 0; i < 16; ++i)
+        k[i] = static_cast<std::byte>(i);
+
+    ivy::siphash_key key(k);
+
+    for (unsigned i = 0; i < 64; ++i) {
+        in[i] = static_cast<std::byte>(i);
+
+        std::byte out[8];
+        ivy::detail::sip_u64u8le(
+            ivy::siphash64(std::span(in).subspan(0, i), key), out);
+
+        INFO(i);
+        REQUIRE(std::memcmp(out, vectors_sip64[i], 8) == 0);
+    }
+}
+
+TEST_CASE("ivy:siphash_many")
+{
+    std::byte data[64], k[16];
+
+    for (unsigned i = 0; i < 16; ++i)
+        k[i] = static_cast<std::byte>(i * 7);
+
+    for (unsigned i = 0; i < 64; ++i)
+        data[i] = static_cast<std::byte>(i * 13);
+
+    ivy::siphash_key key(k);
+
+    // Inputs of varied lengths, so lanes within a group finish at
+    // different blocks, and a count which leaves a partial group.
+    std::vector<std::span<std::byte const>> inputs;
+    for (unsigned i = 0; i < 23; ++i)
+        inputs.push_back(
+            std::span<std::byte const>(data).subspan(i % 5, (i * 11) % 57));
+
+    std::vector<std::uint64_t> out(inputs.size());
+
+    ivy::siphash_many(inputs, key, out);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        INFO(i);
+        REQUIRE(out[i] == ivy::siphash64(inputs[i], key));
+    }
+
+    ivy::siphash_many<1, 3>(inputs, key, out);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        INFO(i);
+        REQUIRE(out[i] == ivy::siphash64<1, 3>(inputs[i], key));
+    }
+}
+
+TEST_CASE("ivy:siphash_many: integers")
+{
+    ivy::siphash_key key(0x0706050403020100, 0x0f0e0d0c0b0a0908);
+
+    std::vector<std::uint64_t> inputs;
+    for (std::uint64_t i = 0; i < 23; ++i)
+        inputs.push_back(i * 0x9e3779b97f4a7c15);
+
+    std::vector<std::uint64_t> out(inputs.size());
+
+    ivy::siphash_many(std::span<std::uint64_t const>(inputs), key, out);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        INFO(i);
+        REQUIRE(out[i] ==
+                ivy::siphash64(std::as_bytes(std::span(&inputs[i], 1)), key));
+    }
+}
+
+TEST_CASE("ivy:siphash_state")
+{
+    std::byte data[64], k[16];
+
+    for (unsigned i = 0; i < 16; ++i)
+        k[i] = static_cast<std::byte>(i);
+
+    for (unsigned i = 0; i < 64; ++i)
+        data[i] = static_cast<std::byte>(i);
+
+    ivy::siphash_key key(k);
+
+    // Every length, split into two and three pieces at every point.
+    for (std::size_t len = 0; len <= 64; ++len) {
+        auto in = std::span<std::byte const>(data).first(len);
+        auto expected = ivy::siphash64(in, key);
+
+        for (std::size_t i = 0; i <= len; ++i) {
+            for (std::size_t j = i; j <= len; ++j) {
+                ivy::siphash_state<> state(key);
+                state.update(in.subspan(0, i));
+                state.update(in.subspan(i, j - i));
+                state.update(in.subspan(j));
+
+                INFO(len << " " << i << " " << j);
+                REQUIRE(state.size() == len);
+                REQUIRE(state.finish() == expected);
+            }
+        }
+    }
+
+    // One byte at a time, checking the intermediate results.
+    ivy::siphash_state<1, 3> state(key);
+    for (std::size_t i = 0; i < 64; ++i) {
+        state.update(std::span<std::byte const>(data).subspan(i, 1));
+        INFO(i);
+        REQUIRE(state.finish() ==
+                ivy::siphash64<1, 3>(
+                    std::span<std::byte const>(data).first(i + 1), key));
+    }
+}
+
+TEST_CASE("ivy:siphash_buffer")
+{
+    ivy::siphash_key key(0x0706050403020100, 0x0f0e0d0c0b0a0908);
+
+    // Small extents, so the data is spread over several ranges.
+    ivy::dynamic_buffer<std::byte, ivy::dynamic_buffer_size(16)> buf;
+    std::vector<std::byte> data;
+
+    for (unsigned i = 0; i < 60; ++i)
+        data.push_back(static_cast<std::byte>(i * 3));
+
+    buf.write(data.data(), data.size());
+    REQUIRE(buf.readable_ranges().size() > 1);
+
+    REQUIRE(ivy::siphash_buffer(buf, key) == ivy::siphash64(data, key));
+}
+
+TEST_CASE("ivy:siphash_channel")
+{
+    ivy::siphash_key key(1, 2);
+    ivy::u8string s(u8"The quick brown fox jumps over the lazy dog");
+    auto expected = ivy::siphash64(std::as_bytes(std::span(s)), key);
+
+    {
+        ivy::u8stringchannel chan(s);
+        auto r = ivy::siphash_channel(chan, key);
+        REQUIRE(r);
+        REQUIRE(*r == expected);
+    }
+
+    {
+        // Read through a hashchannel in small pieces.
+        ivy::u8stringchannel chan(s);
+        auto hchan = ivy::make_hashchannel(chan, key);
+        char8_t buf[5];
+
+        while (hchan.read(buf))
+            ;
+
+        REQUIRE(hchan.bytes_hashed() == s.size());
+        REQUIRE(hchan.hash() == expected);
+    }
+
+    {
+        ivy::u8stringchannel chan;
+        auto hchan = ivy::make_hashchannel(chan, key);
+        hchan.write(std::span(s).first(7));
+        hchan.write(std::span(s).subspan(7));
+
+        REQUIRE(chan.str() == s);
+        REQUIRE(hchan.hash() == expected);
+    }
+}
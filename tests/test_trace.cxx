@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+#include <format>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <ivy/trace.hxx>
+
+#ifdef IVY_ENABLE_TRACING
+
+namespace {
+
+    auto dump() -> std::string
+    {
+        std::ostringstream strm;
+        ivy::trace_dump(strm);
+        return strm.str();
+    }
+
+} // namespace
+
+TEST_CASE("ivy:trace:buffer", "[ivy][trace]")
+{
+    ivy::set_trace_mode(ivy::trace_mode::buffer);
+
+    std::string name("config");
+    IVY_TRACE("trace test: first {} {}", 42, name);
+
+    std::thread([] { IVY_TRACE("trace test: from thread {}", 2.5); }).join();
+
+    IVY_TRACE("trace test: last");
+
+    auto text = dump();
+    auto first = text.find("trace test: first 42 config\n");
+    auto thread = text.find("trace test: from thread 2.5\n");
+    auto last = text.find("trace test: last\n");
+
+    REQUIRE(first != std::string::npos);
+    REQUIRE(thread != std::string::npos);
+    REQUIRE(last != std::string::npos);
+
+    // Events from all threads are merged in time order.
+    REQUIRE(first < thread);
+    REQUIRE(thread < last);
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+}
+
+TEST_CASE("ivy:trace:wrap", "[ivy][trace]")
+{
+    ivy::set_trace_mode(ivy::trace_mode::buffer);
+
+    for (std::size_t i = 0; i < ivy::trace_buffer_events + 10; ++i)
+        IVY_TRACE("trace wrap: {}", i);
+
+    auto text = dump();
+
+    // The oldest events have been overwritten.
+    REQUIRE(text.find("trace wrap: 9\n") == std::string::npos);
+    REQUIRE(text.find("trace wrap: 10\n") != std::string::npos);
+    REQUIRE(text.find(std::format("trace wrap: {}\n",
+                                  ivy::trace_buffer_events + 9)) !=
+            std::string::npos);
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+}
+
+TEST_CASE("ivy:trace:oversized", "[ivy][trace]")
+{
+    ivy::set_trace_mode(ivy::trace_mode::buffer);
+
+    std::string big(1024, 'x');
+    IVY_TRACE("trace oversized: {}", big);
+
+    auto text = dump();
+    REQUIRE(text.find("trace oversized: {} [arguments too large]\n") !=
+            std::string::npos);
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+}
+
+TEST_CASE("ivy:trace:span", "[ivy][trace]")
+{
+    ivy::set_trace_mode(ivy::trace_mode::buffer);
+
+    {
+        IVY_SPAN("test.outer");
+        IVY_TRACE("trace span: inside \"outer\"");
+
+        {
+            IVY_SPAN("test.inner");
+        }
+    }
+
+    auto text = dump();
+    REQUIRE(text.find("span test.outer ") != std::string::npos);
+    REQUIRE(text.find("span test.inner ") != std::string::npos);
+
+    // Spans are ordered by when they began.
+    REQUIRE(text.find("span test.outer ") < text.find("trace span: inside"));
+    REQUIRE(text.find("trace span: inside") < text.find("span test.inner "));
+
+    std::ostringstream strm;
+    ivy::trace_export_chrome(strm);
+    auto json = strm.str();
+
+    REQUIRE(json.starts_with("{\"traceEvents\":["));
+    REQUIRE(json.ends_with("]}\n"));
+    REQUIRE(json.find("{\"name\":\"test.outer\",\"cat\":\"ivy\",\"ph\":\"X\","
+                      "\"ts\":") != std::string::npos);
+    REQUIRE(json.find("{\"name\":\"trace span: inside \\\"outer\\\"\","
+                      "\"cat\":\"ivy\",\"ph\":\"i\"") != std::string::npos);
+
+    ivy::set_trace_mode(ivy::trace_mode::off);
+}
+
+TEST_CASE("ivy:trace:off", "[ivy][trace]")
+{
+    ivy::set_trace_mode(ivy::trace_mode::off);
+    IVY_TRACE("trace test: disabled");
+
+    {
+        IVY_SPAN("test.disabled");
+    }
+
+    auto text = dump();
+    REQUIRE(text.find("trace test: disabled") == std::string::npos);
+    REQUIRE(text.find("test.disabled") == std::string::npos);
+}
+
+#endif // IVY_ENABLE_TRACING
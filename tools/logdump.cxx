@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019, 2020, 2021 SiKol Ltd.
+ * Distributed under the Boost Software License, Version 1.0.
+ */
+
+/*
+ * logdump: print the records in binary log segments written by
+ * mmap_segment_sink, in the same format as ostream_sink.
+ *
+ *    logdump <segment> [<segment> ...]
+ */
+
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <ivy/io/mapped_file.hxx>
+#include <ivy/log/field.hxx>
+#include <ivy/log/segment.hxx>
+
+namespace {
+
+    auto dump_segment(char const *filename) -> bool
+    {
+        auto file = ivy::open_mapped_file(filename);
+        if (!file) {
+            std::cerr << std::format(
+                "{}: cannot open: {}\n", filename, file.error().what());
+            return false;
+        }
+
+        ivy::log::segment_reader reader(file->data());
+        if (auto r = reader.open(); !r) {
+            std::cerr << std::format("{}: {}\n", filename, r.error().what());
+            return false;
+        }
+
+        std::string text;
+
+        for (;;) {
+            auto r = reader.next();
+
+            if (!r) {
+                if (r.error() == ivy::errc::end_of_file)
+                    break;
+
+                std::cout << text;
+                std::cerr << std::format(
+                    "{}: {}\n", filename, r.error().what());
+                return false;
+            }
+
+            auto out = std::back_inserter(text);
+            std::format_to(out,
+                           "{} | {} | {}",
+                           r->timestamp,
+                           str(r->severity),
+                           r->message);
+
+            for (auto &&field : r->fields) {
+                std::format_to(out, " {}=", field.key);
+                ivy::log::format_field_value(text, field.value);
+            }
+
+            text.push_back('\n');
+
+            if (text.size() >= 64 * 1024) {
+                std::cout << text;
+                text.clear();
+            }
+        }
+
+        std::cout << text;
+        return true;
+    }
+
+} // namespace
+
+auto main(int argc, char **argv) -> int
+{
+    if (argc < 2) {
+        std::cerr << "usage: logdump <segment> [<segment> ...]\n";
+        return 1;
+    }
+
+    int ret = 0;
+
+    for (int i = 1; i < argc; ++i)
+        if (!dump_segment(argv[i]))
+            ret = 1;
+
+    return ret;
+}